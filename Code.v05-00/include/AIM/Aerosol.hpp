@@ -26,6 +26,7 @@
 #endif /* OMP */
 
 #include "Util/ForwardDecl.hpp"
+#include "Util/Field_3D.hpp"
 #include "AIM/Coagulation.hpp"
 #include "Core/Mesh.hpp"
 
@@ -109,21 +110,59 @@ class AIM::Grid_Aerosol
         Grid_Aerosol( UInt Nx_, UInt Ny_, const Vector_1D& bin_Centers, const Vector_1D& bin_Edges, double nPart, double mu, double sigma, const char* distType = "lognormal", double alpha_ = -1.0, double gamma_ = -1.0, double b_ = 0.0 );
 
         /* Coagulation */
-        void Coagulate( const double dt, Coagulation &kernel, const UInt N = 2, const UInt SYM = 0 );
+        void Coagulate( const double dt, const Coagulation &kernel, const UInt N = 2, const UInt SYM = 0 );
+
+        /* Grid cell holding ice, with the range of bins holding particles [firstBin, lastBin] */
+        struct ActiveCell {
+            UInt jNy;
+            UInt iNx;
+            UInt firstBin;
+            UInt lastBin;
+        };
+        /* Cells with a non-zero pdf among the first Ny_max rows and Nx_max columns */
+        std::vector<ActiveCell> ActiveCells( const UInt Nx_max, const UInt Ny_max ) const;
+
+        /* Single-cell work arrays for ice growth, allocated once per thread and reused for every cell */
+        struct GrowthScratch {
+            explicit GrowthScratch( UInt nBin ):
+                icePart(nBin), iceVol(nBin), kGrowth(nBin), partToBin(nBin), volToBin(nBin), toBin(nBin) { }
+            Vector_1D icePart;   // [#/cm^3]
+            Vector_1D iceVol;    // [m^3/cm^3]
+            Vector_1D kGrowth;
+            Vector_1D partToBin; // Particles moved into each bin
+            Vector_1D volToBin;  // Volume moved into each bin
+            std::vector<int> toBin;
+        };
+
+        /* Single-cell work arrays for coagulation, allocated once per thread and reused for every cell.
+         * The kernel is a private copy as its volume partition depends on the bin centers of the cell */
+        struct CoagulationScratch {
+            CoagulationScratch( const Coagulation& kernel_, UInt nBin ):
+                kernel(kernel_), vCenters(nBin), v(nBin), vNew(nBin), nPart(nBin) { }
+            Coagulation kernel;
+            Vector_1D vCenters; // [m^3]
+            Vector_1D v;        // [m^3/cm^3]
+            Vector_1D vNew;     // [m^3/cm^3]
+            Vector_1D nPart;    // [#/cm^3]
+        };
+        /* Coagulates one cell. Expects scratch.v, scratch.vNew and scratch.nPart filled over [firstBin, lastBin],
+         * and scratch.vNew and scratch.nPart zeroed below firstBin: production terms read smaller bins
+         * of any size, so stale values from a previous cell would be coagulated too */
+        void CoagulateCell( const ActiveCell& cell, const double dt, CoagulationScratch& scratch );
 
         /* Ice crystal growth */
         void Grow( const double dt, Vector_2D &H2O, const Vector_2D &T, const Vector_1D &P, const UInt N = 2, const UInt SYM = 0 );
         double EffDiffCoef( const double r, const double T, const double P, const double H2O) const;
-        void APC_Scheme(const UInt jNy, const UInt iNx, const double T, const double P,
-                            const double dt, Vector_2D& H2O, Vector_2D& totH2O, Vector_3D& icePart, Vector_3D& iceVol);
-        std::vector<int> ComputeBinParticleFlux(const int x_index, const int y_index, const Vector_3D& iceVol, const Vector_3D& icePart) const;
-        void ApplyBinParticleFlux(const int x_index, const int y_index, const std::vector<int> &toBin, const Vector_3D &iceVol, const Vector_3D &icePart);
+        void APC_Scheme(const ActiveCell& cell, const double T, const double P, const double dt,
+                            Vector_2D& H2O, const double totH2O, GrowthScratch& scratch) const;
+        void ComputeBinParticleFlux(const ActiveCell& cell, GrowthScratch& scratch) const;
+        void ApplyBinParticleFlux(const ActiveCell& cell, GrowthScratch& scratch);
         
         /* Helper Functions for Coagulation and Ice Growth */
         bool CheckCoagAndGrowInputs(const UInt N, const UInt SYM, UInt& Nx_max, UInt& Ny_max, const std::string funcName) const;
         void CoagAndGrowApplySymmetry(const UInt N, const UInt SYM, const UInt Nx_max, const UInt Ny_max, const char* funcName, Vector_2D& H2O);
         /* Update bin centers - Used after aerosol transport */
-        void UpdateCenters( const Vector_3D &iceV, const Vector_3D &PDF );
+        void UpdateCenters( const Field_3D &iceV, const Field_3D &PDF );
         inline void updateNx(int nx_new) { Nx = nx_new; };
         inline void updateNy(int ny_new) { Ny = ny_new; };
 
@@ -133,13 +172,13 @@ class AIM::Grid_Aerosol
         double Moment( UInt n, UInt iNx, UInt jNy ) const;
 
         /* Extra utils */
-        Vector_3D Number( ) const;
+        Field_3D Number( ) const;
         //Gives number concentration field in part / cm3
         Vector_2D TotalNumber( ) const;
         double TotalNumber_sum( const Vector_2D& cellAreas ) const;
         Vector_1D Overall_Size_Dist( const Vector_2D& cellAreas ) const;
         //Gives 3D volume field in m3 / cm3
-        Vector_3D Volume( ) const;
+        Field_3D Volume( ) const;
         Vector_2D TotalVolume( ) const;
         Vector_2D TotalArea( ) const;
         double TotalIceMass_sum( const Vector_2D& cellAreas ) const;
@@ -161,12 +200,39 @@ class AIM::Grid_Aerosol
         Vector_2D StdDev( ) const;
         double StdDev( UInt iNx, UInt jNy ) const;
 
-        //This template just lets us minimize copies/moves without writing a bunch of different overloads
-        template< typename Vector3D_t, 
-                  typename _  = std::enable_if_t<std::is_same_v<std::decay_t<Vector3D_t>, Vector_3D>> 
-                >
-        void updatePdf( Vector3D_t&& pdf_new ) {
-            pdf = std::forward<Vector3D_t>(pdf_new);
+        /* Output of Diagnose. Buffers keep their memory from one call to the next, so a
+         * Diagnostics reused on a grid of the same size does not allocate */
+        struct Diagnostics {
+            /* When false, only number, volume, IWC and the cross-section totals are computed */
+            bool full = true;
+            Vector_2D number;     // [#/cm^3]
+            Vector_2D area;       // [m^2/cm^3]
+            Vector_2D volume;     // [m^3/cm^3]
+            Vector_2D effRadius;  // [m]
+            Vector_2D IWC;        // [kg/m^3]
+            Vector_2D extinction; // [1/m]
+            Vector_1D xOD;        // [-], one value per row
+            Vector_1D yOD;        // [-], one value per column
+            Vector_1D sizeDist;   // [#/m], one value per bin
+            double totalNumber = 0.0;  // [#/m]
+            double totalIceMass = 0.0; // [kg/m]
+            double width = 0.0;        // [m]
+            double depth = 0.0;        // [m]
+            double intOD = 0.0;        // [m]
+            /* Size distribution of each row, summed into sizeDist */
+            Vector_2D rowSizeDist;
+        };
+        /* Same values as TotalNumber, TotalArea, TotalVolume, EffRadius, IWC, Extinction,
+         * xOD, yOD, Overall_Size_Dist, TotalNumber_sum, TotalIceMass_sum, extinctionWidth,
+         * extinctionDepth and intYOD, from a single pass over the pdf.
+         * Coordinates and cell sizes are only used when diag.full is set */
+        void Diagnose( Diagnostics& diag, const Vector_2D& cellAreas,
+                       const Vector_1D& xCoord, const Vector_1D& yCoord,
+                       const Vector_1D& dx, const Vector_1D& dy, double thres = 0.1 ) const;
+
+        //Takes the field by value so that callers can move it in without a copy
+        void updatePdf( Field_3D pdf_new ) {
+            pdf = std::move(pdf_new);
         }
         /* utils */
         Vector_1D Average( const Vector_2D &weights,   \
@@ -178,15 +244,15 @@ class AIM::Grid_Aerosol
 
         /* gets */
         inline const Vector_1D& getBinCenters() const { return bin_Centers; };
-        inline const Vector_3D& getBinVCenters() const { return bin_VCenters; };
-        inline Vector_3D& getBinVCenters_nonConstRef() { return bin_VCenters; };
+        inline const Field_3D& getBinVCenters() const { return bin_VCenters; };
+        inline Field_3D& getBinVCenters_nonConstRef() { return bin_VCenters; };
         inline const Vector_1D& getBinEdges() const { return bin_Edges; };
         inline const Vector_1D& getBinSizes() const { return bin_Sizes; };
         inline UInt getNBin() const { return nBin; };
         inline const char* getType() const { return type; };
         inline double getAlpha() const { return alpha; };
-        inline const Vector_3D& getPDF() const { return pdf; };
-        inline Vector_3D& getPDF_nonConstRef() { return pdf; };
+        inline const Field_3D& getPDF() const { return pdf; };
+        inline Field_3D& getPDF_nonConstRef() { return pdf; };
         inline int getNx() const { return Nx; }
         inline int getNy() const { return Ny; }
 
@@ -194,8 +260,8 @@ class AIM::Grid_Aerosol
     protected:
 
         unsigned int Nx, Ny;
-        Vector_3D pdf; //Everything with the pdf is implicitly in [ / cm3]
-        Vector_3D bin_VCenters;
+        Field_3D pdf; //Everything with the pdf is implicitly in [ / cm3]
+        Field_3D bin_VCenters;
         Vector_1D bin_Centers;
         Vector_1D bin_Edges;
         Vector_1D bin_VEdges;
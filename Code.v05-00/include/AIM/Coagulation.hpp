@@ -41,20 +41,38 @@ class AIM::Coagulation
         Coagulation( const char* phase, Vector_1D const &bin_Centers_1, Vector_1D &bin_VCenters_1, double rho_1, Vector_1D const &bin_Centers_2, double rho_2, double temperature_K_, double pressure_Pa_ );
         Coagulation( const char* phase, Vector_1D const &bin_Centers_1, Vector_1D &bin_VCenters_1, double rho_1, double temperature_K_, double pressure_Pa_ );
         Coagulation( const char* phase, Vector_1D const &bin_Centers_1, double rho_1, double bin_Centers_2, double rho_2, double temperature_K_, double pressure_Pa_ );
+        /* From a precomputed kernel beta, e.g. from a CoagulationTable. Kernel is left empty */
+        Coagulation( const Vector_2D &beta_, const Vector_1D &bin_VCenters_1 );
             
         ~Coagulation( );
         Coagulation( const Coagulation& k );
         Coagulation& operator=( const Coagulation& k );
         void buildBeta( const Vector_1D &bin_Centers );
+        /* Builds the volume partition for the given bin volume centers. Requires beta.
+         * Rebuilding for the same number of bins reuses the memory of the partition */
         void buildF( const Vector_1D &bin_VCenters );
-        void buildF( const Vector_3D &bin_VCenters, const UInt jNy, const UInt iNx );
         Vector_2D getKernel() const;
         Vector_1D getKernel_1D() const;
         Vector_2D getBeta() const;
+        /* Dense f[k][j][i], fraction of the volume of k coagulating with j that ends up in i */
         Vector_3D getF() const;
-        
-        Vector_3D f;
-        std::vector<std::vector<std::vector<UInt> > > indices;
+        double fraction( const UInt kBin, const UInt jBin, const UInt iBin ) const;
+
+        /* Volume partition. The volume of k coagulating with j goes to target[k*nBin+j]
+         * for a fraction frac[k*nBin+j], and to the next bin for the rest */
+        struct Partition {
+            std::vector<UInt> target;
+            Vector_1D frac;
+            /* Production terms in compressed rows by formed bin i: entries [rowStart[i], rowStart[i+1])
+             * are the pairs k < i, j <= i with a non-zero fraction in i, ordered by j then k */
+            std::vector<UInt> rowStart;
+            std::vector<UInt> kBin;
+            std::vector<UInt> jBin;
+            Vector_1D coef;  // f[k][j][i] * beta[k][j] [cm^3/s]
+            /* ( 1 - f[i][j][i] ) * beta[i][j] [cm^3/s], loss of i coagulating with j, row-major */
+            Vector_1D loss;
+        };
+        Partition partition;
 
     protected:
 
@@ -0,0 +1,94 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*                        AIrcraft Microphysics                     */
+/*                              (AIM)                               */
+/*                                                                  */
+/* CoagulationTable Header File                                     */
+/*                                                                  */
+/* File                 : CoagulationTable.hpp                      */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef COAGULATIONTABLE_H_INCLUDED
+#define COAGULATIONTABLE_H_INCLUDED
+
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "Util/ForwardDecl.hpp"
+#include "AIM/Coagulation.hpp"
+
+namespace AIM
+{
+    class CoagulationTable;
+}
+
+/* Coagulation kernels of a fixed bin structure, tabulated on a (temperature, pressure)
+ * lattice and interpolated bilinearly in temperature and log pressure.
+ * Lattice nodes are built on first use with the same kernels as AIM::Coagulation and
+ * kept for the lifetime of the table, so a sweep only pays the kernel builds for the
+ * few nodes around its ambient conditions. Tables are shared by all threads and cases
+ * of a run through CoagulationTable::load, and are safe to use concurrently.
+ * Interpolated kernels differ from the exact ones by up to about 1e-3 relative, so the
+ * EPM and Solution only use tables when enabled with configure. */
+class AIM::CoagulationTable
+{
+    public:
+
+        /* Lattice spacing in temperature [K] and in ln(pressure [Pa]) */
+        static constexpr double DT_K  = 2.0E+00;
+        static constexpr double DLOGP = 5.0E-02;
+
+        /* Coagulation of the bins with themselves */
+        CoagulationTable( const std::string& phase, const Vector_1D& bin_Centers, double rho );
+        /* Coagulation of the bins with particles of radius bin_R [m] */
+        CoagulationTable( const std::string& phase, const Vector_1D& bin_Centers, double rho_1, double bin_R, double rho_2 );
+        CoagulationTable( const CoagulationTable& ) = delete;
+        CoagulationTable& operator=( const CoagulationTable& ) = delete;
+
+        /* Returns the cached table for these arguments, creating it on first use */
+        static std::shared_ptr<const CoagulationTable> load( const std::string& phase, const Vector_1D& bin_Centers, double rho );
+        static std::shared_ptr<const CoagulationTable> load( const std::string& phase, const Vector_1D& bin_Centers, double rho_1, double bin_R, double rho_2 );
+        /* Drops the cache. Tables still held by a caller stay alive until released */
+        static void clearCache();
+
+        /* Whether kernels are taken from the tables instead of being built exactly.
+         * Off by default */
+        static void configure( bool enabled );
+        static bool enabled();
+
+        /* Self-coagulation kernel beta [cm^3/s], as Coagulation::getBeta */
+        Vector_2D beta( double temperature_K, double pressure_Pa ) const;
+        /* Self-coagulation kernel with its volume partition built for bin_VCenters [m^3] */
+        Coagulation kernel( double temperature_K, double pressure_Pa, const Vector_1D& bin_VCenters ) const;
+        /* Kernel [cm^3/s] with particles of radius bin_R, as Coagulation::getKernel_1D */
+        Vector_1D kernel_1D( double temperature_K, double pressure_Pa ) const;
+
+        /* Number of lattice nodes built so far */
+        std::size_t nodes() const;
+
+    private:
+
+        typedef std::shared_future<std::shared_ptr<const Vector_1D>> Node;
+
+        /* Kernel values at lattice node (iT, iP), flattened row-major */
+        std::shared_ptr<const Vector_1D> node( long iT, long iP ) const;
+        Vector_1D buildNode( long iT, long iP ) const;
+        /* Writes the interpolated kernel values into values */
+        void interpolate( double temperature_K, double pressure_Pa, Vector_1D& values ) const;
+
+        std::string phase_;
+        Vector_1D bin_Centers_;
+        double rho_1_;
+        double bin_R_;
+        double rho_2_;
+        bool self_;
+
+        mutable std::mutex mutex_;
+        mutable std::map<std::pair<long, long>, Node> nodes_;
+
+};
+
+#endif /* COAGULATIONTABLE_H_INCLUDED */
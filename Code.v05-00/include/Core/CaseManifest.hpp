@@ -0,0 +1,49 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* CaseManifest Header File                                         */
+/*                                                                  */
+/* File                 : CaseManifest.hpp                          */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef CASEMANIFEST_H_INCLUDED
+#define CASEMANIFEST_H_INCLUDED
+
+#include <string>
+#include <unordered_set>
+#include "Core/Status.hpp"
+
+/* Append-only record of the finished cases of a sweep, one "<case> <status>" line
+ * per finished case in the output folder. Jobs running different shards of a sweep
+ * share one manifest, and a restarted job skips the cases recorded there instead of
+ * checking the output of every case. */
+class CaseManifest
+{
+    public:
+
+        static constexpr const char* FILENAME = "case_manifest.txt";
+
+        /* No finished cases */
+        CaseManifest( ) = default;
+        /* Reads the manifest of the output folder, if any. Incomplete lines, left by a
+         * job killed while writing, are ignored */
+        explicit CaseManifest( const std::string& folder );
+
+        /* True if the last status recorded for the case is not Failed */
+        inline bool finished( std::size_t iCase ) const { return finished_.count( iCase ) > 0; }
+        inline std::size_t size() const { return finished_.size(); }
+
+        /* Appends a line to the manifest of the output folder. Each line goes out in a
+         * single append, so concurrent jobs do not interleave their lines */
+        static void append( const std::string& folder, std::size_t iCase, SimStatus status );
+
+    private:
+
+        std::unordered_set<std::size_t> finished_;
+
+};
+
+#endif /* CASEMANIFEST_H_INCLUDED */
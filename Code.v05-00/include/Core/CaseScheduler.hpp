@@ -0,0 +1,67 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* CaseScheduler Header File                                        */
+/*                                                                  */
+/* File                 : CaseScheduler.hpp                         */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef CASESCHEDULER_H_INCLUDED
+#define CASESCHEDULER_H_INCLUDED
+
+#include <cstdint>
+#include <vector>
+#include "YamlInputReader/CaseSpace.hpp"
+#include "Core/CaseSelection.hpp"
+
+/* Order in which the cases of a sweep are run, and sharing of the OpenMP threads between
+ * the cases running at the same time.
+ * When cases run concurrently, each running case gets an equal share of the threads for
+ * its own parallel loops. Cases re-evaluate their share every time step, so the last
+ * cases of a sweep take over the threads of the cases that have finished. Running the
+ * longest cases first keeps that tail short. */
+class CaseScheduler
+{
+    public:
+
+        CaseScheduler( ) = delete;
+        /* Runs the cases of the selection. With longestFirst, cases are sorted by decreasing
+         * expectedCost, ties keep the sweep order */
+        CaseScheduler( const YamlInputReader::CaseSpace& caseSpace, bool metInput, bool longestFirst,
+                       const CaseSelection& selection = CaseSelection() );
+
+        inline std::size_t size() const { return order_.size(); }
+        /* Index in the case space of the i-th case to run */
+        inline std::size_t operator[]( std::size_t i ) const { return order_[i]; }
+
+        /* Relative run time of a case: the simulated time, much shorter when the
+         * ambient air is subsaturated wrt ice since the contrail then sublimates early.
+         * The ambient state is not known before reading a met input file. */
+        static double expectedCost( const YamlInputReader::CaseParameters& parameters, bool metInput );
+
+        /* Marks a case as running on the calling thread while in scope */
+        class RunningCase
+        {
+            public:
+                RunningCase( );
+                ~RunningCase( );
+                RunningCase( const RunningCase& ) = delete;
+                RunningCase& operator=( const RunningCase& ) = delete;
+            private:
+                std::uint64_t id_;
+        };
+
+        /* Number of threads the case running on the calling thread should use out of totalThreads.
+         * Returns totalThreads when called outside of a RunningCase. Thread-safe */
+        static int threadShare( int totalThreads );
+
+    private:
+
+        std::vector<std::size_t> order_;
+
+};
+
+#endif /* CASESCHEDULER_H_INCLUDED */
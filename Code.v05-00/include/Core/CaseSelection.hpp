@@ -0,0 +1,47 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* CaseSelection Header File                                        */
+/*                                                                  */
+/* File                 : CaseSelection.hpp                         */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef CASESELECTION_H_INCLUDED
+#define CASESELECTION_H_INCLUDED
+
+#include <cstddef>
+#include <limits>
+#include <string>
+
+/* Subset of the cases of a sweep run by one process, to split a sweep over independent jobs.
+ * Shards interleave the cases so that each shard gets a similar mix of parameter values.
+ * Setters throw std::invalid_argument on a malformed specification. */
+class CaseSelection
+{
+    public:
+
+        /* All cases */
+        CaseSelection( ) = default;
+
+        /* "i/N": cases i, i + N, i + 2N, ... with 0 <= i < N */
+        void setShard( const std::string& spec );
+        /* "first:last": cases first to last - 1, either bound may be left out */
+        void setRange( const std::string& spec );
+
+        inline bool contains( std::size_t iCase ) const {
+            return iCase >= first_ && iCase < last_ && iCase % nShards_ == shard_;
+        }
+
+    private:
+
+        std::size_t shard_ = 0;
+        std::size_t nShards_ = 1;
+        std::size_t first_ = 0;
+        std::size_t last_ = std::numeric_limits<std::size_t>::max();
+
+};
+
+#endif /* CASESELECTION_H_INCLUDED */
@@ -14,12 +14,18 @@
 #ifndef DIAG_MOD_H_INCLUDED
 #define DIAG_MOD_H_INCLUDED
 
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <netcdf>
 #include "Core/Structure.hpp"
 #include "Core/Mesh.hpp"
 #include "Core/Meteorology.hpp"
+#include "Util/Timing.hpp"
 #include "KPP/KPP_Global.h"
 
 namespace Diag {
@@ -50,7 +56,122 @@ namespace Diag {
                     const Vector_1D& xCoord, const Vector_1D& yCoord,
                     const Vector_1D& xEdges, const Vector_1D& yEdges,
                     const Meteorology &met);
+    /* Same, computing the diagnostics into diag, reused from one call to the next */
+    void Diag_TS_Phys( const char* rootName,
+                    const int hh, const int mm, const int ss,
+                    const AIM::Grid_Aerosol& iceAer, const Vector_2D& H2O,
+                    const Vector_1D& xCoord, const Vector_1D& yCoord,
+                    const Vector_1D& xEdges, const Vector_1D& yEdges,
+                    const Meteorology &met, AIM::Grid_Aerosol::Diagnostics& diag );
     
+    /* Storage settings of TS_PhysSeries */
+    struct SeriesSettings {
+        /* Chunk length along the ragged x, y and cell dimensions */
+        std::size_t chunkSize = 4096;
+        /* 0 (no compression) to 9 */
+        int deflateLevel = 1;
+        bool shuffle = true;
+        /* Significant digits kept by lossy quantization, 0 to store floats exactly */
+        int significantDigits = 0;
+    };
+
+    /* Time series of Diag_TS_Phys in a single NetCDF-4 file, one record per output time
+     * along the unlimited dimension t. The grid changes size during a run, so grid fields
+     * are stored ragged: record n covers x_start(n) to x_start(n) + nx(n) - 1 along the
+     * unlimited dimension x, likewise along y, and 2D fields are flattened (y, x) blocks
+     * of ny(n) * nx(n) values starting at cell_start(n) along the unlimited dimension cell. */
+    class TS_PhysSeries {
+        public:
+            /* With resume, an existing file is kept and the first write goes to the record
+             * at its time, so a run resumed from a checkpoint rewrites the records written
+             * after the checkpoint. Otherwise an existing file is replaced. */
+            TS_PhysSeries( const string& fileName, const SeriesSettings& settings, bool resume );
+
+            /* Same arguments as Diag_TS_Phys, without the file name */
+            void append( const int hh, const int mm, const int ss,
+                         const AIM::Grid_Aerosol& iceAer, const Vector_2D& H2O,
+                         const Vector_1D& xCoord, const Vector_1D& yCoord,
+                         const Vector_1D& xEdges, const Vector_1D& yEdges,
+                         const Meteorology &met );
+
+            inline const string& fileName() const { return fileName_; }
+
+        private:
+            void create( NcFile& file, const AIM::Grid_Aerosol& iceAer ) const;
+            /* Finds where the record at time cur_time goes in an existing file */
+            void seek( const NcFile& file, float cur_time );
+
+            string fileName_;
+            SeriesSettings settings_;
+            bool resume_;
+            bool created_ = false;
+            /* Next record and next free index along x, y and cell */
+            std::size_t record_ = 0;
+            std::size_t xStart_ = 0;
+            std::size_t yStart_ = 0;
+            std::size_t cellStart_ = 0;
+            AIM::Grid_Aerosol::Diagnostics diag_;
+    };
+
+    /* Name of the TS_PhysSeries file for a Diag_TS_Phys file name pattern:
+     * the pattern without its hh, mm and ss fields, e.g. ts_aerosol_case0.nc
+     * for ts_aerosol_case0_hhmm.nc */
+    string seriesFileName( const string& rootName );
+
+    /* Writes Diag_TS_Phys files on a background thread, so the time loop continues
+     * while the diagnostics are computed and written. Each write copies the fields
+     * into one of a fixed set of snapshot buffers, reused from one write to the next.
+     * When all buffers are waiting to be written, write blocks until one is free.
+     * Errors of the writer thread are rethrown by the next write or flush. */
+    class TS_PhysWriter {
+        public:
+            explicit TS_PhysWriter( std::size_t nBuffers = 2 );
+            /* Writes the remaining snapshots, errors are reported but not thrown */
+            ~TS_PhysWriter();
+            TS_PhysWriter( const TS_PhysWriter& ) = delete;
+            TS_PhysWriter& operator=( const TS_PhysWriter& ) = delete;
+
+            /* Same arguments as Diag_TS_Phys */
+            void write( const char* rootName,
+                        const int hh, const int mm, const int ss,
+                        const AIM::Grid_Aerosol& iceAer, const Vector_2D& H2O,
+                        const Vector_1D& xCoord, const Vector_1D& yCoord,
+                        const Vector_1D& xEdges, const Vector_1D& yEdges,
+                        const Meteorology &met );
+            /* Waits until all snapshots are written */
+            void flush();
+            /* Appends the snapshots to a single file instead, call before the first write */
+            void useSeries( std::unique_ptr<TS_PhysSeries> series );
+
+        private:
+            struct Snapshot {
+                string rootName;
+                int hh, mm, ss;
+                AIM::Grid_Aerosol iceAer;
+                Vector_2D H2O;
+                Vector_1D xCoord, yCoord, xEdges, yEdges;
+                Meteorology met;
+            };
+
+            void run( Timing::Profile* profile );
+            void rethrow();
+
+            std::vector<Snapshot> buffers_;
+            /* Indices into buffers_ */
+            std::vector<std::size_t> free_;
+            std::vector<std::size_t> queued_;
+            bool writing_ = false;
+            bool stop_ = false;
+            std::exception_ptr error_;
+            bool errorThrown_ = false;
+            std::unique_ptr<TS_PhysSeries> series_;
+            /* Only used by the writer thread */
+            AIM::Grid_Aerosol::Diagnostics diag_;
+            std::mutex mutex_;
+            std::condition_variable cv_;
+            std::thread thread_;
+    };
+
     void add0DVar(NcFile& currFile, const float toSave, const NcDim& dim, const string& name, const string& desc, const string& units);
     void add1DVar(NcFile& currFile, const Vector_1D& toSave, const NcDim& dim, const string& name, const string& desc, const string& units);
     void add2DVar(NcFile& currFile, const Vector_2D& toSave, const vector<NcDim> dims, const string& name, const string& desc, const string& units);
@@ -15,10 +15,10 @@
 #define ENGINE_H_INCLUDED
 
 #include <string>
-#include <fstream>
 #include <cstring>
 #include <vector>
 #include <cmath>
+#include "Core/EngineDatabase.hpp"
 
 
 class Engine
@@ -33,12 +33,10 @@ class Engine
         
         Engine( );
         Engine( const char *engineName, std::string engineFileName, double tempe_K, double pres_Pa, double relHum_w, double machNumber );
+        Engine( const std::string &engineName, const EngineLTO &lto, double tempe_K, double pres_Pa, double relHum_w, double machNumber );
         Engine( const Engine &e );
         Engine& operator=( const Engine &e );
         ~Engine( );
-        void OpenFile( const char *fileName, std::ifstream &file );
-        void CloseFile( std::ifstream &file );
-        bool GetEDB( std::ifstream &file, const char *engineName, std::string &idle, std::string &approach, std::string &climbout, std::string &takeoff );
         std::string getName() const;
         double getEI_NOx() const;
         double getEI_NO() const;
@@ -90,11 +88,8 @@ class Engine
 
         static const char * const engineFileName;
 
-        std::vector<double> ratedThrust = std::vector<double>(4);
-        std::vector<double> LTO_fuelflow = std::vector<double>(4);
-        std::vector<double> LTO_NOx = std::vector<double>(4);
-        std::vector<double> LTO_CO = std::vector<double>(4);
-        std::vector<double> LTO_HC = std::vector<double>(4);
+        /* Emission indices at the given flight conditions from the BFFM2 fits of the LTO data */
+        void ComputeEI( const EngineLTO &lto, double tempe_K, double pres_Pa, double relHum_w, double machNumber );
 
         double NOxtoHNO2 = 0.015;
         double NOxtoNO2 = 0.20 * ( 1.0 - NOxtoHNO2 );
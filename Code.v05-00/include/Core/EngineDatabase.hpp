@@ -0,0 +1,74 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* EngineDatabase Header File                                       */
+/*                                                                  */
+/* File                 : EngineDatabase.hpp                        */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef ENGINEDATABASE_H_INCLUDED
+#define ENGINEDATABASE_H_INCLUDED
+
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/* LTO data of one engine of the emissions databank and the BFFM2 fits derived from it.
+ * The fits only depend on the LTO data, so they are computed once when the database is read;
+ * Engine then only evaluates them at the fuel flow corrected for the flight conditions. */
+struct EngineLTO
+{
+    /* Piecewise log-log CO/HC model of SAGE v1.5 */
+    struct EmissionIndexFit {
+        double line1, line2, line3, horzline, intercept;
+        EmissionIndexFit( ) = default;
+        EmissionIndexFit( const std::array<double, 4>& LTO_fuelflow, const std::array<double, 4>& LTO_EI );
+        /* Emission index at the SLS-ISA fuel flow fuelflow_factor, before cruise correction */
+        double operator()( double fuelflow_factor ) const;
+    };
+
+    /* Thrust settings in order: idle, approach, climb out, take off */
+    std::array<double, 4> ratedThrust = {0.07, 0.30, 0.70, 1.00};
+    /* Installed fuel flow [kg/s] and emission indices [g/kg fuel] as read */
+    std::array<double, 4> LTO_fuelflow;
+    std::array<double, 4> LTO_NOx;
+    std::array<double, 4> LTO_CO;
+    std::array<double, 4> LTO_HC;
+
+    /* log10(EI_NOx) = NOxFit[0] * log10(fuelflow) + NOxFit[1] */
+    std::array<double, 2> NOxFit;
+    bool singularNOxFit;
+    EmissionIndexFit COFit;
+    EmissionIndexFit HCFit;
+
+    /* Fits use LTO values clamped to be strictly positive */
+    void computeFits();
+};
+
+/* Engine emissions databank (ENG_EI.txt), parsed once into a table indexed by engine name */
+class EngineDatabase
+{
+    public:
+
+        EngineDatabase( ) = delete;
+        /* Reads the file directly, bypassing the cache */
+        explicit EngineDatabase( const std::string& fileName );
+
+        /* Returns the database for fileName, reading it on first use. Thread-safe */
+        static std::shared_ptr<const EngineDatabase> load( const std::string& fileName );
+
+        /* nullptr if the engine is not in the database */
+        const EngineLTO* find( const std::string& engineName ) const;
+        inline std::size_t size() const { return engines_.size(); }
+
+    private:
+
+        std::unordered_map<std::string, EngineLTO> engines_;
+
+};
+
+#endif /* ENGINEDATABASE_H_INCLUDED */
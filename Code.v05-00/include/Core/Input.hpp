@@ -18,6 +18,8 @@
 #include <unordered_map>
 #include "Util/ForwardDecl.hpp"
 
+namespace YamlInputReader { struct CaseParameters; }
+
 class Input
 {
 
@@ -94,6 +96,13 @@ class Input
                 const std::string fileName_BOX,   \
                 const std::string fileName_micro, \
                 const std::string author          );
+        Input( unsigned int iCase,               \
+               const YamlInputReader::CaseParameters &parameters, \
+               const std::string fileName,       \
+               const std::string fileName_ADJ,   \
+               const std::string fileName_BOX,   \
+               const std::string fileName_micro, \
+               const std::string author          );
 
         ~Input();
         UInt Case() const { return Case_; }
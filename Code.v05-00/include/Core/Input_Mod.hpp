@@ -27,6 +27,7 @@ struct OptInput
     /* ========================================== */
 
     int         SIMULATION_OMP_NUM_THREADS;
+    bool        SIMULATION_PARALLEL_CASES;
     bool        SIMULATION_PARAMETER_SWEEP;
     bool        SIMULATION_MONTECARLO;
     int         SIMULATION_MCRUNS;
@@ -43,6 +44,11 @@ struct OptInput
     std::string SIMULATION_ADJOINT_FILENAME;
     bool        SIMULATION_BOXMODEL;
     std::string SIMULATION_BOX_FILENAME;
+    bool        SIMULATION_EPM_CACHE;
+    std::string SIMULATION_EPM_CACHE_FOLDER;
+    bool        SIMULATION_CHECKPOINT;
+    double      SIMULATION_CHECKPOINT_INTERVAL;
+    bool        SIMULATION_TIMING_REPORT;
 
     /* ========================================== */
     /* ---- PARAMETER MENU ---------------------- */
@@ -60,6 +66,9 @@ struct OptInput
     bool        TRANSPORT_UPDRAFT;
     double      TRANSPORT_UPDRAFT_TIMESCALE;
     double      TRANSPORT_UPDRAFT_VELOCITY;
+    std::string TRANSPORT_DIFFUSION_SOLVER;
+    std::string TRANSPORT_TRACER_DIFFUSION_SOLVER;
+    std::string TRANSPORT_ADVECTION_SCHEME;
 
     /* ========================================== */
     /* ---- CHEMISTRY MENU ---------------------- */
@@ -78,6 +87,7 @@ struct OptInput
     bool        AEROSOL_COAGULATION_SOLID;
     bool        AEROSOL_COAGULATION_LIQUID;
     double      AEROSOL_COAGULATION_TIMESTEP;
+    bool        AEROSOL_COAGULATION_TABLE;
     bool        AEROSOL_ICE_GROWTH;
     double      AEROSOL_ICE_GROWTH_TIMESTEP;
     
@@ -132,6 +142,11 @@ struct OptInput
     std::string      TS_AERO_FILENAME;
     std::vector<int> TS_AEROSOL;
     double           TS_AERO_FREQ;
+    bool             TS_AERO_SINGLE_FILE;
+    int              TS_AERO_CHUNK_SIZE;
+    int              TS_AERO_DEFLATE_LEVEL;
+    bool             TS_AERO_SHUFFLE;
+    int              TS_AERO_SIGNIFICANT_DIGITS;
 
     /* ========================================== */
     /* ---- PROD & LOSS MENU -------------------- */
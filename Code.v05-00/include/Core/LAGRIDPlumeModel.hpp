@@ -3,8 +3,11 @@
 
 #include "AIM/Aerosol.hpp"
 #include "LAGRID/RemappingFunctions.hpp"
-#include "FVM_ANDS/FVM_Solver.hpp"
+#include "LAGRID/RemapOperator.hpp"
+#include "FVM_ANDS/FVM_BatchSolver.hpp"
+#include "FVM_ANDS/SpectralDiffusion.hpp"
 #include "EPM/Integrate.hpp"
+#include "EPM/ResultCache.hpp"
 #include "Core/Diag_Mod.hpp"
 #include "Core/MPMSimVarsWrapper.hpp"
 #include "Core/TimestepVarsWrapper.hpp"
@@ -59,6 +62,16 @@ class LAGRIDPlumeModel {
         double simTime_h_;
         double solarTime_h_;
         double shear_rep_;
+        /* Key of the random temperature perturbations of this case */
+        Philox::Key rngKey_;
+        FVM_ANDS::DiffusionSolver diffusionSolver_;
+        FVM_ANDS::DiffusionSolver tracerDiffusionSolver_;
+        FVM_ANDS::AdvectionScheme advectionScheme_;
+        /* Number and mass of the ice, updated by diagnoseIce. Matches the pdf at the
+         * start of every time step */
+        AIM::Grid_Aerosol::Diagnostics iceDiag_;
+        /* Time series are written in the background while the time loop goes on */
+        Diag::TS_PhysWriter tsWriter_;
 
         typedef std::pair<std::vector<std::vector<int>>, VectorUtils::MaskInfo> MaskType;
         inline MaskType iceNumberMask(double cutoff_ratio = NUM_FILTER_RATIO) {
@@ -96,14 +109,23 @@ class LAGRIDPlumeModel {
         void initializeGrid();
         void saveTSAerosol();
         void initH2O();
+        /* Updates iceDiag_ for the current grid */
+        void diagnoseIce();
         void updateDiffVecs();
         void runTransport(double timestep);
         void remapAllVars(double remapTimestep, const std::vector<std::vector<int>>& mask, const VectorUtils::MaskInfo& maskInfo);
         void trimH2OBoundary();
-        std::pair<LAGRID::twoDGridVariable,LAGRID::twoDGridVariable> remapVariable(const VectorUtils::MaskInfo& maskInfo, const BufferInfo& buffers, const Vector_2D& phi, const std::vector<std::vector<int>>& mask);
+        LAGRID::RemapOperator remapOperator(const VectorUtils::MaskInfo& maskInfo, const BufferInfo& buffers, const std::vector<std::vector<int>>& mask);
         double totalAirMass();
         void runCocipH2OMixing(const Vector_2D& h2o_old, const Vector_2D& h2o_amb_new, MaskType& mask_old, MaskType& mask_new);
 
+        /* Checkpoints hold the state that evolves in the time loop. They are only valid
+         * for the inputs they were written with, see checkpointKey */
+        std::string checkpointFileName() const;
+        Vector_1D checkpointKey() const;
+        void saveCheckpoint() const;
+        bool loadCheckpoint();
+
 
 };
 
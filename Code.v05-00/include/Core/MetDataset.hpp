@@ -0,0 +1,61 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* MetDataset Header File                                           */
+/*                                                                  */
+/* File                 : MetDataset.hpp                            */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef METDATASET_H_INCLUDED
+#define METDATASET_H_INCLUDED
+
+#include <map>
+#include <memory>
+#include <string>
+#include "Util/ForwardDecl.hpp"
+
+/* Contents of a met input file, decoded once and never modified afterwards.
+ * All cases of a sweep running on the same file share one instance through MetDataset::load,
+ * so the file is opened and read a single time per process instead of once per case.
+ * Every Meteorology then only interpolates the shared profiles onto its own grid. */
+class MetDataset
+{
+    public:
+
+        struct Variable {
+            /* [altitude][time]. Variables without a time dimension have a single column */
+            Vector_2D data;
+            bool supportsTimeseries;
+        };
+
+        MetDataset() = delete;
+        /* Reads the file directly, bypassing the cache */
+        explicit MetDataset( const std::string& fileName );
+
+        /* Returns the cached dataset for fileName, reading it on first use.
+         * Thread-safe: concurrent callers for the same file wait for the single read in progress. */
+        static std::shared_ptr<const MetDataset> load( const std::string& fileName );
+        /* Drops the cache. Datasets still held by a Meteorology stay alive until released */
+        static void clearCache();
+
+        inline int altitudeDim() const { return altitude_.size(); }
+        inline int timeDim() const { return timeDim_; }
+        inline const Vector_1D& altitude() const { return altitude_; } // [m]
+        inline const Vector_1D& pressure() const { return pressure_; } // [Pa]
+
+        inline bool hasVariable( const std::string& varName ) const { return variables_.count(varName) > 0; }
+        const Variable& variable( const std::string& varName ) const;
+
+    private:
+
+        int timeDim_;
+        Vector_1D altitude_;
+        Vector_1D pressure_;
+        std::map<std::string, Variable> variables_;
+
+};
+
+#endif /* METDATASET_H_INCLUDED */
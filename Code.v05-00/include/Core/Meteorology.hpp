@@ -21,12 +21,13 @@
 
 #include "Util/ForwardDecl.hpp"
 #include "Core/Input_Mod.hpp"
+#include "Core/MetDataset.hpp"
 #include "Util/MetFunction.hpp"
 #include "Util/PhysFunction.hpp"
-#include <netcdf>
-
-using namespace netCDF;
-using namespace netCDF::exceptions;
+#include "Util/MC_Rand.hpp"
+#include <istream>
+#include <memory>
+#include <ostream>
 
 enum class MetVarLoadType : unsigned char {
     NoMetInput,
@@ -58,7 +59,14 @@ class Meteorology
         void Update( const double dt, const double solarTime_h, \
                      const double simTime_h, const double dTrav_x = 0, const double dTrav_y = 0);
         
-        void updateTempPerturb();
+        /* Draws a new temperature perturbation field. Each cell takes its own Philox draw
+         * for (key, step, cell index), so the field is the same for any number of threads */
+        void updateTempPerturb( const Philox::Key& key, std::uint32_t step );
+
+        /* Everything that evolves during a run, for checkpoints. Met file contents and
+         * load settings are not saved, they come from the constructor */
+        void saveState( std::ostream& os ) const;
+        void loadState( std::istream& is );
         inline double alt( int j ) const { return altitude_[j]; }
 	    inline double press( int j ) const { return pressure_[j]; }
         inline double shear( int j ) const { return shear_[j]; }
@@ -163,14 +171,14 @@ class Meteorology
             }
         }
 
-        void initAltitudeAndPress( const NcFile& dataFile );
-        void readMetVar( const NcFile& dataFile, std::string varName, Vector_2D& vec_ts, bool timeseries);
+        void initAltitudeAndPress();
+        const Vector_2D* readMetVar( const std::string& varName, bool timeseries ) const;
         void initTempNoMet(const Vector_1D& yCoords);
-        void initTemperature( const NcFile& dataFile );
+        void initTemperature();
         void initH2ONoMet( const Vector_1D& yCoords);
-        void initH2O( const NcFile& dataFile, const OptInput& OptInput );
-        void initShear( const NcFile& dataFile );
-        void initVertVeloc ( const NcFile& dataFile );
+        void initH2O( const OptInput& OptInput );
+        void initShear();
+        void initVertVeloc();
 
         Vector_1D interpMetTimeseriesData(double simTime_h, const Vector_2D& ts_data, bool timeseries) const;
 
@@ -201,17 +209,19 @@ class Meteorology
         double met_dt_h_;
         int altitudeDim_;
         int timeDim_;
-        Vector_1D pressureInit_; 
+        /* Met file contents, shared by all cases reading the same file */
+        std::shared_ptr<const MetDataset> metData_;
         Vector_1D altitudeInit_;
         Vector_1D tempInit_;
         Vector_1D shearInit_;
         Vector_1D rhiInit_;
         Vector_1D vertVelocInit_;
 
-	    Vector_2D tempTimeseriesData_;
-        Vector_2D shearTimeseriesData_;
-        Vector_2D rhiTimeseriesData_;
-        Vector_2D vertVelocTimeseriesData_;
+        /* [altitude][time], point into metData_ */
+        const Vector_2D* tempTimeseriesData_ = nullptr;
+        const Vector_2D* shearTimeseriesData_ = nullptr;
+        const Vector_2D* rhiTimeseriesData_ = nullptr;
+        const Vector_2D* vertVelocTimeseriesData_ = nullptr;
 
         /* Ambient input parameters */
         AmbientMetParams ambParams_;
@@ -0,0 +1,25 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* NetCDFMutex Header File                                          */
+/*                                                                  */
+/* File                 : NetCDFMutex.hpp                           */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef NETCDFMUTEX_H_INCLUDED
+#define NETCDFMUTEX_H_INCLUDED
+
+#include <mutex>
+
+/* The netCDF library is not thread-safe. Cases running concurrently
+ * go through this mutex for every read or write of a netCDF file. */
+inline std::mutex& netCDFMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+#endif /* NETCDFMUTEX_H_INCLUDED */
@@ -24,4 +24,17 @@ enum class SimStatus : int {
     EPMSuccess,
 };
 
+// Name of an exit status, as written to the status files and the case manifest
+inline const char* statusName(SimStatus status) {
+    switch (status) {
+        case SimStatus::Complete: return "Complete";
+        case SimStatus::Incomplete: return "Incomplete";
+        case SimStatus::NoWaterSaturation: return "NoWaterSaturation";
+        case SimStatus::NoPersistence: return "NoPersistence";
+        case SimStatus::NoSurvivalVortex: return "NoSurvivalVortex";
+        case SimStatus::Failed: return "Failed";
+        default: return "Unknown exit code";
+    }
+}
+
 #endif // STATUS_H_INCLUDED
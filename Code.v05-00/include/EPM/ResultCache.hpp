@@ -0,0 +1,54 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*                      Early Plume Microphysics                    */
+/*                              (EPM)                               */
+/*                                                                  */
+/* ResultCache Header File                                          */
+/*                                                                  */
+/* File                 : ResultCache.hpp                           */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef EPM_RESULTCACHE_H_INCLUDED
+#define EPM_RESULTCACHE_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include "EPM/Integrate.hpp"
+
+namespace EPM
+{
+    /* Memoization of EPM::Integrate across the cases of a run.
+     * The EPM result only depends on the ambient state, the emissions and a few aircraft properties,
+     * so sweeps over e.g. shear or diffusivity integrate the same early plume over and over.
+     * Results are keyed by the exact values of all these inputs and kept in memory for the whole process.
+     * With a cache folder set, they are also written to (and read from) one file per input set,
+     * so later runs can reuse them. */
+    class ResultCache
+    {
+        public:
+
+            ResultCache( ) = delete;
+
+            /* Cache is enabled, in memory only, by default */
+            static void configure( bool enabled, const std::string& folder = "" );
+
+            /* Same arguments as EPM::Integrate. On a hit, varArray is left untouched
+             * and the microphysics trace of the original run, if made by this process, is copied to micro_data_out. */
+            static std::pair<EPMOutput, SimStatus> Integrate( double tempInit_K, double pressure_Pa, double rhw, double bypassArea, double coreExitTemp, double varArray[],
+                                                              const Vector_2D& aerArray, const Aircraft& AC, const Emission& EI, bool CHEMISTRY, double ambientLapseRate, std::string micro_data_out );
+
+            /* Drops the in-memory results, files in the cache folder are kept */
+            static void clearCache();
+
+            static std::size_t hits();
+            static std::size_t misses();
+            /* Summary line for the run log */
+            static std::string summary();
+
+            /* 64-bit FNV-1a hash of the raw bytes of the inputs */
+            static std::uint64_t hash( const Vector_1D& key );
+    };
+}
+
+#endif /* EPM_RESULTCACHE_H_INCLUDED */
@@ -11,6 +11,20 @@ namespace FVM_ANDS{
     // Separate the SOR solver for testing without having to build an AdvDiffSystem object
     void sor_solve(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const Eigen::VectorXd &rhs, Eigen::VectorXd &phi, double omega = 1.0, double threshold = 1e-3, int n_iters = 3);
 
+    // Partition of the rows of a sparse matrix into colours, such that no two rows of the same colour are coupled.
+    // All rows of one colour can then be relaxed concurrently in a Gauss-Seidel / SOR sweep.
+    struct MatrixColoring {
+        std::vector<int> rows;       // Row indices grouped by colour
+        std::vector<int> colorStart; // Rows of colour c are rows[colorStart[c]] ... rows[colorStart[c+1] - 1]
+        inline int nColors() const { return static_cast<int>(colorStart.size()) - 1; }
+    };
+    MatrixColoring greedyColoring(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A);
+
+    // Multicolour SOR: same iteration as sor_solve, but rows are visited colour by colour (red-black for the 5-point stencil)
+    // so each colour can be split across threads. Convergence is checked on ||b - A*phi|| / ||b|| after each block of n_iters sweeps.
+    void multicolor_sor_solve(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const MatrixColoring &coloring, const Eigen::VectorXd &rhs, Eigen::VectorXd &phi,
+                              double omega = 1.0, double threshold = 1e-3, int n_iters = 3, bool parallel = true);
+
     struct AdvDiffParams {
         AdvDiffParams(double u, double v, double shear, double Dh, double Dv, double dt){
             this->u = u;
@@ -36,13 +50,41 @@ namespace FVM_ANDS{
             void applyBoundaryCondition();
             void updateBoundaryCondition(const BoundaryConditions& bc);
             Eigen::VectorXd forwardEulerAdvection(bool operatorSplit = false, bool parallelAdvection = false) const noexcept;
+            Eigen::VectorXd semiLagrangianAdvection(double dt, bool yFirst = false, bool parallelAdvection = false) const;
+
+            // Field-agnostic versions of the above. These only read the grid, boundary conditions and velocities of the system,
+            // so several fields sharing them (e.g. the ice bins in FVM_BatchSolver) can be advanced from one AdvDiffSystem.
+            // The vertical velocity v is uniform over the domain and passed per field, as is the advection timestep.
+            void forwardEulerAdvection(const Eigen::VectorXd& phi, double v, double dt, Eigen::VectorXd& soln, bool parallelAdvection = false) const noexcept;
+            // Conservative semi-Lagrangian advection over dt for the flow u(y) = u - shear * y and a uniform v.
+            // The velocity is uniform along every grid row (x) and column (y), so each direction is an exact shift of the
+            // minmod-limited piecewise linear reconstruction of the field (flux-form remap), done row by row and then column
+            // by column (columns first if yFirst). Stable for any Courant number, so no CFL substepping is needed.
+            // Inflow through a boundary carries the Dirichlet boundary value. Only the interior of soln is written.
+            void semiLagrangianAdvection(const Eigen::VectorXd& phi, double v, double dt, Eigen::VectorXd& soln, bool yFirst = false, bool parallelAdvection = false) const;
+            void calcRHS(const Eigen::VectorXd& phi, double v, Eigen::VectorXd& rhs) const;
+            void applyBoundaryCondition(Eigen::VectorXd& phi) const;
             // Breakup the implementation of sor_solve to allow for easy testing by inputing an arbitrary linear system to solve:
             // Implementation is moved outside of the class, and make class method to be used in code
             void sor_solve(double omega = 1.0, double threshold = 1e-3, int n_iters = 3){ FVM_ANDS::sor_solve(totalCoefMatrix_, rhs_, phi_, omega, threshold, n_iters); };
+            void multicolor_sor_solve(double omega = 1.0, double threshold = 1e-3, int n_iters = 3, bool parallel = true){
+                FVM_ANDS::multicolor_sor_solve(totalCoefMatrix_, coloring_, rhs_, phi_, omega, threshold, n_iters, parallel);
+            };
+            // Alternating direction implicit diffusion solve: (I - dt*Dxx)(I - dt*Dyy) phi = rhs, i.e. the implicit diffusion step
+            // with an O(dt^2) splitting error, computed with one tridiagonal (Thomas) solve per grid row and then per grid column.
+            // Does not use the coefficient matrix. Only the interior of rhs is read; ghost points of phi are updated on return.
+            void adiDiffusionSolve(const Eigen::VectorXd& rhs, Eigen::VectorXd& phi, bool parallel = false) const;
+            void adiDiffusionSolve(bool parallel = false){ adiDiffusionSolve(rhs_, phi_, parallel); };
+            // Exact in time implicit diffusion step using the sine transform (see SpectralDiffusion.hpp).
+            // Only valid for uniform diffusivities and zero Dirichlet boundaries, throws otherwise.
+            void spectralDiffusionSolve(const Eigen::VectorXd& rhs, Eigen::VectorXd& phi) const;
+            void spectralDiffusionSolve(){ spectralDiffusionSolve(rhs_, phi_); };
+            bool spectralDiffusionApplicable() const;
             inline const Eigen::VectorXd& getRHS() const { return rhs_; }
             inline const Eigen::VectorXd& phi() const { return phi_; }
             inline const std::vector<std::unique_ptr<Point>>& points() const { return points_; }
             inline const Eigen::SparseMatrix<double, Eigen::RowMajor>& getCoefMatrix() const { return totalCoefMatrix_; }
+            inline const MatrixColoring& coloring() const { return coloring_; }
             inline void updatePhi(const Eigen::VectorXd& phi_new){ 
                 //Need to resize to account for grid changing in size.
                 phi_.resize(nx_ * ny_ + 2*nx_ + 2*ny_);
@@ -89,6 +131,7 @@ namespace FVM_ANDS{
                 updateDy(dx_new);
                 updateNy(yCoord_new.size());
                 updateNx(nx_new);
+                coefPatternBuilt_ = false;
             }
             inline void updateTimestep(double dt){ dt_ = dt; }
             inline double courant() const{
@@ -97,6 +140,11 @@ namespace FVM_ANDS{
                 };
                 return maxCoeffAbsolute(u_vec_) * dt_ / dx_ + maxCoeffAbsolute(v_vec_) * dt_ / dy_;
             }
+            inline double courant(double v) const{
+                return std::max(u_vec_.maxCoeff(), std::abs(u_vec_.minCoeff())) * dt_ / dx_ + std::abs(v) * dt_ / dy_;
+            }
+            inline int nTotalPoints() const { return nTotalPoints_; }
+            inline int nInteriorPoints() const { return nInteriorPoints_; }
             inline void scaleRHS(double scalingFactor) { rhs_ = rhs_ * scalingFactor; }
             inline void scalePhi(double scalingFactor) { phi_ = phi_ * scalingFactor; }
             void scaleBC(double scalingFactor) {
@@ -147,13 +195,42 @@ namespace FVM_ANDS{
             Eigen::VectorXd source_;
             Eigen::VectorXd deferredCorr_;
 
+            // Flat copy of the stencil described by points_, rebuilt by buildStencil() whenever the point list or BCs change.
+            // Used by the advection, RHS and boundary condition loops so they avoid the virtual Point / std::optional lookups.
+            // Interior points: neighbour indices (ghost point index on a boundary face), bit flags of the faces
+            // lying on a Dirichlet boundary and the boundary value on each face (0 if the face is not a boundary).
+            static constexpr unsigned char NORTH_FACE = 1 << 0;
+            static constexpr unsigned char SOUTH_FACE = 1 << 1;
+            static constexpr unsigned char EAST_FACE = 1 << 2;
+            static constexpr unsigned char WEST_FACE = 1 << 3;
+            std::vector<int> nbrN_;
+            std::vector<int> nbrS_;
+            std::vector<int> nbrE_;
+            std::vector<int> nbrW_;
+            std::vector<unsigned char> boundaryFaces_;
+            Vector_1D bcValN_;
+            Vector_1D bcValS_;
+            Vector_1D bcValE_;
+            Vector_1D bcValW_;
+            // Ghost points (offset by nInteriorPoints_): corresponding interior point and boundary value.
+            std::vector<int> ghostCorr_;
+            Vector_1D ghostBcVal_;
+            // Position of the E, W, N, S and centre coefficient of each interior row in totalCoefMatrix_.valuePtr(),
+            // so buildCoeffMatrix can refresh values without reassembling the matrix.
+            std::vector<int> coefPos_;
+            bool coefPatternBuilt_;
+            // Colouring of the matrix rows for multicolor_sor_solve, only depends on the sparsity pattern.
+            MatrixColoring coloring_;
+
             void initVelocVecs();
             void buildPointList();
+            void buildStencil();
+            void buildCoeffPattern();
             void buildAdvectionCoeffs(int i, double& coeff_C, double& coeff_N, double& coeff_S, double& coeff_E, double& coeff_W);
             void updateGhostNodes();
 
-            inline bool isValidPointID(int idx) const {
-                return (idx >= 0 && idx < phi_.rows());
+            inline bool isValidPointID(const Eigen::VectorXd& phi, int idx) const {
+                return (idx >= 0 && idx < phi.rows());
             }
 
             inline double minmod(int pointID, FaceDirection face, double faceVelocity) const noexcept {
@@ -237,71 +314,71 @@ namespace FVM_ANDS{
                 }
                 return std::max(0.0, std::min(r, 1.0));
             }
-            inline double minmod_N_vPos(int pointID) const noexcept{
-                if(!isValidPointID(pointID + 1) || !isValidPointID(pointID - 1)) return 0;
-                double phi_P = phi_[pointID];
-                double phi_N = phi_[pointID + 1];
-                double phi_S = phi_[pointID - 1];
+            inline double minmod_N_vPos(const Eigen::VectorXd& phi, int pointID) const noexcept{
+                if(!isValidPointID(phi, pointID + 1) || !isValidPointID(phi, pointID - 1)) return 0;
+                double phi_P = phi[pointID];
+                double phi_N = phi[pointID + 1];
+                double phi_S = phi[pointID - 1];
                 double r = (phi_N - phi_P == 0) ? 0 : (phi_P - phi_S) / (phi_N - phi_P);
                 return std::max(0.0, std::min(r, 1.0));
             }
-            inline double minmod_N_vNeg(int pointID) const noexcept{
-                if(!isValidPointID(pointID + 2)) return 0;
-                double phi_P = phi_[pointID];
-                double phi_N = phi_[pointID + 1];
-                double phi_NN = phi_[pointID + 2];
+            inline double minmod_N_vNeg(const Eigen::VectorXd& phi, int pointID) const noexcept{
+                if(!isValidPointID(phi, pointID + 2)) return 0;
+                double phi_P = phi[pointID];
+                double phi_N = phi[pointID + 1];
+                double phi_NN = phi[pointID + 2];
                 double r = (phi_N - phi_P == 0) ? 0 : (phi_NN - phi_N) / (phi_N - phi_P);
                 return std::max(0.0, std::min(r, 1.0));
             }
-            inline double minmod_S_vPos(int pointID) const noexcept{
-                if(!isValidPointID(pointID - 2)) return 0;
-                double phi_P = phi_[pointID];
-                double phi_S = phi_[pointID - 1];
-                double phi_SS = phi_[pointID - 2];
+            inline double minmod_S_vPos(const Eigen::VectorXd& phi, int pointID) const noexcept{
+                if(!isValidPointID(phi, pointID - 2)) return 0;
+                double phi_P = phi[pointID];
+                double phi_S = phi[pointID - 1];
+                double phi_SS = phi[pointID - 2];
                 double r = (phi_P - phi_S == 0) ? 0 : (phi_S - phi_SS) / (phi_P - phi_S);
                 return std::max(0.0, std::min(r, 1.0));
             }
-            inline double minmod_S_vNeg(int pointID) const noexcept{
-                if(!isValidPointID(pointID - 1) || neighbor_point(FaceDirection::NORTH, pointID)) return 0;
-                double phi_P = phi_[pointID];
-                double phi_S = phi_[pointID - 1];
-                double phi_N = phi_[neighbor_point(FaceDirection::NORTH, pointID)];
+            inline double minmod_S_vNeg(const Eigen::VectorXd& phi, int pointID) const noexcept{
+                if(!isValidPointID(phi, pointID - 1) || nbrN_[pointID]) return 0;
+                double phi_P = phi[pointID];
+                double phi_S = phi[pointID - 1];
+                double phi_N = phi[nbrN_[pointID]];
                 double r = (phi_P - phi_S == 0) ? 0 : (phi_N - phi_P) / (phi_P - phi_S);
                 return std::max(0.0, std::min(r, 1.0));
             }
-            inline double minmod_E_vPos(int pointID) const noexcept{
-                if(!isValidPointID(pointID + ny_) || !isValidPointID(pointID - ny_)) return 0;
-                double phi_P = phi_[pointID];
-                double phi_E = phi_[pointID + ny_];
-                double phi_W = phi_[pointID - ny_];
+            inline double minmod_E_vPos(const Eigen::VectorXd& phi, int pointID) const noexcept{
+                if(!isValidPointID(phi, pointID + ny_) || !isValidPointID(phi, pointID - ny_)) return 0;
+                double phi_P = phi[pointID];
+                double phi_E = phi[pointID + ny_];
+                double phi_W = phi[pointID - ny_];
                 double r = (phi_E - phi_P == 0) ? 0 : (phi_P - phi_W) / (phi_E - phi_P);
                 return std::max(0.0, std::min(r, 1.0));
             }
 
-            inline double minmod_E_vNeg(int pointID) const noexcept{
-                if(!isValidPointID(pointID + 2*ny_)) return 0;
-                double phi_P = phi_[pointID];
-                double phi_E = phi_[pointID + ny_];
+            inline double minmod_E_vNeg(const Eigen::VectorXd& phi, int pointID) const noexcept{
+                if(!isValidPointID(phi, pointID + 2*ny_)) return 0;
+                double phi_P = phi[pointID];
+                double phi_E = phi[pointID + ny_];
                 if (phi_E - phi_P == 0) return 0;                    
-                double phi_EE = phi_[pointID + ny_ + ny_];
+                double phi_EE = phi[pointID + ny_ + ny_];
                 double r = (phi_EE - phi_E) / (phi_E - phi_P);
                 return std::max(0.0, std::min(r, 1.0));
             }
-            inline double minmod_W_vPos(int pointID) const noexcept{
-                if(!isValidPointID(pointID - 2*ny_)) return 0;
-                double phi_P = phi_[pointID];
-                double phi_W = phi_[pointID - ny_];
+            inline double minmod_W_vPos(const Eigen::VectorXd& phi, int pointID) const noexcept{
+                if(!isValidPointID(phi, pointID - 2*ny_)) return 0;
+                double phi_P = phi[pointID];
+                double phi_W = phi[pointID - ny_];
                 if(phi_P - phi_W == 0) return 0;    
-                double phi_WW = phi_[pointID - ny_ - ny_];
+                double phi_WW = phi[pointID - ny_ - ny_];
                 double r = (phi_W - phi_WW) / (phi_P - phi_W);
                 return std::max(0.0, std::min(r, 1.0));
             }
-            inline double minmod_W_vNeg(int pointID) const noexcept{
-                if(!isValidPointID(pointID - ny_) || !isValidPointID(pointID + ny_)) return 0;
-                double phi_P = phi_[pointID];
-                double phi_W = phi_[pointID - ny_];
+            inline double minmod_W_vNeg(const Eigen::VectorXd& phi, int pointID) const noexcept{
+                if(!isValidPointID(phi, pointID - ny_) || !isValidPointID(phi, pointID + ny_)) return 0;
+                double phi_P = phi[pointID];
+                double phi_W = phi[pointID - ny_];
                 if(phi_P - phi_W == 0) return 0;    
-                double phi_E = phi_[pointID + ny_];
+                double phi_E = phi[pointID + ny_];
                 double r = (phi_E - phi_P) / (phi_P - phi_W);
                 return std::max(0.0, std::min(r, 1.0));
             }
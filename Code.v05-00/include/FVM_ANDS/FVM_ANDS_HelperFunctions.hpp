@@ -4,12 +4,16 @@
 #include <Eigen/Sparse>
 #include <Util/ForwardDecl.hpp>
 #include <Util/PhysConstant.hpp>
+#include "Util/Field_3D.hpp"
 #include "FVM_ANDS/BoundaryCondition.hpp"
 
 namespace FVM_ANDS{
     int twoDIdx_to_vecIdx(int idx_x, int idx_y, int nx, int ny, vecFormat format = vecFormat::COLMAJOR);
     Eigen::VectorXd std2dVec_to_eigenVec(const Vector_2D& phi, vecFormat format = vecFormat::COLMAJOR);
     BoundaryConditions bcFrom2DVector(const Vector_2D& initialVec, bool zeroBC = false);
+    BoundaryConditions bcFrom2DVector(Field_3D::ConstBinView initialVec, bool zeroBC = false);
     Vector_2D eigenVec_to_std2dVec(Eigen::VectorXd eig_vec, int nx, int ny);
+    DiffusionSolver diffusionSolverFromString(const std::string& name);
+    AdvectionScheme advectionSchemeFromString(const std::string& name);
 } 
 #endif
\ No newline at end of file
@@ -25,7 +25,14 @@ namespace FVM_ANDS{
     enum class AdvectionScheme : unsigned char {
         FirstOrderUpwind,
         CentralDifference,
-        MinMod
+        MinMod,
+        SemiLagrangian
+    };
+    enum class DiffusionSolver : unsigned char {
+        SOR,
+        MulticolorSOR,
+        ADI,
+        Spectral
     };
     enum class vecFormat: unsigned char {
         ROWMAJOR,
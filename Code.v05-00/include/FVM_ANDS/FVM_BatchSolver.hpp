@@ -0,0 +1,59 @@
+#ifndef FVM_ANDS_BATCHSOLVER_H
+#define FVM_ANDS_BATCHSOLVER_H
+
+#include "FVM_ANDS/AdvDiffSystem.hpp"
+#include "Util/Field_3D.hpp"
+
+namespace FVM_ANDS{
+    // Operator split transport of many fields sharing one grid, boundary condition, diffusivity and horizontal wind,
+    // e.g. the bins of the ice aerosol PDF, which only differ by their settling velocity.
+    // The point list and the implicit diffusion matrix are built once and reused for every field,
+    // instead of constructing one FVM_Solver (and one AdvDiffSystem) per field.
+    class FVM_BatchSolver{
+        public:
+            FVM_BatchSolver(const AdvDiffParams& params, const Vector_1D& xCoords, const Vector_1D& yCoords, const BoundaryConditions& bc);
+
+            // Advances each bin by one timestep. fields[n] is advected with vertical velocity v[n].
+            // Bins are distributed over threads when parallel is set, and are read and written in place through Eigen maps.
+            void operatorSplitSolve2DVec(Field_3D& fields, const Vector_1D& v, bool parallel = true, double courant_max = 0.5);
+            // Single field: with a multicolour SOR or ADI diffusion solver, parallel spreads the diffusion solve over threads instead.
+            void operatorSplitSolve2DVec(Vector_2D& field, double v = 0, bool parallel = true, double courant_max = 0.5);
+
+            inline void updateTimestep(double dt){
+                advDiffSys_.updateTimestep(dt);
+                matrixBuilt_ = false;
+            }
+            inline void updateDiffusion(double Dh, double Dv){
+                advDiffSys_.updateDiffusion(Dh, Dv);
+                matrixBuilt_ = false;
+            }
+            inline void updateDiffusion(const Vector_2D& Dh, const Vector_2D& Dv){
+                advDiffSys_.updateDiffusion(Dh, Dv);
+                matrixBuilt_ = false;
+            }
+            // Vertical velocity is set per field in operatorSplitSolve2DVec
+            inline void updateAdvection(double u, double shear){
+                advDiffSys_.updateAdvection(u, 0, shear);
+            }
+            inline void updateBoundaryCondition(const BoundaryConditions& bc){
+                advDiffSys_.updateBoundaryCondition(bc);
+            }
+            inline void setDiffusionSolver(DiffusionSolver diffusionSolver){
+                diffusionSolver_ = diffusionSolver;
+            }
+            inline void setAdvectionScheme(AdvectionScheme advectionScheme){
+                advectionScheme_ = advectionScheme;
+            }
+
+        private:
+            void buildDiffusionMatrix();
+            void solveField(Field_3D::BinMap field, double v, double courant_max, bool parallelDiffusion, Eigen::VectorXd& phi, Eigen::VectorXd& work) const;
+            void advectionHalfStep(Eigen::VectorXd& phi, double v, double courant_max, bool secondHalf, Eigen::VectorXd& work) const;
+
+            AdvDiffSystem advDiffSys_;
+            bool matrixBuilt_;
+            DiffusionSolver diffusionSolver_;
+            AdvectionScheme advectionScheme_;
+    };
+}
+#endif
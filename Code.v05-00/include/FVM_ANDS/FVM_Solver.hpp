@@ -14,6 +14,8 @@ namespace FVM_ANDS{
 
             const Eigen::VectorXd& operatorSplitSolve(bool parallelAdvection = false, double courant_max = 0.5);
             void operatorSplitSolve2DVec(Vector_2D& vec, const BoundaryConditions& bc, bool parallelAdvection = false, double courant_max = 0.5);
+            // Same for one bin of a Field_3D, read and written in place
+            void operatorSplitSolve2DVec(Field_3D::BinView bin, const BoundaryConditions& bc, bool parallelAdvection = false, double courant_max = 0.5);
 
             void advectionHalfTimestepSolve(Vector_2D& vec, const BoundaryConditions& bc, double courant_max = 0.5);
 
@@ -38,12 +40,22 @@ namespace FVM_ANDS{
             inline void setMaxIters(int iters){
                 maxIters_ = iters;
             }
+            inline void setDiffusionSolver(DiffusionSolver diffusionSolver){
+                diffusionSolver_ = diffusionSolver;
+            }
+            // MinMod: explicit Euler substeps limited by courant_max. SemiLagrangian: one unconditionally stable remap per half step.
+            inline void setAdvectionScheme(AdvectionScheme advectionScheme){
+                advectionScheme_ = advectionScheme;
+            }
             inline void updateBoundaryCondition(const BoundaryConditions& bc){
                 advDiffSys_.updateBoundaryCondition(bc);
             }
             inline void updatePhi(const Eigen::VectorXd& phi){
                 advDiffSys_.updatePhi(phi);
             }
+            inline void addSource(const Eigen::VectorXd& source){
+                advDiffSys_.addSource(source);
+            }
             inline void updateSpacing(const Vector_1D& yCoords_new, double dx_new, int nx_new) {
                 advDiffSys_.updateSpacing(yCoords_new, dx_new, nx_new);
             }
@@ -90,10 +102,15 @@ namespace FVM_ANDS{
                 return sum;
             }
         private:
+            void diffusionSolve(bool parallel);
+            void advectionHalfStep(bool secondHalf, bool parallelAdvection, double courant_max);
+
             int maxIters_;
             double convergenceThres_;
             AdvDiffSystem advDiffSys_;
             bool useDiagPreCond_;
+            DiffusionSolver diffusionSolver_;
+            AdvectionScheme advectionScheme_;
             Eigen::DiagonalMatrix<double, -1> diagPreCond;
             Eigen::DiagonalMatrix<double, -1> diagPreCond_inv;
             Eigen::BiCGSTAB<Eigen::SparseMatrix<double, Eigen::RowMajor>, Eigen::DiagonalPreconditioner<double> > solver_;
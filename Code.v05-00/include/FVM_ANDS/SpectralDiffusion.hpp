@@ -0,0 +1,20 @@
+#ifndef FVM_ANDS_SPECTRALDIFFUSION_H
+#define FVM_ANDS_SPECTRALDIFFUSION_H
+
+#include <string>
+
+namespace FVM_ANDS{
+    // Enables loading FFTW wisdom (FFTW_Wisdom.out in wisdomDir) when the sine transform plans are created.
+    // Must be called before the first spectral solve to have an effect on the plans.
+    void setFFTWWisdom(bool useWisdom, const std::string& wisdomDir);
+    // Saves the wisdom gathered by the plans created since the last export, if wisdom is enabled.
+    // Called once at the end of a case rather than for every new grid size.
+    void exportFFTWWisdom();
+
+    // Exact diffusion propagator phi_out = exp(dt * (D0 * d2/dx0^2 + D1 * d2/dx1^2)) phi_in for the 5-point finite volume
+    // Laplacian on a uniform n0 x n1 cell-centred grid with zero Dirichlet boundaries, stored as phi[i0 * n1 + i1].
+    // The sine transform (DST-II / DST-III) diagonalizes that Laplacian, so the propagator is applied mode by mode.
+    // FFTW plans of the most recently used grid sizes are cached and shared by all threads; phi_in and phi_out may alias.
+    void spectralDiffusionPropagate(const double* phi_in, double* phi_out, int n0, int n1, double h0, double h1, double D0, double D1, double dt);
+}
+#endif
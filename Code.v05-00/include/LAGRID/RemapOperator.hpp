@@ -0,0 +1,53 @@
+#ifndef LAGRID_REMAPOPERATOR_H
+#define LAGRID_REMAPOPERATOR_H
+
+#include <Eigen/Sparse>
+#include "LAGRID/RemappingFunctions.hpp"
+#include "Util/Field_3D.hpp"
+
+namespace LAGRID {
+    /*
+    Box-to-cell remapping as a linear operator.
+    The overlap of each masked source cell (box) with the cells of the new structured grid only depends on the mask,
+    the old grid geometry and the Remapping, not on the remapped field. The overlap weights are computed once into a
+    sparse matrix (one row per new cell, buffers included) and then applied to every field sharing that mask.
+    Applying it to field phi gives the same result as
+        mapToStructuredGrid(rectToBoxGrid(..., phi, mask), remapping).addBuffer(..., 0.0)
+    and unusedFraction() matches getUnusedFraction(...).addBuffer(..., 1.0).
+    */
+    class RemapOperator {
+        public:
+            typedef Eigen::SparseMatrix<double, Eigen::RowMajor> WeightMatrix;
+
+            RemapOperator() = delete;
+            // Arguments as for rectToBoxGrid and twoDGridVariable::addBuffer
+            RemapOperator(const Vector_1D& dy_new, double dx_old, double x0_old, double y0_new, const vector<vector<int>>& mask,
+                          const Remapping& remapping, double bufLen_left, double bufLen_right, double bufLen_top, double bufLen_bot);
+
+            // Remapped concentration field, zero in the buffer.
+            Vector_2D apply(const Vector_2D& phi) const;
+            Vector_2D apply(Field_3D::ConstBinView phi) const;
+            // Remaps all bins at once with a single sparse-dense product.
+            Field_3D apply(const Field_3D& phi) const;
+
+            // Fraction of each new cell not covered by any box, one in the buffer.
+            inline const twoDGridVariable& unusedFraction() const { return unusedFraction_; }
+            inline const Vector_1D& xCoords() const { return unusedFraction_.xCoords; }
+            inline const Vector_1D& yCoords() const { return unusedFraction_.yCoords; }
+            inline double dx() const { return unusedFraction_.dx; }
+            inline double dy() const { return unusedFraction_.dy; }
+            inline std::size_t nx() const { return unusedFraction_.xCoords.size(); }
+            inline std::size_t ny() const { return unusedFraction_.yCoords.size(); }
+            inline const WeightMatrix& weights() const { return weights_; }
+
+        private:
+            void checkSourceDims(std::size_t ny, std::size_t nx) const;
+
+            std::size_t nySource_;
+            std::size_t nxSource_;
+            WeightMatrix weights_;
+            twoDGridVariable unusedFraction_;
+    };
+}
+
+#endif
@@ -0,0 +1,94 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* BinaryIO Header File                                             */
+/*                                                                  */
+/* File                 : BinaryIO.hpp                              */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef BINARYIO_H_INCLUDED
+#define BINARYIO_H_INCLUDED
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include "Util/ForwardDecl.hpp"
+#include "Util/Field_3D.hpp"
+
+/* Raw binary (de)serialization in native byte order, for files written and
+ * read back by the same build (caches, checkpoints). Reads throw
+ * std::runtime_error on truncated or inconsistent input. */
+namespace BinaryIO
+{
+    /* Sanity limit on stored sizes, guards against allocating garbage */
+    const std::uint64_t MAX_SIZE = std::uint64_t(1) << 32;
+
+    template<typename T>
+    inline void write( std::ostream& os, const T& value ) {
+        static_assert( std::is_trivially_copyable_v<T>, "BinaryIO::write needs a trivially copyable type" );
+        os.write( reinterpret_cast<const char*>(&value), sizeof(T) );
+    }
+
+    template<typename T>
+    inline void read( std::istream& is, T& value ) {
+        static_assert( std::is_trivially_copyable_v<T>, "BinaryIO::read needs a trivially copyable type" );
+        if ( !is.read( reinterpret_cast<char*>(&value), sizeof(T) ) )
+            throw std::runtime_error( "Unexpected end of binary file" );
+    }
+
+    inline std::uint64_t readSize( std::istream& is ) {
+        std::uint64_t size;
+        read( is, size );
+        if ( size > MAX_SIZE )
+            throw std::runtime_error( "Invalid size in binary file" );
+        return size;
+    }
+
+    inline void write( std::ostream& os, const Vector_1D& vec ) {
+        write<std::uint64_t>( os, vec.size() );
+        os.write( reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(double) );
+    }
+
+    inline void read( std::istream& is, Vector_1D& vec ) {
+        vec.resize( readSize( is ) );
+        if ( !is.read( reinterpret_cast<char*>(vec.data()), vec.size() * sizeof(double) ) )
+            throw std::runtime_error( "Unexpected end of binary file" );
+    }
+
+    inline void write( std::ostream& os, const Vector_2D& vec ) {
+        write<std::uint64_t>( os, vec.size() );
+        for ( const Vector_1D& row: vec )
+            write( os, row );
+    }
+
+    inline void read( std::istream& is, Vector_2D& vec ) {
+        vec.resize( readSize( is ) );
+        for ( Vector_1D& row: vec )
+            read( is, row );
+    }
+
+    inline void write( std::ostream& os, const Field_3D& field ) {
+        write<std::uint64_t>( os, field.nBin() );
+        write<std::uint64_t>( os, field.ny() );
+        write<std::uint64_t>( os, field.nx() );
+        os.write( reinterpret_cast<const char*>(field.data()), field.nBin() * field.ny() * field.nx() * sizeof(double) );
+    }
+
+    inline void read( std::istream& is, Field_3D& field ) {
+        const std::uint64_t nBin = readSize( is );
+        const std::uint64_t ny = readSize( is );
+        const std::uint64_t nx = readSize( is );
+        if ( nBin * ny * nx > MAX_SIZE )
+            throw std::runtime_error( "Invalid size in binary file" );
+        field.assign( nBin, ny, nx );
+        if ( !is.read( reinterpret_cast<char*>(field.data()), nBin * ny * nx * sizeof(double) ) )
+            throw std::runtime_error( "Unexpected end of binary file" );
+    }
+}
+
+#endif /* BINARYIO_H_INCLUDED */
@@ -0,0 +1,132 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* Field_3D Header File                                             */
+/*                                                                  */
+/* File                 : Field_3D.hpp                              */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef FIELD_3D_H_INCLUDED
+#define FIELD_3D_H_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <Eigen/Core>
+#include "Util/ForwardDecl.hpp"
+
+/* Binned 2D field stored contiguously as [bin][y][x] in a single aligned allocation.
+ * Indexing with field[iBin][jNy][iNx] works as for Vector_3D: field[iBin] is a view on one bin
+ * and field[iBin][jNy] a std::span on one row. Each bin can also be used as a row-major
+ * (Ny x Nx) Eigen matrix without copying. */
+class Field_3D
+{
+    public:
+
+        typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorMatrix;
+        /* Bins are contiguous but only the start of the field is guaranteed to be aligned */
+        typedef Eigen::Map<RowMajorMatrix> BinMap;
+        typedef Eigen::Map<const RowMajorMatrix> ConstBinMap;
+
+        template<typename T>
+        class BinView_
+        {
+            public:
+                BinView_( T* data, std::size_t ny, std::size_t nx ): data_(data), ny_(ny), nx_(nx) { }
+
+                /* Mutable views convert to const views */
+                template<typename U = T, typename = std::enable_if_t<!std::is_const_v<U>>>
+                operator BinView_<const U>() const { return BinView_<const U>(data_, ny_, nx_); }
+
+                inline std::span<T> operator[]( std::size_t jNy ) const { return std::span<T>(data_ + jNy * nx_, nx_); }
+                /* Number of rows, as for a Vector_2D */
+                inline std::size_t size() const { return ny_; }
+                inline std::size_t ny() const { return ny_; }
+                inline std::size_t nx() const { return nx_; }
+                inline T* data() const { return data_; }
+
+                inline Eigen::Map<std::conditional_t<std::is_const_v<T>, const RowMajorMatrix, RowMajorMatrix>> matrix() const {
+                    return Eigen::Map<std::conditional_t<std::is_const_v<T>, const RowMajorMatrix, RowMajorMatrix>>(data_, ny_, nx_);
+                }
+                Vector_2D toVector2D() const {
+                    Vector_2D vec(ny_);
+                    for ( std::size_t jNy = 0; jNy < ny_; jNy++ )
+                        vec[jNy].assign(data_ + jNy * nx_, data_ + (jNy + 1) * nx_);
+                    return vec;
+                }
+
+            private:
+                T* data_;
+                std::size_t ny_, nx_;
+        };
+        typedef BinView_<double> BinView;
+        typedef BinView_<const double> ConstBinView;
+
+        Field_3D( ): nBin_(0), ny_(0), nx_(0) { }
+        Field_3D( std::size_t nBin, std::size_t ny, std::size_t nx, double value = 0.0E+00 ):
+            nBin_(nBin), ny_(ny), nx_(nx), data_(nBin * ny * nx, value) { }
+        explicit Field_3D( const Vector_3D& vec ):
+            Field_3D(vec.size(), vec.empty() ? 0 : vec[0].size(), (vec.empty() || vec[0].empty()) ? 0 : vec[0][0].size())
+        {
+            for ( std::size_t iBin = 0; iBin < nBin_; iBin++ )
+                setBin(iBin, vec[iBin]);
+        }
+
+        inline double& operator()( std::size_t iBin, std::size_t jNy, std::size_t iNx ) { return data_[(iBin * ny_ + jNy) * nx_ + iNx]; }
+        inline double operator()( std::size_t iBin, std::size_t jNy, std::size_t iNx ) const { return data_[(iBin * ny_ + jNy) * nx_ + iNx]; }
+        inline BinView operator[]( std::size_t iBin ) { return BinView(binData(iBin), ny_, nx_); }
+        inline ConstBinView operator[]( std::size_t iBin ) const { return ConstBinView(binData(iBin), ny_, nx_); }
+
+        /* Number of bins, as for a Vector_3D */
+        inline std::size_t size() const { return nBin_; }
+        inline std::size_t nBin() const { return nBin_; }
+        inline std::size_t ny() const { return ny_; }
+        inline std::size_t nx() const { return nx_; }
+        inline bool empty() const { return data_.empty(); }
+
+        inline double* data() { return data_.data(); }
+        inline const double* data() const { return data_.data(); }
+        inline double* binData( std::size_t iBin ) { return data_.data() + iBin * ny_ * nx_; }
+        inline const double* binData( std::size_t iBin ) const { return data_.data() + iBin * ny_ * nx_; }
+        inline BinMap binMatrix( std::size_t iBin ) { return BinMap(binData(iBin), ny_, nx_); }
+        inline ConstBinMap binMatrix( std::size_t iBin ) const { return ConstBinMap(binData(iBin), ny_, nx_); }
+        /* Whole field as one flat vector, e.g. for element-wise operations over all bins */
+        inline Eigen::Map<Eigen::VectorXd, Eigen::Aligned> flat() { return Eigen::Map<Eigen::VectorXd, Eigen::Aligned>(data_.data(), data_.size()); }
+        inline Eigen::Map<const Eigen::VectorXd, Eigen::Aligned> flat() const { return Eigen::Map<const Eigen::VectorXd, Eigen::Aligned>(data_.data(), data_.size()); }
+
+        /* Reshapes the field; previous values are not preserved */
+        void assign( std::size_t nBin, std::size_t ny, std::size_t nx, double value = 0.0E+00 ) {
+            nBin_ = nBin;
+            ny_ = ny;
+            nx_ = nx;
+            data_.assign(nBin * ny * nx, value);
+        }
+        void setBin( std::size_t iBin, const Vector_2D& phi ) {
+            if ( phi.size() != ny_ || ( ny_ > 0 && phi[0].size() != nx_ ) ) {
+                throw std::invalid_argument("Field_3D::setBin: bin dimensions do not match the field");
+            }
+            double* bin = binData(iBin);
+            for ( std::size_t jNy = 0; jNy < ny_; jNy++ )
+                std::copy(phi[jNy].begin(), phi[jNy].end(), bin + jNy * nx_);
+        }
+        Vector_3D toVector3D() const {
+            Vector_3D vec(nBin_);
+            for ( std::size_t iBin = 0; iBin < nBin_; iBin++ )
+                vec[iBin] = (*this)[iBin].toVector2D();
+            return vec;
+        }
+
+    private:
+
+        std::size_t nBin_, ny_, nx_;
+        std::vector<double, Eigen::aligned_allocator<double>> data_;
+
+};
+
+#endif /* FIELD_3D_H_INCLUDED */
@@ -14,12 +14,58 @@
 #ifndef MC_RAND_H_INCLUDED
 #define MC_RAND_H_INCLUDED
 
+#include <array>
+#include <cstdint>
 #include <cstdlib>
 
+/* Counter-based pseudo-random generator Philox4x32-10 from
+ * Salmon, J. K., M. A. Moraes, R. O. Dror, and D. E. Shaw (2011),
+ * Parallel random numbers: as easy as 1, 2, 3, SC '11.
+ * The output is a pure function of a key and a counter: there is no
+ * generator state to share or lock, and a draw does not depend on which
+ * thread makes it or in which order. */
+namespace Philox
+{
+    typedef std::array<std::uint32_t, 4> Counter;
+    typedef std::array<std::uint32_t, 2> Key;
+
+    /* Third counter word, keeps the streams drawn with the same key apart */
+    const std::uint32_t MONTE_CARLO = 0;
+    const std::uint32_t TEMP_PERTURB = 1;
+
+    /* Four random 32-bit words for counter ctr */
+    inline Counter generate( Counter ctr, Key key ) {
+        const std::uint64_t M0 = 0xD2511F53;
+        const std::uint64_t M1 = 0xCD9E8D57;
+        const std::uint32_t W0 = 0x9E3779B9;
+        const std::uint32_t W1 = 0xBB67AE85;
+        for ( int round = 0; round < 10; round++ ) {
+            const std::uint64_t p0 = M0 * ctr[0];
+            const std::uint64_t p1 = M1 * ctr[2];
+            ctr = { std::uint32_t( p1 >> 32 ) ^ ctr[1] ^ key[0], std::uint32_t( p1 ),
+                    std::uint32_t( p0 >> 32 ) ^ ctr[3] ^ key[1], std::uint32_t( p0 ) };
+            key[0] += W0;
+            key[1] += W1;
+        }
+        return ctr;
+    }
+
+    /* Uniform number in [fMin, fMax) from two random words (53 random bits) */
+    inline double uniform( std::uint32_t hi, std::uint32_t lo, double fMin, double fMax ) {
+        const double f = ( ( std::uint64_t( hi ) << 21 ) | ( lo >> 11 ) ) * 0x1.0p-53;
+        return fMin + f * ( fMax - fMin );
+    }
+}
+
 /* Set seed for pseudo-random generator */
 void setSeed();
+void setSeed( std::uint32_t newSeed );
+
+/* Seed set by setSeed, 0 before */
+std::uint32_t getSeed();
 
-/* Generates a random number of type T between fMin and fMax */
+/* Generates a random number of type T between fMin and fMax.
+ * Successive calls walk through one Philox stream keyed by the seed, thread-safe */
 template <typename T>
 T fRand(const T fMin, const T fMax);
 
@@ -0,0 +1,127 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* Timing Header File                                               */
+/*                                                                  */
+/* File                 : Timing.hpp                                */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef TIMING_H_INCLUDED
+#define TIMING_H_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/* Wall-clock time of the phases of a case. Phases are timed by Scope objects
+ * and nest like the scopes do. Each thread taking part in a case records into
+ * its own tree of phases, so timing takes no lock. A Scope on a thread with no
+ * active Profile does nothing. */
+namespace Timing
+{
+    typedef std::chrono::steady_clock Clock;
+
+    class Profile
+    {
+        public:
+
+            struct Phase {
+                const char* name;
+                std::size_t parent;
+                std::vector<std::size_t> children;
+                std::uint64_t calls = 0;
+                double seconds = 0.0E+00;
+            };
+
+            /* Phases timed on one thread, phases[0] is the root */
+            class Thread
+            {
+                public:
+                    explicit Thread( const std::string& label );
+
+                    /* Index of the phase entered */
+                    std::size_t enter( const char* name );
+                    void leave( std::size_t phase, double seconds );
+
+                    inline const std::string& label() const { return label_; }
+                    inline const std::vector<Phase>& phases() const { return phases_; }
+
+                private:
+                    std::string label_;
+                    std::vector<Phase> phases_;
+                    std::size_t current_ = 0;
+            };
+
+            Profile( );
+            Profile( const Profile& ) = delete;
+            Profile& operator=( const Profile& ) = delete;
+
+            /* Makes the profile active on the calling thread while in scope, recording
+             * into the thread labelled label. A label is used by one thread at a time */
+            class Active
+            {
+                public:
+                    Active( Profile& profile, const std::string& label );
+                    ~Active( );
+                    Active( const Active& ) = delete;
+                    Active& operator=( const Active& ) = delete;
+                private:
+                    Profile* previousProfile_;
+                    Thread* previousThread_;
+            };
+
+            /* Profile active on the calling thread, nullptr if none */
+            static Profile* current( );
+
+            /* Results below are read once the threads of the case are done timing */
+
+            /* Total time [s] in a phase given by its path from the root, e.g.
+             * "Transport/H2O", 0 if the phase was never entered */
+            double seconds( const std::string& label, const std::string& path ) const;
+            std::uint64_t calls( const std::string& label, const std::string& path ) const;
+
+            /* Elapsed time [s] since construction */
+            double elapsed( ) const;
+
+            /* JSON object with the given extra fields (already formatted JSON
+             * values), the elapsed time and the phases of each thread */
+            void writeJSON( std::ostream& os, const std::vector<std::pair<std::string, std::string>>& fields ) const;
+
+        private:
+
+            const Phase* find( const std::string& label, const std::string& path ) const;
+
+            Clock::time_point start_;
+            mutable std::mutex mutex_;
+            /* std::list keeps the threads in place while others are added */
+            std::list<Thread> threads_;
+
+    };
+
+    /* Times the enclosing block as a phase of the active profile. The name is
+     * kept as is and must outlive the profile, e.g. a string literal */
+    class Scope
+    {
+        public:
+            explicit Scope( const char* name );
+            ~Scope( );
+            Scope( const Scope& ) = delete;
+            Scope& operator=( const Scope& ) = delete;
+        private:
+            Profile::Thread* thread_;
+            std::size_t phase_ = 0;
+            Clock::time_point start_;
+    };
+
+    /* Quoted and escaped JSON string */
+    std::string quote( const std::string& str );
+}
+
+#endif /* TIMING_H_INCLUDED */
@@ -0,0 +1,84 @@
+#ifndef CASESPACE_H
+#define CASESPACE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Util/ForwardDecl.hpp"
+
+namespace YamlInputReader{
+    /* Parameters of one case, one field per entry of the PARAMETER MENU */
+    struct CaseParameters{
+        double simulationTime;
+        double temperature_K;
+        double relHumidity_w;
+        double horizDiff;
+        double vertiDiff;
+        double shear;
+        double nBV;
+
+        double longitude_deg;
+        double latitude_deg;
+        double pressure_Pa;
+
+        double emissionDOY;
+        double emissionTime;
+
+        double EI_NOx;
+        double EI_CO;
+        double EI_HC;
+        double EI_SO2;
+        double EI_SO2TOSO4;
+        double EI_Soot;
+        double sootRad;
+
+        double fuelFlow;
+        double aircraftMass;
+        double flightSpeed;
+        double numEngines;
+        double wingspan;
+        double coreExitTemp;
+        double bypassArea;
+
+        double backgNOx;
+        double backgHNO3;
+        double backgO3;
+        double backgCO;
+        double backgCH4;
+        double backgSO2;
+    };
+
+    /* Cartesian product of the parameter sweep values, decoded one case at a time.
+     * Case iCase is the mixed-radix number whose digits index the values of each parameter,
+     * the last parameter of the map iteration varying fastest. This is the order of the
+     * materialized cases of generateCases. */
+    class CaseSpace{
+        public:
+            explicit CaseSpace(const std::unordered_map<std::string, Vector_1D>& paramMap);
+
+            inline std::size_t size() const { return size_; }
+
+            /* Throws std::invalid_argument if a parameter needed by Input is not in the sweep */
+            CaseParameters parameters(std::size_t iCase) const;
+            /* Values of all parameters, including those unknown to CaseParameters */
+            std::unordered_map<std::string, double> caseMap(std::size_t iCase) const;
+
+        private:
+            struct Dimension{
+                std::string name;
+                Vector_1D values;
+                /* nullptr if the parameter has no field in CaseParameters */
+                double CaseParameters::* field;
+            };
+
+            /* Calls f(dimension, value index) for each parameter of case iCase */
+            template<typename F>
+            void decode(std::size_t iCase, F&& f) const;
+
+            std::vector<Dimension> dims_;
+            std::vector<std::string> missing_;
+            std::size_t size_;
+    };
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <filesystem>
 #include "Core/Input_Mod.hpp"
 #include "Util/ForwardDecl.hpp"
+#include "YamlInputReader/CaseSpace.hpp"
 
 using std::string;
 using std::vector;
@@ -24,6 +25,7 @@ namespace YamlInputReader{
     void readAdvancedMenu(OptInput& input, const YAML::Node& advancedNode);
     
     void performOtherInputValidnessChecks(OptInput& input);
+    /* All cases at once. Prefer iterating over a CaseSpace for large sweeps */
     vector<std::unordered_map<string, double>> generateCases(const OptInput& input);
     Vector_1D parseParamSweepInput(const string paramString, const string paramLocation = "", bool monteCarlo = false, int nRuns = 0);
     vector<string> split(const string str, const string delimiter);
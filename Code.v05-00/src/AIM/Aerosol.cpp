@@ -11,8 +11,11 @@
 /*                                                                  */
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
 #include "Util/PhysFunction.hpp"
 #include "Core/Parameters.hpp"
 #include "AIM/Aerosol.hpp"
@@ -164,7 +167,7 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         Vector_1D P(nBin, 0.0E+00);
         Vector_1D L(nBin, 0.0E+00);
         Vector_1D v(nBin);
-        UInt iBin, jBin, kBin;
+        UInt iBin, jBin;
 
         for (iBin = 0; iBin < nBin; iBin++)
         {
@@ -187,28 +190,19 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
          * v_new = ( v + P * dt ) / ( 1.0 + L )
          * The latter is mass-conserving */
 
-        /* Can this be improved?
-         * Can for loops be removed? */
+        /* Production and loss terms only visit the pairs stored in the volume partition */
+        const Coagulation::Partition &part = kernel.partition;
         for (iBin = 0; iBin < nBin; iBin++)
         {
 
-            /* Build production and loss terms */
-            for (jBin = 0; jBin < nBin; jBin++)
-            {
-                if (jBin <= iBin)
-                {
+            /* k coagulating with j to form i */
+            for (UInt e = part.rowStart[iBin]; e < part.rowStart[iBin + 1]; e++)
+                P[iBin] += part.coef[e] * v_new[part.kBin[e]] * pdf[part.jBin[e]];
 
-                    for (kBin = 0; kBin < iBin; kBin++)
-                    {
-                        /* k coagulating with j to form i */
-                        if (kernel.f[kBin][jBin][iBin] != 0.0)
-                            P[iBin] += kernel.f[kBin][jBin][iBin] * kernel.beta[kBin][jBin] * v_new[kBin] * pdf[jBin];
-                    }
-                }
-                /* i coagulating with j to deplete i */
-                if (kernel.f[iBin][jBin][iBin] != 1.0)
-                    L[iBin] += (1.0 - kernel.f[iBin][jBin][iBin]) * kernel.beta[iBin][jBin] * pdf[jBin];
-            }
+            /* i coagulating with j to deplete i */
+            const double *loss = &part.loss[iBin * nBin];
+            for (jBin = 0; jBin < nBin; jBin++)
+                L[iBin] += loss[jBin] * pdf[jBin];
 
             /* Non-mass conserving scheme: */
             //            v_new[iBin] = v[iBin] + ( P[iBin] - L[iBin] * v[iBin] ) * dt;
@@ -426,7 +420,7 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         }
         bin_VEdges[nBin] = 4.0 / 3.0 * physConst::PI * pow(bin_Edges[nBin], 3);
 
-        bin_VCenters.resize(nBin, Vector_2D(Ny, Vector_1D(Nx, 0.0E+00)));
+        bin_VCenters.assign(nBin, Ny, Nx);
 
         for (UInt iBin = 0; iBin < nBin; iBin++)
         {
@@ -437,7 +431,7 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
             }
         }
 
-        pdf.resize(nBin, Vector_2D(Ny, Vector_1D(Nx, 0.0E+00)));
+        pdf.assign(nBin, Ny, Nx);
 
         /* Allocate mean and standard deviation */
         if (mu_ <= 0) { std::cout << "\nIn Grid_Aerosol::Grid_Aerosol: mean/mode is negative: mu = " << mu_ << "\n"; }
@@ -537,7 +531,7 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         }
     } /* End of Grid_Aerosol::Grid_Aerosol */
 
-    void Grid_Aerosol::Coagulate(const double dt, Coagulation &kernel, const UInt N, const UInt SYM)
+    void Grid_Aerosol::Coagulate(const double dt, const Coagulation &kernel, const UInt N, const UInt SYM)
     {
 
         /* DESCRIPTION:
@@ -568,27 +562,89 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         bool performCoag = CheckCoagAndGrowInputs(N, SYM, Nx_max, Ny_max, "Coagulation");
         if(performCoag == false) { return; }
 
-        /* Grid indices */
-        UInt iNx = 0;
-        UInt jNy = 0;
+        /* Bin centers are updated on the whole grid, as UpdateCenters would do.
+         * Cells are independent: each thread coagulates whole cells with its own
+         * copy of the kernel, whose volume partition depends on the cell */
+        const std::vector<ActiveCell> activeCells = ActiveCells( Nx, Ny );
+        std::vector<char> isActive( Ny * Nx, 0 );
+        for ( const ActiveCell& cell: activeCells ) {
+            isActive[cell.jNy * Nx + cell.iNx] = 1;
+        }
 
-        /* Bin indices */
-        UInt iBin = 0;
-        UInt jBin = 0;
-        UInt kBin = 0;
-        UInt kBin_ = 0;
+        Vector_1D logRatio( nBin );
+        for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+            logRatio[iBin] = log( bin_Edges[iBin + 1] / bin_Edges[iBin] );
+        }
 
-        /* Particle volume in each bin */
-        Vector_3D v = Volume(); /* Expressed in [m^3/cm^3] */
-        /* Copy v into v_new */
-        Vector_3D v_new = v;
+        #pragma omp parallel if( !PARALLEL_CASES ) default( shared )
+        {
 
-        /* Allocate variables */
-        double P[nBin];
-        double L[nBin];
+            CoagulationScratch scratch( kernel, nBin );
+
+            #pragma omp for schedule( dynamic, 16 )
+            for ( std::size_t iCell = 0; iCell < activeCells.size(); iCell++ ) {
+                const ActiveCell& cell = activeCells[iCell];
+                const UInt jNy = cell.jNy;
+                const UInt iNx = cell.iNx;
+
+                /* Total aerosol volume [m^3/cm^3] */
+                double totVol = 0.0E+00;
+                /* Empty smaller bins are still read as coagulation partners */
+                std::fill( scratch.vNew.begin(), scratch.vNew.begin() + cell.firstBin, 0.0E+00 );
+                std::fill( scratch.nPart.begin(), scratch.nPart.begin() + cell.firstBin, 0.0E+00 );
+                for ( UInt iBin = cell.firstBin; iBin <= cell.lastBin; iBin++ ) {
+                    scratch.v[iBin] = logRatio[iBin] * bin_VCenters[iBin][jNy][iNx] * pdf[iBin][jNy][iNx];
+                    scratch.vNew[iBin] = scratch.v[iBin];
+                    scratch.nPart[iBin] = logRatio[iBin] * pdf[iBin][jNy][iNx];
+                    totVol += scratch.v[iBin];
+                }
 
-        /* Total volume and number per grid cell */
-        double totVol, nPart;
+                /* Only run coagulation where aerosol volume is greater
+                 * than 0.1 um^3/cm^3 */
+                if ( jNy < Ny_max && iNx < Nx_max && totVol * 1E18 > 0.1 ) {
+                    CoagulateCell( cell, dt, scratch );
+                }
+
+                /* Update bin centers */
+                for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+                    if ( iBin >= cell.firstBin && iBin <= cell.lastBin && pdf[iBin][jNy][iNx] > 0 ) {
+                        bin_VCenters[iBin][jNy][iNx] =
+                            std::max(std::min(scratch.vNew[iBin] / pdf[iBin][jNy][iNx] / logRatio[iBin],
+                                              0.9999 * bin_VEdges[iBin + 1]),
+                                     1.0001 * bin_VEdges[iBin]);
+                    }
+                    else {
+                        bin_VCenters[iBin][jNy][iNx] = 0.5 * (bin_VEdges[iBin] + bin_VEdges[iBin + 1]);
+                    }
+                }
+            }
+
+            /* Cells without particles: empty bins get the average volume of the bin */
+            #pragma omp for schedule( static )
+            for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+                const double VCenter = 0.5 * ( bin_VEdges[iBin] + bin_VEdges[iBin + 1] );
+                for ( UInt jNy = 0; jNy < Ny; jNy++ ) {
+                    for ( UInt iNx = 0; iNx < Nx; iNx++ ) {
+                        if ( !isActive[jNy * Nx + iNx] ) {
+                            bin_VCenters[iBin][jNy][iNx] = VCenter;
+                        }
+                    }
+                }
+            }
+        } /* pragma omp parallel */
+
+        if (checkMass) { std::cout << "At t + dt: " << Moment(3, Nx / 2, Ny / 2) * 1.0E+18 << "[um^3/cm^3]" << std::endl; }
+        
+        //Apply Symmetry
+        Vector_2D temp = Vector_2D();
+        Vector_2D& temp1 = temp;
+        CoagAndGrowApplySymmetry(N, SYM, Nx_max, Ny_max, "Coagulate", temp1);
+
+
+    } /* End of Grid_Aerosol::Coagulate */
+
+    void Grid_Aerosol::CoagulateCell(const ActiveCell& cell, const double dt, CoagulationScratch& scratch)
+    {
 
         /* Description of the algorithm:
          * \frac{dv}{dt}[iBin] = P - L * v[iBin]
@@ -601,90 +657,46 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
          * Scheme 2:
          * v_new - v = ( P - L * v_new ) * dt
          * v_new = ( v + P * dt ) / ( 1.0 + L )
-         * The latter is mass-conserving */
+         * The latter is mass-conserving.
+         * The number concentrations are taken at the start of the step. */
 
-        for (jNy = 0; jNy < Ny_max; jNy++)
-        {
-
-            for (iNx = 0; iNx < Nx_max; iNx++)
-            {
-
-                /* Total aerosol volume */
-                totVol = 0.0E+00;
-
-                for (iBin = 0; iBin < nBin; iBin++)
-                    totVol += v[iBin][jNy][iNx]; /* [m^3/cm^3] */
-
-                if (totVol * 1E18 > 0.1)
-                {
-                    /* Only run coagulation where aerosol volume is greater
-                     * than 0.1 um^3/cm^3 */
+        const UInt jNy = cell.jNy;
+        const UInt iNx = cell.iNx;
+        const Coagulation::Partition& part = scratch.kernel.partition;
 
-                    #pragma omp master
-                    {
-                        /* Update kernel (updates kernel.f and kernel.indices).
-                         * This needs to be performed in serial as the class
-                         * kernel is specific to the grid cell (jNy, iNx) */
-                        kernel.buildF(bin_VCenters, jNy, iNx);
-                    }
+        for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+            scratch.vCenters[iBin] = bin_VCenters[iBin][jNy][iNx];
+        }
 
-                    #pragma omp barrier
+        /* Update the volume partition for the bin centers of this cell */
+        scratch.kernel.buildF( scratch.vCenters );
 
-                    #pragma omp parallel for default(shared) private(iBin, jBin, kBin, kBin_, nPart) \
-                        schedule(dynamic, 1) if (!PARALLEL_CASES)
-                    for (iBin = 0; iBin < nBin; iBin++)
-                    {
+        /* Bins outside [firstBin, lastBin] hold no particles. A bin without volume
+         * keeps no particles, as the pdf is scaled by the volume ratio below, so
+         * only bins in [firstBin, lastBin] are updated */
+        for ( UInt iBin = cell.firstBin; iBin <= cell.lastBin; iBin++ ) {
 
-                        /* Reset P and L values */
-                        P[iBin] = 0.0E+00;
-                        L[iBin] = 0.0E+00;
-
-                        /* Build production and loss terms */
-                        for (jBin = 0; jBin < nBin; jBin++)
-                        {
-
-                            nPart = pdf[jBin][jNy][iNx] * log(bin_Edges[jBin + 1] / bin_Edges[jBin]);
-
-                            if (jBin <= iBin)
-                            {
-                                for (kBin_ = 0; kBin_ < kernel.indices[jBin][iBin].size(); kBin_++)
-                                {
-                                    kBin = kernel.indices[jBin][iBin][kBin_];
-                                    /* k coagulating with j to form i */
-                                    if (kBin < iBin)
-                                    {
-                                        P[iBin] += kernel.f[kBin][jBin][iBin] * kernel.beta[kBin][jBin] * v_new[kBin][jNy][iNx] * nPart;
-                                        /* [cm^3/#/s] * [m^3/cm^3] * [#/cm^3] = [m^3/cm^3/s] */
-                                    }
-                                }
-                            }
-
-                            /* i coagulating with j to deplete i */
-                            if (kernel.f[iBin][jBin][iBin] != 1.0)
-                                L[iBin] += (1.0 - kernel.f[iBin][jBin][iBin]) * kernel.beta[iBin][jBin] * nPart;
-                        }
+            double P = 0.0E+00;
+            double L = 0.0E+00;
 
-                        /* Mass conserving scheme: */
-                        v_new[iBin][jNy][iNx] = (v[iBin][jNy][iNx] + dt * P[iBin]) / (1.0 + dt * L[iBin]);
-                        if (v[iBin][jNy][iNx] > 0.0E+00)
-                            pdf[iBin][jNy][iNx] *= v_new[iBin][jNy][iNx] / v[iBin][jNy][iNx];
-                    }
-                }
+            /* k coagulating with j to form i, nPart is zero below firstBin */
+            for ( UInt e = part.rowStart[iBin]; e < part.rowStart[iBin + 1]; e++ ) {
+                P += part.coef[e] * scratch.vNew[part.kBin[e]] * scratch.nPart[part.jBin[e]];
+                /* [cm^3/#/s] * [m^3/cm^3] * [#/cm^3] = [m^3/cm^3/s] */
             }
-        }
 
-        /* Update bin centers */
-        UpdateCenters(v_new, pdf);
-
-        if (checkMass) { std::cout << "At t + dt: " << Moment(3, Nx / 2, Ny / 2) * 1.0E+18 << "[um^3/cm^3]" << std::endl; }
-        
-        //Apply Symmetry
-        Vector_2D temp = Vector_2D();
-        Vector_2D& temp1 = temp;
-        CoagAndGrowApplySymmetry(N, SYM, Nx_max, Ny_max, "Coagulate", temp1);
+            /* i coagulating with j to deplete i */
+            const double* loss = &part.loss[iBin * nBin];
+            for ( UInt jBin = cell.firstBin; jBin <= cell.lastBin; jBin++ )
+                L += loss[jBin] * scratch.nPart[jBin];
 
+            /* Mass conserving scheme: */
+            scratch.vNew[iBin] = (scratch.v[iBin] + dt * P) / (1.0 + dt * L);
+            if ( scratch.v[iBin] > 0.0E+00 )
+                pdf[iBin][jNy][iNx] *= scratch.vNew[iBin] / scratch.v[iBin];
+        }
 
-    } /* End of Grid_Aerosol::Coagulate */
+    } /* End of Grid_Aerosol::CoagulateCell */
 
     void Grid_Aerosol::Grow( const double dt, Vector_2D &H2O, const Vector_2D &T, const Vector_1D &P, const UInt N, const UInt SYM )
     {
@@ -713,76 +725,83 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         bool performGrowth = CheckCoagAndGrowInputs(N, SYM, Nx_max, Ny_max, "Grow");
         if(performGrowth == false) { return; }
 
-        UInt iNx  = 0, jNy  = 0, iBin = 0;
-
         /* Conversion factor from ice volume [m^3] to [molecules] */ 
         const double UNITCONVERSION = physConst::RHO_ICE / MW_H2O * physConst::Na;
 
         /* Scaled Boltzmann constant */
         const double kB_ = physConst::kB * 1.00E+06;
 
-        /* Declare and initialize particle totals and water vapor array */
-        Vector_3D icePart = Number( );
-        Vector_3D iceVol  = Volume( );
-        Vector_2D totH2O  = H2O;
-        
-        double pSat;
+        /* Only cells holding ice are grown. In a cell without particles APC leaves H2O
+         * unchanged and the flux step only resets the bin centers, which is done below
+         * for all other cells. Within a cell, only the bins holding particles are visited. */
+        const std::vector<ActiveCell> activeCells = ActiveCells( Nx, Ny_max );
+        std::vector<char> isActive( Ny_max * Nx, 0 );
+        for ( const ActiveCell& cell: activeCells ) {
+            isActive[cell.jNy * Nx + cell.iNx] = 1;
+        }
+
+        Vector_1D logRatio( nBin );
+        for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+            logRatio[iBin] = log( bin_Edges[iBin + 1] / bin_Edges[iBin] );
+        }
 
         #pragma omp parallel if( !PARALLEL_CASES ) default( shared )
         {
 
-            std::vector<int> toBin( nBin, 0 );
-            std::vector<int>::iterator iterBegin, iterCurr, iterEnd;
+            GrowthScratch scratch( nBin );
 
-            /* Declare and initialize variable to store saturation quantities,
-            * pressure and temperature */
-            double locT = 0.0E+00;
-            double locP = 0.0E+00;
+            #pragma omp for schedule( dynamic, 16 )
+            for ( std::size_t iCell = 0; iCell < activeCells.size(); iCell++ ) {
+                const ActiveCell& cell = activeCells[iCell];
+                const UInt jNy = cell.jNy;
+                const UInt iNx = cell.iNx;
 
-
-            #pragma omp for                                                               \
-            private ( iNx, jNy, iBin                                            ) \
-            schedule( static, 1                                                )
-            for ( jNy = 0; jNy < Ny_max; jNy++ ) {
-                for ( iNx = 0; iNx < Nx_max; iNx++ ) {
-                    for ( iBin = 0; iBin < nBin; iBin++ ) {
-                        totH2O[jNy][iNx] += iceVol[iBin][jNy][iNx] * UNITCONVERSION;
+                /* Particle number and volume of this cell, as in Number( ) and Volume( ) */
+                double totH2O = H2O[jNy][iNx];
+                for ( UInt iBin = cell.firstBin; iBin <= cell.lastBin; iBin++ ) {
+                    scratch.icePart[iBin] = logRatio[iBin] * pdf[iBin][jNy][iNx];
+                    scratch.iceVol[iBin]  = logRatio[iBin] * bin_VCenters[iBin][jNy][iNx] * pdf[iBin][jNy][iNx];
+                    /* With symmetry, only the first Nx_max columns account for ice in the total water */
+                    if ( iNx < Nx_max ) {
+                        totH2O += scratch.iceVol[iBin] * UNITCONVERSION;
                         /* Unit check:
                         * [ molec/cm^3 ] = [ m^3 ice/cm^3 air ]   * [ molec/m^3 ice ] */
                     }
                 }
-            }
 
-            #pragma omp for                                                               \
-            private ( iNx, jNy, iBin, locP, locT              ) \
-            schedule( static, 1                                                )
-            for ( jNy = 0; jNy < Ny_max; jNy++ ) {
-                /* Store local pressure.
+                /* Store local pressure and temperature.
                 * TODO: 
-                * That might be moved into the loop over iNx eventually to 
-                * account for 2D pressure met-fields?? */
-                locP = P[jNy];
+                * Pressure might be taken from a 2D met-field eventually?? */
+                const double locP = P[jNy];
+                const double locT = T[jNy][iNx];
 
-                for ( iNx = 0; iNx < Nx; iNx++ ) {
-                    /* Store local temperature */
-                    locT = T[jNy][iNx];
-
-                    /* Store local saturation pressure w.r.t ice */
-                    pSat = physFunc::pSat_H2Os( locT );
+                /* Store local saturation pressure w.r.t ice */
+                const double pSat = physFunc::pSat_H2Os( locT );
 
-                    if ( H2O[jNy][iNx] * kB_ * locT / pSat > 0.0 ) {
-                        APC_Scheme(jNy,iNx, locT, locP, dt, H2O, totH2O, icePart, iceVol );
-                    }
-                    /* ============== Moving-center structure ================ */
-                    /* ======================================================= */
-                    /* ============= Update bin center average =============== */
+                if ( H2O[jNy][iNx] * kB_ * locT / pSat > 0.0 ) {
+                    APC_Scheme( cell, locT, locP, dt, H2O, totH2O, scratch );
+                }
+                /* ============== Moving-center structure ================ */
+                /* ======================================================= */
+                /* ============= Update bin center average =============== */
 
+                /* 1. Compute bin particle flux */
+                ComputeBinParticleFlux( cell, scratch );
 
-                    /* 1. Compute bin particle flux */
-                    toBin = ComputeBinParticleFlux(iNx, jNy, iceVol, icePart);
+                /* 2. Attribute new particles according to fluxes */
+                ApplyBinParticleFlux( cell, scratch );
+            }
 
-                    /* 2. Attribute new particles according to fluxes */
-                    ApplyBinParticleFlux(iNx, jNy, toBin, iceVol, icePart);
+            /* Cells without particles: empty bins get the average volume of the bin */
+            #pragma omp for schedule( static )
+            for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+                const double VCenter = 0.5 * ( bin_VEdges[iBin] + bin_VEdges[iBin + 1] );
+                for ( UInt jNy = 0; jNy < Ny_max; jNy++ ) {
+                    for ( UInt iNx = 0; iNx < Nx; iNx++ ) {
+                        if ( !isActive[jNy * Nx + iNx] ) {
+                            bin_VCenters[iBin][jNy][iNx] = VCenter;
+                        }
+                    }
                 }
             }
         } /* pragma omp parallel */
@@ -791,12 +810,49 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         CoagAndGrowApplySymmetry(N, SYM, Nx_max, Ny_max, "Grow", H2O);
     } /* End of Grid::Aerosol::Grow */
 
-    void Grid_Aerosol::APC_Scheme(const UInt jNy, const UInt iNx, const double T, const double P,
-                            const double dt, Vector_2D& H2O, Vector_2D& totH2O, Vector_3D& icePart, Vector_3D& iceVol){
+    std::vector<Grid_Aerosol::ActiveCell> Grid_Aerosol::ActiveCells( const UInt Nx_max, const UInt Ny_max ) const
+    {
+        std::vector<std::vector<ActiveCell>> rowCells( Ny_max );
+
+        #pragma omp parallel for schedule( dynamic, 1 ) if( !PARALLEL_CASES )
+        for ( UInt jNy = 0; jNy < Ny_max; jNy++ ) {
+            /* Walk the bins row by row to follow the [bin][y][x] layout */
+            std::vector<int> firstBin( Nx_max, -1 );
+            std::vector<int> lastBin( Nx_max, -1 );
+            for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+                const auto row = pdf[iBin][jNy];
+                for ( UInt iNx = 0; iNx < Nx_max; iNx++ ) {
+                    if ( row[iNx] != 0.0E+00 ) {
+                        if ( firstBin[iNx] < 0 ) { firstBin[iNx] = iBin; }
+                        lastBin[iNx] = iBin;
+                    }
+                }
+            }
+            for ( UInt iNx = 0; iNx < Nx_max; iNx++ ) {
+                if ( firstBin[iNx] >= 0 ) {
+                    rowCells[jNy].push_back( ActiveCell{ jNy, iNx, static_cast<UInt>(firstBin[iNx]), static_cast<UInt>(lastBin[iNx]) } );
+                }
+            }
+        }
+
+        std::vector<ActiveCell> cells;
+        for ( const auto& row: rowCells ) {
+            cells.insert( cells.end(), row.begin(), row.end() );
+        }
+        return cells;
+    } /* End of Grid_Aerosol::ActiveCells */
+
+    void Grid_Aerosol::APC_Scheme(const ActiveCell& cell, const double T, const double P, const double dt,
+                            Vector_2D& H2O, const double totH2O, GrowthScratch& scratch) const {
         
+        /* Bins outside [firstBin, lastBin] hold no particles, so their growth rate and volume stay zero */
+        const UInt jNy = cell.jNy;
+        const UInt iNx = cell.iNx;
+        Vector_1D& icePart = scratch.icePart;
+        Vector_1D& iceVol = scratch.iceVol;
+        Vector_1D& kGrowth = scratch.kGrowth;
         double totPart = 0.0, totalkGrowth = 0.0, totalkGrowth_kelvin = 0.0, totH2Oi = 0.0;
         double pSat = physFunc::pSat_H2Os( T );
-        Vector_1D  kGrowth(nBin, 0);
         double MAXVOL = bin_VEdges[nBin]; 
         double kB_ = physConst::kB * 1.00E+06; //SCALED boltzmann constant [J cm^3/K]
         double c_qit, C_qt, C_qsi; //Quantities used in APC scheme.
@@ -811,9 +867,9 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         * 27:4, 491-498, DOI: 10.1080/02786829708965489     */
 
         /* Check if partNum greater than a limit */
-        for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+        for ( UInt iBin = cell.firstBin; iBin <= cell.lastBin; iBin++ ) {
 
-            totPart += icePart[iBin][jNy][iNx];
+            totPart += icePart[iBin];
 
         }
 
@@ -822,10 +878,10 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         * bin and thus the particle size and only depends
         * on meteorological parameters. */
         if ( totPart < 0.00 ) { return; }
-        for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+        for ( UInt iBin = cell.firstBin; iBin <= cell.lastBin; iBin++ ) {
         
             //Factor of 1e6 for cm3 - m3 conversion. 
-            kGrowth[iBin] = 1.0e6 * icePart[iBin][jNy][iNx] * 4.0 * physConst::PI * bin_Centers[iBin]\
+            kGrowth[iBin] = 1.0e6 * icePart[iBin] * 4.0 * physConst::PI * bin_Centers[iBin]\
                 * EffDiffCoef( bin_Centers[iBin], T, P, H2O[jNy][iNx]);  
 
             totalkGrowth += kGrowth[iBin];
@@ -844,23 +900,23 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         
         /* Make sure that molecular water does not go over 
         * total water (gaseous + solid) concentrations */
-        H2O[jNy][iNx] = std::min( H2O[jNy][iNx], totH2O[jNy][iNx] );
+        H2O[jNy][iNx] = std::min( H2O[jNy][iNx], totH2O );
         
-        for ( UInt iBin = 0; iBin < nBin; iBin++ ) {
+        for ( UInt iBin = cell.firstBin; iBin <= cell.lastBin; iBin++ ) {
             //Update molar concentration of ice [mol/cm3] and convert to volumetric concentration [m3/cm3]
-            c_qit = (iceVol[iBin][jNy][iNx] * physConst::RHO_ICE / MW_H2O) + dt*kGrowth[iBin]*(C_qt - physFunc::Kelvin(bin_Centers[iBin])*C_qsi);
-            iceVol[iBin][jNy][iNx] = c_qit * MW_H2O / physConst::RHO_ICE;
+            c_qit = (iceVol[iBin] * physConst::RHO_ICE / MW_H2O) + dt*kGrowth[iBin]*(C_qt - physFunc::Kelvin(bin_Centers[iBin])*C_qsi);
+            iceVol[iBin] = c_qit * MW_H2O / physConst::RHO_ICE;
         
-            iceVol[iBin][jNy][iNx] = \
-                    std::min( std::max( iceVol[iBin][jNy][iNx], 0.0E+00 ), icePart[iBin][jNy][iNx] * MAXVOL );
+            iceVol[iBin] = \
+                    std::min( std::max( iceVol[iBin], 0.0E+00 ), icePart[iBin] * MAXVOL );
         
             /* Compute total water taken up on particles */
-            totH2Oi += iceVol[iBin][jNy][iNx] * UNITCONVERSION;
+            totH2Oi += iceVol[iBin] * UNITCONVERSION;
             /* Unit check:
             * [molec/cm^3 air] = [m^3 ice/cm^3 air] * [molec/m^3 ice] */
         }
         
-        H2O[jNy][iNx] = totH2O[jNy][iNx] - totH2Oi; 
+        H2O[jNy][iNx] = totH2O - totH2Oi; 
     } //End of Grid_Aerosol::APC_Scheme
 
     double Grid_Aerosol::EffDiffCoef( const double r, const double T, const double P, const double H2O ) const
@@ -897,16 +953,16 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
 
     // TODO: Decide on a better way to handle ice particles that go above max volume. Currently,
     // they just stay in the highest volume box.
-    std::vector<int> Grid_Aerosol::ComputeBinParticleFlux(const int x_index, const int y_index,
-                                                          const Vector_3D &iceVol, const Vector_3D &icePart) const
+    void Grid_Aerosol::ComputeBinParticleFlux(const ActiveCell& cell, GrowthScratch& scratch) const
     {
-        std::vector<int> toBin(nBin, 0);
+        // Bins outside [firstBin, lastBin] are empty and move nothing
+        std::vector<int>& toBin = scratch.toBin;
         double partVol;
-        for (UInt iBin = 0; iBin < nBin; iBin++)
+        for (UInt iBin = cell.firstBin; iBin <= cell.lastBin; iBin++)
         {
 
             toBin[iBin] = -1;
-            partVol = iceVol[iBin][y_index][x_index] / icePart[iBin][y_index][x_index];
+            partVol = scratch.iceVol[iBin] / scratch.icePart[iBin];
 
             toBin[iBin] = std::lower_bound(bin_VEdges.begin(), bin_VEdges.end(), partVol) - bin_VEdges.begin() - 1;
 
@@ -923,40 +979,34 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
                 toBin[iBin] = -1;
             }
         }
-        return toBin;
     } //End of Grid_Aerosol::ComputeBinParticleFlux
 
-    void Grid_Aerosol::ApplyBinParticleFlux(const int x_index, const int y_index,
-                                            const std::vector<int> &toBin, const Vector_3D &iceVol, const Vector_3D &icePart)
+    void Grid_Aerosol::ApplyBinParticleFlux(const ActiveCell& cell, GrowthScratch& scratch)
     {
+        const UInt y_index = cell.jNy;
+        const UInt x_index = cell.iNx;
+        Vector_1D& icePart_ = scratch.partToBin;
+        Vector_1D& iceVol_ = scratch.volToBin;
+        std::fill(icePart_.begin(), icePart_.end(), 0.0E+00);
+        std::fill(iceVol_.begin(), iceVol_.end(), 0.0E+00);
 
-        std::vector<int>::const_iterator iterBegin, iterCurr, iterEnd;
-        double icePart_, iceVol_;
-        int jBin;
-        for (UInt iBin = 0; iBin < nBin; iBin++)
+        // Sums up all ice particles being assigned to each bin. Source bins are visited in
+        // increasing order, so every sum is accumulated in the same order as a per-bin search.
+        for (UInt jBin = cell.firstBin; jBin <= cell.lastBin; jBin++)
         {
+            const int iBin = scratch.toBin[jBin];
+            if (iBin < 0) continue;
+            icePart_[iBin] += scratch.icePart[jBin];
+            iceVol_[iBin] += scratch.iceVol[jBin];
+        }
 
-            icePart_ = 0.0E+00;
-            iceVol_ = 0.0E+00;
-            jBin = -1;
-            iterBegin = toBin.begin();
-            iterEnd = toBin.end();
-            iterCurr = iterBegin;
-            // TODO Can be optimized, use unordered_map to not have to loop through the entire toBin vector every time...
-            // Sums up all ice particles being assigned to a given
-            while ((iterCurr = std::find(iterCurr, iterEnd, iBin)) != iterEnd)
-            {
-                jBin = iterCurr - iterBegin; // j is less than or more than i, and this amount of will transfer to
-                icePart_ += icePart[jBin][y_index][x_index];
-                iceVol_ += iceVol[jBin][y_index][x_index];
-                iterCurr++;
-            }
-
-            if (icePart_ > 0.0E+00)
+        for (UInt iBin = 0; iBin < nBin; iBin++)
+        {
+            if (icePart_[iBin] > 0.0E+00)
             {
                 // Bin is not empty. Compute particle volume, and clip it between min and max volume allowed.
-                bin_VCenters[iBin][y_index][x_index] = std::max(std::min(iceVol_ / icePart_, bin_VEdges[iBin + 1]), bin_VEdges[iBin]);
-                pdf[iBin][y_index][x_index] = icePart_ / (log(bin_Edges[iBin + 1] / bin_Edges[iBin]));
+                bin_VCenters[iBin][y_index][x_index] = std::max(std::min(iceVol_[iBin] / icePart_[iBin], bin_VEdges[iBin + 1]), bin_VEdges[iBin]);
+                pdf[iBin][y_index][x_index] = icePart_[iBin] / (log(bin_Edges[iBin + 1] / bin_Edges[iBin]));
             }
             else
             {
@@ -1100,13 +1150,15 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         }
     }
     
-    void Grid_Aerosol::UpdateCenters(const Vector_3D &iceV, const Vector_3D &PDF)
+    void Grid_Aerosol::UpdateCenters(const Field_3D &iceV, const Field_3D &PDF)
     {
+        //Must resize the bin_VCenters to avoid indexing errors
+        if (bin_VCenters.nBin() != nBin || bin_VCenters.ny() != Ny || bin_VCenters.nx() != Nx)
+            bin_VCenters.assign(nBin, Ny, Nx);
+
         #pragma omp parallel for default(shared)
         for (UInt iBin = 0; iBin < nBin; iBin++)
         {   
-            //Must resize the bin_VCenters to avoid indexing errors
-            bin_VCenters[iBin] = Vector_2D(Ny, Vector_1D(Nx));
             double ratio = log(bin_Edges[iBin + 1] / bin_Edges[iBin]);
             for (UInt jNy = 0; jNy < Ny; jNy++)
             {
@@ -1154,14 +1206,14 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
 
     } /* End of Grid_Aerosol::Moment */
 
-    Vector_3D Grid_Aerosol::Number() const
+    Field_3D Grid_Aerosol::Number() const
     {
 
         UInt jNy = 0;
         UInt iNx = 0;
         UInt iBin = 0;
 
-        Vector_3D number(nBin, Vector_2D(Ny, Vector_1D(Nx, 0.0E+00)));
+        Field_3D number(nBin, Ny, Nx);
         double ratio = 0.0E+00;
 
         #pragma omp parallel for default(shared) private(iNx, jNy, iBin, ratio) \
@@ -1238,14 +1290,14 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         return overall_size_dist;
     }
 
-    Vector_3D Grid_Aerosol::Volume() const
+    Field_3D Grid_Aerosol::Volume() const
     {
 
         UInt jNy = 0;
         UInt iNx = 0;
         UInt iBin = 0;
 
-        Vector_3D volume(nBin, Vector_2D(Ny, Vector_1D(Nx, 0.0E+00)));
+        Field_3D volume(nBin, Ny, Nx);
         double ratio = 0.0E+00;
 
         #pragma omp parallel for default(shared) private(iNx, jNy, iBin, ratio) \
@@ -1391,7 +1443,6 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
     } /* End of Grid_Aerosol::Extinction */
 
     std::tuple<double, int, int> Grid_Aerosol::extinctionWidthIndices(const Vector_1D& xCoord, double thres) const {
-        Vector_2D chi = Extinction();
         Vector_1D chiMax_x = VectorUtils::VecMax2D(Extinction(), 1);
         double chiMax = *std::max_element(chiMax_x.begin(), chiMax_x.end());
         int i_left = -1;
@@ -1412,7 +1463,6 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
     }
 
     std::tuple<double, int, int> Grid_Aerosol::extinctionDepthIndices(const Vector_1D& yCoord, double thres) const {
-        Vector_2D chi = Extinction();
         Vector_1D chiMax_y = VectorUtils::VecMax2D(Extinction(), 0);
         double chiMax = *std::max_element(chiMax_y.begin(), chiMax_y.end());
         int j_bot = -1;
@@ -1436,6 +1486,151 @@ Aerosol::Aerosol(const Vector_1D& bin_Centers_, const Vector_1D& bin_Edges_, dou
         return std::inner_product(vertOD.begin(), vertOD.end(), dx.begin(), 0.0);
     }
 
+    namespace {
+        /* Resizes without giving memory back, so that buffers reused on a grid of
+         * the same size are not reallocated */
+        void resize2D( Vector_2D& vec, std::size_t ny, std::size_t nx )
+        {
+            vec.resize( ny );
+            for ( Vector_1D& row: vec )
+                row.resize( nx );
+        }
+    }
+
+    void Grid_Aerosol::Diagnose( Diagnostics& diag, const Vector_2D& cellAreas,
+                                 const Vector_1D& xCoord, const Vector_1D& yCoord,
+                                 const Vector_1D& dx, const Vector_1D& dy, double thres ) const
+    {
+
+        UInt jNy = 0;
+        UInt iNx = 0;
+        UInt iBin = 0;
+
+        const double FACTOR = 3.0 / double(4.0 * physConst::PI);
+        const double AREA_FACTOR = 4.0 * physConst::PI;
+        const double VOL_FACTOR = 4.0 / double(3.0) * physConst::PI;
+        const double IWC_FACTOR = physConst::RHO_ICE * 1.0E+06;
+        const double a = 3.448E+00; /* [m^2/kg] */
+        const double b = 2.431E-03; /* [m^3/kg] */
+
+        const bool full = diag.full;
+        resize2D( diag.number, Ny, Nx );
+        resize2D( diag.volume, Ny, Nx );
+        resize2D( diag.IWC, Ny, Nx );
+        if ( full ) {
+            resize2D( diag.area, Ny, Nx );
+            resize2D( diag.effRadius, Ny, Nx );
+            resize2D( diag.extinction, Ny, Nx );
+            resize2D( diag.rowSizeDist, Ny, nBin );
+            diag.xOD.assign( Ny, 0.0E+00 );
+            diag.yOD.assign( Nx, 0.0E+00 );
+            diag.sizeDist.assign( nBin, 0.0E+00 );
+        }
+
+        double totalNumber = 0.0E+00;
+        double totalIceMass = 0.0E+00;
+        /* Same initial value as VectorUtils::VecMax2D */
+        double chiMax = std::numeric_limits<double>::min();
+
+        /* Each row is owned by one thread and accumulated bin by bin, so the pdf is read
+         * contiguously and the moments are summed in the same order as in Moment */
+        #pragma omp parallel for default(shared) private(iNx, jNy, iBin) \
+            reduction(+ : totalNumber, totalIceMass) reduction(max : chiMax) \
+            schedule(dynamic, 1) if (!PARALLEL_CASES)
+        for (jNy = 0; jNy < Ny; jNy++)
+        {
+            Vector_1D& m0 = diag.number[jNy];
+            Vector_1D& m3 = diag.volume[jNy];
+            std::fill( m0.begin(), m0.end(), 0.0E+00 );
+            std::fill( m3.begin(), m3.end(), 0.0E+00 );
+            if ( full ) {
+                Vector_1D& m2 = diag.area[jNy];
+                std::fill( m2.begin(), m2.end(), 0.0E+00 );
+                for (iBin = 0; iBin < nBin; iBin++)
+                {
+                    const double ratio = log(bin_Edges[iBin + 1] / bin_Edges[iBin]);
+                    const double* pdfRow = pdf.binData(iBin) + jNy * Nx;
+                    const double* vRow = bin_VCenters.binData(iBin) + jNy * Nx;
+                    double binSum = 0.0E+00;
+                    for (iNx = 0; iNx < Nx; iNx++)
+                    {
+                        const double rV = FACTOR * vRow[iNx];
+                        m0[iNx] += ratio * pdfRow[iNx];
+                        m2[iNx] += ratio * pow(rV, 2 / 3.0) * pdfRow[iNx];
+                        m3[iNx] += ratio * rV * pdfRow[iNx];
+                        binSum += pdfRow[iNx] * cellAreas[jNy][iNx] * 1.0E+06;
+                    }
+                    diag.rowSizeDist[jNy][iBin] = binSum;
+                }
+            }
+            else {
+                for (iBin = 0; iBin < nBin; iBin++)
+                {
+                    const double ratio = log(bin_Edges[iBin + 1] / bin_Edges[iBin]);
+                    const double* pdfRow = pdf.binData(iBin) + jNy * Nx;
+                    const double* vRow = bin_VCenters.binData(iBin) + jNy * Nx;
+                    for (iNx = 0; iNx < Nx; iNx++)
+                    {
+                        m0[iNx] += ratio * pdfRow[iNx];
+                        m3[iNx] += ratio * (FACTOR * vRow[iNx]) * pdfRow[iNx];
+                    }
+                }
+            }
+
+            for (iNx = 0; iNx < Nx; iNx++)
+            {
+                const double volume = m3[iNx] * VOL_FACTOR;
+                const double iwc = volume * IWC_FACTOR;
+                /* Unit check: [m^3/cm^3] * [kg/m^3] * [cm^3/m^3] = [kg/m^3] */
+                totalNumber += m0[iNx] * cellAreas[jNy][iNx] * 1.0E+06;
+                totalIceMass += iwc * cellAreas[jNy][iNx];
+                if ( full ) {
+                    const double m2 = diag.area[jNy][iNx];
+                    const double rE = ( m2 > 0.0 ) ? m3[iNx] / m2 : 0.0E+00;
+                    const double chi = ( rE > 1.00E-15 ) ? iwc * (a + b / rE) : 0.0E+00;
+                    diag.area[jNy][iNx] = m2 * AREA_FACTOR;
+                    diag.effRadius[jNy][iNx] = rE;
+                    diag.extinction[jNy][iNx] = chi;
+                    diag.xOD[jNy] += dx[iNx] * chi;
+                    chiMax = std::max( chiMax, chi );
+                }
+                diag.IWC[jNy][iNx] = iwc;
+                m3[iNx] = volume;
+            }
+        }
+
+        diag.totalNumber = totalNumber;
+        diag.totalIceMass = totalIceMass;
+        if ( !full )
+            return;
+
+        /* Column sums, extent of the contrail and size distribution */
+        const double chiThres = thres * chiMax;
+        int i_left = -1, i_right = -1, j_bot = -1, j_top = -1;
+        for (jNy = 0; jNy < Ny; jNy++)
+        {
+            for (iNx = 0; iNx < Nx; iNx++)
+            {
+                const double chi = diag.extinction[jNy][iNx];
+                if ( !std::isfinite( chi ) )
+                    throw std::out_of_range("in Grid_Aerosol::Diagnose: inf or nan found in extinction");
+                diag.yOD[iNx] += dy[jNy] * chi;
+                if ( chi > chiThres ) {
+                    if ( i_left == -1 || int(iNx) < i_left ) i_left = iNx;
+                    if ( int(iNx) > i_right ) i_right = iNx;
+                    if ( j_bot == -1 ) j_bot = jNy;
+                    j_top = jNy;
+                }
+            }
+            for (iBin = 0; iBin < nBin; iBin++)
+                diag.sizeDist[iBin] += diag.rowSizeDist[jNy][iBin];
+        }
+        diag.width = ( i_left == -1 ) ? 0.0E+00 : std::abs(xCoord[i_right] - xCoord[i_left]);
+        diag.depth = ( j_bot == -1 ) ? 0.0E+00 : std::abs(yCoord[j_top] - yCoord[j_bot]);
+        diag.intOD = std::inner_product(diag.yOD.begin(), diag.yOD.end(), dx.begin(), 0.0);
+
+    } /* End of Grid_Aerosol::Diagnose */
+
     Vector_1D Grid_Aerosol::PDF_Total(const Vector_2D &cellAreas) const
     {
 
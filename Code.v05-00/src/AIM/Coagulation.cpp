@@ -251,6 +251,16 @@ namespace AIM
 
     } /* End of Coagulation::Coagulation */
 
+    Coagulation::Coagulation( const Vector_2D &beta_, const Vector_1D &bin_VCenters_1 ):
+        beta( beta_ )
+    {
+
+        /* Constructor */
+
+        buildF   ( bin_VCenters_1 );
+
+    } /* End of Coagulation::Coagulation */
+
     Coagulation::~Coagulation( )
     {
 
@@ -264,8 +274,7 @@ namespace AIM
         Kernel = k.Kernel;
         Kernel_1D = k.Kernel_1D;
         beta = k.beta;
-        f = k.f;
-        indices = k.indices;
+        partition = k.partition;
 
     } /* End of Coagulation::Coagulation */
 
@@ -278,8 +287,7 @@ namespace AIM
         Kernel = k.Kernel;
         Kernel_1D = k.Kernel_1D;
         beta = k.beta;
-        f = k.f;
-        indices = k.indices;
+        partition = k.partition;
         return *this;
 
     } /* End of Coagulation::operator= */
@@ -327,105 +335,101 @@ namespace AIM
 
     } /* End of Coagulation::buildBeta */
 
-    void Coagulation::buildF(const Vector_1D &bin_VCenters )
+    void Coagulation::buildF( const Vector_1D &bin_VCenters )
     {
 
         double vij;
-        UInt iBin, jBin, index;
+        UInt iBin, jBin, kBin, index;
         UInt size = bin_VCenters.size();
 
-        Vector_2D v2d;
-        std::vector<std::vector<UInt> > v2d_index;
-        std::vector<UInt> v1d_index;
+        Partition &p = partition;
+        p.target.resize( size * size );
+        p.frac.resize( size * size );
 
-        for ( iBin = 0; iBin < size; iBin++ ) {
-            indices.push_back( v2d_index );
-            for ( jBin = 0; jBin < size; jBin++ )
-                indices[iBin].push_back( v1d_index );
-        }
-
-        for ( iBin = 0; iBin < size; iBin++ ) {
-            f.push_back( v2d );
+        /* 1. Split the volume of each pair between the two bins whose volume centers bracket it */
+        for ( kBin = 0; kBin < size; kBin++ ) {
             for ( jBin = 0; jBin < size; jBin++ ) {
-                f[iBin].push_back( Vector_1D( size, 0.0 ) );
-                vij = bin_VCenters[iBin] + bin_VCenters[jBin];
+                vij = bin_VCenters[kBin] + bin_VCenters[jBin];
                 /* Using std functions: */
                 index = std::distance( bin_VCenters.begin(), std::upper_bound( bin_VCenters.begin(), bin_VCenters.end(), vij ) ) - 1;
-
                 if ( index < size-1 ) {
-                    f[iBin][jBin][index  ] = ( bin_VCenters[index+1] - vij ) / ( bin_VCenters[index+1] - bin_VCenters[index] ) * bin_VCenters[index] / vij;
-                    f[iBin][jBin][index+1] = 1.0 - f[iBin][jBin][index];
-                    indices[jBin][index  ].push_back( iBin );
-                    indices[jBin][index+1].push_back( iBin );
-                } else if ( index >= size-1 ) {
-                    index = size-1;
-                    f[iBin][jBin][index  ] = 1.0;
-                    indices[jBin][index  ].push_back( iBin );
+                    p.target[kBin * size + jBin] = index;
+                    p.frac[kBin * size + jBin] = ( bin_VCenters[index+1] - vij ) / ( bin_VCenters[index+1] - bin_VCenters[index] ) * bin_VCenters[index] / vij;
+                } else {
+                    p.target[kBin * size + jBin] = size-1;
+                    p.frac[kBin * size + jBin] = 1.0;
                 }
 
                 /* For debug purposes */
                 if ( 0 ) {
-                    std::cout << "(iBin, jBin) = (" << iBin << ", " << jBin << ") , Index: " << index << ", ";
-                    std::cout << bin_VCenters[index] << " <= " << vij << " < " << bin_VCenters[index+1] << "\n";
-
-                    std::cout << "(iBin, jBin) = (" << iBin << ", " << jBin << ") , Index    : " << index << ", f = " << f[iBin][jBin][index] << "\n";
-                    std::cout << "(iBin, jBin) = (" << iBin << ", " << jBin << ") , Index + 1: " << index+1 << ", f = " << f[iBin][jBin][index+1] << "\n";
+                    std::cout << "(kBin, jBin) = (" << kBin << ", " << jBin << ") , Index: " << p.target[kBin * size + jBin];
+                    std::cout << ", f = " << p.frac[kBin * size + jBin] << "\n";
                 }
-
             }
         }
 
-    } /* End of Coagulation::buildF */
-
-    void Coagulation::buildF( const Vector_3D &bin_VCenters, const UInt jNy, const UInt iNx )
-    {
-
-        double vij;
-        UInt iBin, jBin, kBin, index;
-        UInt size = bin_VCenters.size();
-        Vector_1D bin_VCentersCopy( size, 0.0E+00 );
-
-        Vector_2D v2d;
-        std::vector<std::vector<UInt> > v2d_index;
-        std::vector<UInt> v1d_index;
+        /* 2. Production entries, counted then filled by destination bin. Pairs are
+         * visited by j then k, so that each row keeps this order */
+        p.rowStart.assign( size + 1, 0 );
+        for ( int pass = 0; pass < 2; pass++ ) {
+            for ( jBin = 0; jBin < size; jBin++ ) {
+                for ( kBin = 0; kBin < size; kBin++ ) {
+                    const UInt pair = kBin * size + jBin;
+                    for ( UInt dest = p.target[pair]; dest < std::min( p.target[pair] + 2, size ); dest++ ) {
+                        /* k coagulating with j to form i, for j <= i and k < i */
+                        const double f_ = ( dest == p.target[pair] ) ? p.frac[pair] : 1.0 - p.frac[pair];
+                        if ( kBin >= dest || jBin > dest || f_ == 0.0 )
+                            continue;
+                        if ( pass == 0 ) {
+                            p.rowStart[dest + 1]++;
+                        } else {
+                            const UInt e = p.rowStart[dest]++;
+                            p.kBin[e] = kBin;
+                            p.jBin[e] = jBin;
+                            p.coef[e] = f_ * beta[kBin][jBin];
+                        }
+                    }
+                }
+            }
+            if ( pass == 0 ) {
+                for ( iBin = 0; iBin < size; iBin++ )
+                    p.rowStart[iBin + 1] += p.rowStart[iBin];
+                p.kBin.resize( p.rowStart[size] );
+                p.jBin.resize( p.rowStart[size] );
+                p.coef.resize( p.rowStart[size] );
+            } else {
+                /* Filling advanced each row start to the start of the next row */
+                for ( iBin = size; iBin > 0; iBin-- )
+                    p.rowStart[iBin] = p.rowStart[iBin - 1];
+                p.rowStart[0] = 0;
+            }
+        }
 
+        /* 3. Loss of bin i coagulating with j: the part of the volume leaving bin i */
+        p.loss.resize( size * size );
         for ( iBin = 0; iBin < size; iBin++ ) {
-            bin_VCentersCopy[iBin] = bin_VCenters[iBin][jNy][iNx];
             for ( jBin = 0; jBin < size; jBin++ )
-                indices[iBin][jBin].clear();
+                p.loss[iBin * size + jBin] = ( 1.0 - fraction( iBin, jBin, iBin ) ) * beta[iBin][jBin];
         }
 
-        for ( iBin = 0; iBin < size; iBin++ ) {
-            for ( jBin = 0; jBin < size; jBin++ ) {
-                for ( kBin = 0; kBin < size; kBin++ )
-                    f[iBin][jBin][kBin] = 0.0E+00;
-                vij = bin_VCentersCopy[iBin] + bin_VCentersCopy[jBin];
-                /* Using std functions: */
-                index = std::distance( bin_VCentersCopy.begin(), std::upper_bound( bin_VCentersCopy.begin(), bin_VCentersCopy.end(), vij ) ) - 1;
-                if ( index < size-1 ) {
-                    f[iBin][jBin][index  ] = ( bin_VCentersCopy[index+1] - vij ) / ( bin_VCentersCopy[index+1] - bin_VCentersCopy[index] ) * bin_VCentersCopy[index] / vij;
-                    f[iBin][jBin][index+1] = 1.0 - f[iBin][jBin][index];
-                    indices[jBin][index  ].push_back( iBin );
-                    indices[jBin][index+1].push_back( iBin );
-                } else if ( index >= size-1 ) {
-                    index = size-1;
-                    f[iBin][jBin][index  ] = 1.0;
-                    indices[jBin][index  ].push_back( iBin );
-                }
+    } /* End of Coagulation::buildF */
 
-                /* For debug purposes */
-                if ( 0 ) {
-                    std::cout << "(iBin, jBin) = (" << iBin << ", " << jBin << ") , Index: " << index << ", ";
-                    std::cout << bin_VCentersCopy[index] << " <= " << vij << " < " << bin_VCentersCopy[index+1] << "\n";
+    double Coagulation::fraction( const UInt kBin, const UInt jBin, const UInt iBin ) const
+    {
 
-                    std::cout << "(iBin, jBin) = (" << iBin << ", " << jBin << ") , Index    : " << index << ", f = " << f[iBin][jBin][index] << "\n";
-                    std::cout << "(iBin, jBin) = (" << iBin << ", " << jBin << ") , Index + 1: " << index+1 << ", f = " << f[iBin][jBin][index+1] << "\n";
-                }
+        /* No partition without buildF, e.g. for the kernel with a single particle size */
+        if ( partition.rowStart.empty() )
+            return 0.0E+00;
 
-            }
-        }
+        const UInt size = partition.rowStart.size() - 1;
+        const UInt pair = kBin * size + jBin;
+        if ( iBin == partition.target[pair] )
+            return partition.frac[pair];
+        else if ( iBin == partition.target[pair] + 1 )
+            return 1.0 - partition.frac[pair];
+        return 0.0E+00;
 
-    } /* End of Coagulation::buildF */
+    } /* End of Coagulation::fraction */
 
     Vector_2D Coagulation::getKernel() const
     {
@@ -451,6 +455,19 @@ namespace AIM
     Vector_3D Coagulation::getF() const
     {
 
+        if ( partition.rowStart.empty() )
+            return Vector_3D();
+
+        const UInt size = partition.rowStart.size() - 1;
+        Vector_3D f( size, Vector_2D( size, Vector_1D( size, 0.0E+00 ) ) );
+        for ( UInt kBin = 0; kBin < size; kBin++ ) {
+            for ( UInt jBin = 0; jBin < size; jBin++ ) {
+                const UInt index = partition.target[kBin * size + jBin];
+                f[kBin][jBin][index] = partition.frac[kBin * size + jBin];
+                if ( index < size-1 )
+                    f[kBin][jBin][index+1] = 1.0 - f[kBin][jBin][index];
+            }
+        }
         return f;
 
     } /* End of Coagulation::getF */
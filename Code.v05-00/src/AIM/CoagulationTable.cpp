@@ -0,0 +1,213 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*                        AIrcraft Microphysics                     */
+/*                              (AIM)                               */
+/*                                                                  */
+/* CoagulationTable Program File                                    */
+/*                                                                  */
+/* File                 : CoagulationTable.cpp                      */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+#include "Util/PhysConstant.hpp"
+#include "AIM/CoagulationTable.hpp"
+
+namespace AIM
+{
+    namespace {
+        /* Phase, bin centers, densities and radius of the second population (self-coagulation flag last) */
+        typedef std::tuple<std::string, Vector_1D, double, double, double, bool> TableKey;
+
+        std::mutex cacheMutex;
+        std::map<TableKey, std::shared_ptr<const CoagulationTable>> cache;
+
+        std::atomic<bool> useTables(false);
+    }
+
+    CoagulationTable::CoagulationTable( const std::string& phase, const Vector_1D& bin_Centers, double rho ):
+        phase_(phase),
+        bin_Centers_(bin_Centers),
+        rho_1_(rho),
+        bin_R_(0.0E+00),
+        rho_2_(rho),
+        self_(true)
+    { }
+
+    CoagulationTable::CoagulationTable( const std::string& phase, const Vector_1D& bin_Centers, double rho_1, double bin_R, double rho_2 ):
+        phase_(phase),
+        bin_Centers_(bin_Centers),
+        rho_1_(rho_1),
+        bin_R_(bin_R),
+        rho_2_(rho_2),
+        self_(false)
+    { }
+
+    std::shared_ptr<const CoagulationTable> CoagulationTable::load( const std::string& phase, const Vector_1D& bin_Centers, double rho )
+    {
+        const TableKey key( phase, bin_Centers, rho, 0.0E+00, rho, true );
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(key);
+        if ( it == cache.end() )
+            it = cache.emplace(key, std::make_shared<const CoagulationTable>(phase, bin_Centers, rho)).first;
+        return it->second;
+    }
+
+    std::shared_ptr<const CoagulationTable> CoagulationTable::load( const std::string& phase, const Vector_1D& bin_Centers, double rho_1, double bin_R, double rho_2 )
+    {
+        const TableKey key( phase, bin_Centers, rho_1, bin_R, rho_2, false );
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(key);
+        if ( it == cache.end() )
+            it = cache.emplace(key, std::make_shared<const CoagulationTable>(phase, bin_Centers, rho_1, bin_R, rho_2)).first;
+        return it->second;
+    }
+
+    void CoagulationTable::clearCache()
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache.clear();
+    }
+
+    void CoagulationTable::configure( bool enabled )
+    {
+        useTables = enabled;
+    }
+
+    bool CoagulationTable::enabled()
+    {
+        return useTables;
+    }
+
+    Vector_2D CoagulationTable::beta( double temperature_K, double pressure_Pa ) const
+    {
+        if ( !self_ )
+            throw std::runtime_error( "In CoagulationTable::beta: table does not hold a self-coagulation kernel" );
+
+        const std::size_t size = bin_Centers_.size();
+        Vector_1D values;
+        interpolate( temperature_K, pressure_Pa, values );
+
+        Vector_2D beta( size, Vector_1D( size ) );
+        for ( std::size_t iBin = 0; iBin < size; iBin++ ) {
+            for ( std::size_t jBin = 0; jBin < size; jBin++ )
+                beta[iBin][jBin] = values[iBin * size + jBin];
+        }
+        return beta;
+    }
+
+    Coagulation CoagulationTable::kernel( double temperature_K, double pressure_Pa, const Vector_1D& bin_VCenters ) const
+    {
+        return Coagulation( beta( temperature_K, pressure_Pa ), bin_VCenters );
+    }
+
+    Vector_1D CoagulationTable::kernel_1D( double temperature_K, double pressure_Pa ) const
+    {
+        if ( self_ )
+            throw std::runtime_error( "In CoagulationTable::kernel_1D: table holds a self-coagulation kernel" );
+
+        Vector_1D values;
+        interpolate( temperature_K, pressure_Pa, values );
+        return values;
+    }
+
+    std::size_t CoagulationTable::nodes() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return nodes_.size();
+    }
+
+    std::shared_ptr<const Vector_1D> CoagulationTable::node( long iT, long iP ) const
+    {
+        const std::pair<long, long> key( iT, iP );
+        std::promise<std::shared_ptr<const Vector_1D>> promise;
+        Node pending;
+        bool firstRequest = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = nodes_.find(key);
+            if ( it == nodes_.end() ) {
+                pending = promise.get_future().share();
+                nodes_.emplace(key, pending);
+                firstRequest = true;
+            }
+            else {
+                pending = it->second;
+            }
+        }
+        /* Build outside of the lock, so other nodes can be requested meanwhile */
+        if ( !firstRequest ) return pending.get();
+
+        try {
+            auto values = std::make_shared<const Vector_1D>( buildNode( iT, iP ) );
+            promise.set_value(values);
+            return values;
+        }
+        catch (...) {
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(mutex_);
+            nodes_.erase(key);
+            throw;
+        }
+    }
+
+    Vector_1D CoagulationTable::buildNode( long iT, long iP ) const
+    {
+        const double temperature_K = iT * DT_K;
+        const double pressure_Pa = exp( iP * DLOGP );
+
+        if ( !self_ ) {
+            const Coagulation kernel( phase_.c_str(), bin_Centers_, rho_1_, bin_R_, rho_2_, temperature_K, pressure_Pa );
+            return kernel.getKernel_1D();
+        }
+
+        /* Bin volumes only serve the volume partition, which is not tabulated */
+        const std::size_t size = bin_Centers_.size();
+        Vector_1D bin_VCenters( size );
+        for ( std::size_t iBin = 0; iBin < size; iBin++ )
+            bin_VCenters[iBin] = 4.0 / double(3.0) * physConst::PI * bin_Centers_[iBin] * bin_Centers_[iBin] * bin_Centers_[iBin];
+
+        const Coagulation kernel( phase_.c_str(), bin_Centers_, bin_VCenters, rho_1_, temperature_K, pressure_Pa );
+        const Vector_2D beta = kernel.getBeta();
+        Vector_1D values( size * size );
+        for ( std::size_t iBin = 0; iBin < size; iBin++ ) {
+            for ( std::size_t jBin = 0; jBin < size; jBin++ )
+                values[iBin * size + jBin] = beta[iBin][jBin];
+        }
+        return values;
+    }
+
+    void CoagulationTable::interpolate( double temperature_K, double pressure_Pa, Vector_1D& values ) const
+    {
+        if ( !( temperature_K > 0.0 ) || !( pressure_Pa > 0.0 ) || !std::isfinite( temperature_K ) || !std::isfinite( pressure_Pa ) )
+            throw std::invalid_argument( "In CoagulationTable::interpolate: temperature and pressure must be positive" );
+
+        const double x = temperature_K / DT_K;
+        const double y = log( pressure_Pa ) / DLOGP;
+        const long iT = static_cast<long>( std::floor( x ) );
+        const long iP = static_cast<long>( std::floor( y ) );
+        const double wT = x - iT;
+        const double wP = y - iP;
+
+        values.clear();
+        for ( long dT = 0; dT < 2; dT++ ) {
+            for ( long dP = 0; dP < 2; dP++ ) {
+                const double weight = ( dT ? wT : 1.0 - wT ) * ( dP ? wP : 1.0 - wP );
+                /* Nodes with no weight are not built */
+                if ( weight == 0.0 )
+                    continue;
+                const std::shared_ptr<const Vector_1D> corner = node( iT + dT, iP + dP );
+                if ( values.empty() )
+                    values.assign( corner->size(), 0.0E+00 );
+                for ( std::size_t i = 0; i < values.size(); i++ )
+                    values[i] += weight * (*corner)[i];
+            }
+        }
+    }
+
+}
+
+/* End of CoagulationTable.cpp */
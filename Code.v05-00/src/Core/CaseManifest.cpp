@@ -0,0 +1,50 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* CaseManifest Program File                                        */
+/*                                                                  */
+/* File                 : CaseManifest.cpp                          */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "Core/CaseManifest.hpp"
+
+CaseManifest::CaseManifest( const std::string& folder )
+{
+    std::ifstream file( folder + "/" + FILENAME );
+    std::string line;
+    while ( std::getline( file, line ) ) {
+        /* A line cut short by a killed job has no terminating newline */
+        if ( file.eof() )
+            break;
+        std::istringstream fields( line );
+        std::size_t iCase;
+        std::string status;
+        if ( !( fields >> iCase >> status ) )
+            continue;
+        if ( status == statusName( SimStatus::Failed ) )
+            finished_.erase( iCase );
+        else
+            finished_.insert( iCase );
+    }
+}
+
+void CaseManifest::append( const std::string& folder, std::size_t iCase, SimStatus status )
+{
+    const std::string fullPath = folder + "/" + FILENAME;
+    const std::string line = std::to_string( iCase ) + " " + statusName( status ) + "\n";
+
+    /* O_APPEND makes each write land at the end of the file, even with several writers */
+    const int fd = open( fullPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644 );
+    if ( fd == -1 || write( fd, line.c_str(), line.size() ) != static_cast<ssize_t>( line.size() ) )
+        std::cout << " Could not record case " << iCase << " in " << fullPath << std::endl;
+    if ( fd != -1 )
+        close( fd );
+}
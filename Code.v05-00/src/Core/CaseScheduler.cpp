@@ -0,0 +1,91 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* CaseScheduler Program File                                       */
+/*                                                                  */
+/* File                 : CaseScheduler.cpp                         */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include "Util/PhysFunction.hpp"
+#include "Core/CaseScheduler.hpp"
+
+namespace {
+    /* Relative cost of a case in ice-subsaturated air, where the contrail sublimates
+     * well before the end of the simulation */
+    const double SUBSATURATED_COST = 0.1;
+
+    std::mutex runningMutex;
+    /* Ids of the running cases, in the order they started */
+    std::vector<std::uint64_t> running;
+    std::uint64_t nextId = 1;
+    /* Id of the case running on this thread, 0 if none */
+    thread_local std::uint64_t currentId = 0;
+}
+
+CaseScheduler::CaseScheduler( const YamlInputReader::CaseSpace& caseSpace, bool metInput, bool longestFirst,
+                              const CaseSelection& selection )
+{
+    for ( std::size_t iCase = 0; iCase < caseSpace.size(); iCase++ ) {
+        if ( selection.contains( iCase ) )
+            order_.push_back( iCase );
+    }
+    if ( !longestFirst )
+        return;
+
+    Vector_1D cost( order_.size() );
+    for ( std::size_t i = 0; i < order_.size(); i++ )
+        cost[i] = expectedCost( caseSpace.parameters( order_[i] ), metInput );
+
+    std::vector<std::size_t> rank( order_.size() );
+    std::iota( rank.begin(), rank.end(), 0 );
+    std::stable_sort( rank.begin(), rank.end(), [&cost]( std::size_t a, std::size_t b ) {
+        return cost[a] > cost[b];
+    } );
+    std::vector<std::size_t> sorted( order_.size() );
+    for ( std::size_t i = 0; i < rank.size(); i++ )
+        sorted[i] = order_[rank[i]];
+    order_ = std::move( sorted );
+}
+
+double CaseScheduler::expectedCost( const YamlInputReader::CaseParameters& parameters, bool metInput )
+{
+    if ( metInput )
+        return parameters.simulationTime;
+
+    const double RHi = physFunc::RHwToRHi( parameters.relHumidity_w, parameters.temperature_K );
+    return parameters.simulationTime * ( RHi >= 100.0 ? 1.0 : SUBSATURATED_COST );
+}
+
+CaseScheduler::RunningCase::RunningCase( )
+{
+    std::lock_guard<std::mutex> lock(runningMutex);
+    id_ = nextId++;
+    running.push_back( id_ );
+    currentId = id_;
+}
+
+CaseScheduler::RunningCase::~RunningCase( )
+{
+    std::lock_guard<std::mutex> lock(runningMutex);
+    running.erase( std::find( running.begin(), running.end(), id_ ) );
+    currentId = 0;
+}
+
+int CaseScheduler::threadShare( int totalThreads )
+{
+    std::lock_guard<std::mutex> lock(runningMutex);
+    auto it = std::find( running.begin(), running.end(), currentId );
+    if ( currentId == 0 || it == running.end() )
+        return totalThreads;
+
+    /* Spread the remainder over the cases that started first */
+    const int nRunning = running.size();
+    const int rank = it - running.begin();
+    return std::max( 1, totalThreads / nRunning + ( rank < totalThreads % nRunning ? 1 : 0 ) );
+}
@@ -0,0 +1,56 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* CaseSelection Program File                                       */
+/*                                                                  */
+/* File                 : CaseSelection.cpp                         */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <stdexcept>
+#include "Core/CaseSelection.hpp"
+
+namespace {
+    std::size_t parseIndex( const std::string& str, const std::string& spec )
+    {
+        std::size_t pos = 0;
+        unsigned long long value = 0;
+        try {
+            value = std::stoull( str, &pos );
+        }
+        catch ( const std::logic_error& ) {
+            pos = 0;
+        }
+        if ( str.empty() || pos != str.size() || str.front() == '-' )
+            throw std::invalid_argument( "Invalid case selection: " + spec );
+        return value;
+    }
+}
+
+void CaseSelection::setShard( const std::string& spec )
+{
+    const std::size_t sep = spec.find( '/' );
+    if ( sep == std::string::npos )
+        throw std::invalid_argument( "Invalid case selection: " + spec );
+    const std::size_t shard = parseIndex( spec.substr( 0, sep ), spec );
+    const std::size_t nShards = parseIndex( spec.substr( sep + 1 ), spec );
+    if ( nShards == 0 || shard >= nShards )
+        throw std::invalid_argument( "Invalid case selection: " + spec + ", shard index must be in [0, N)" );
+    shard_ = shard;
+    nShards_ = nShards;
+}
+
+void CaseSelection::setRange( const std::string& spec )
+{
+    const std::size_t sep = spec.find( ':' );
+    if ( sep == std::string::npos )
+        throw std::invalid_argument( "Invalid case selection: " + spec );
+    const std::string first = spec.substr( 0, sep );
+    const std::string last = spec.substr( sep + 1 );
+    first_ = first.empty() ? 0 : parseIndex( first, spec );
+    last_ = last.empty() ? std::numeric_limits<std::size_t>::max() : parseIndex( last, spec );
+    if ( first_ > last_ )
+        throw std::invalid_argument( "Invalid case selection: " + spec + ", first case after last" );
+}
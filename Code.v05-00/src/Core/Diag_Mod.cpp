@@ -14,12 +14,17 @@
 #define FMT_HEADER_ONLY
 #endif
 
+#include <algorithm>
 #include <filesystem>
+#include <iostream>
+#include <optional>
 #include <fmt/core.h>
 #include "KPP/KPP_Parameters.h"
 #include "Util/PhysFunction.hpp"
+#include "Util/Timing.hpp"
 #include "Core/Util.hpp"
 #include "Core/Diag_Mod.hpp"
+#include "Core/NetCDFMutex.hpp"
 
 namespace Diag {
 
@@ -40,6 +45,7 @@ namespace Diag {
         const char* outFile = fileName.c_str();
 
         // Open the file for writing - replacing anything already there
+        std::lock_guard<std::mutex> lock(netCDFMutex());
         NcFile currFile(outFile,NcFile::replace);
 
         time_t rawtime;
@@ -243,6 +249,17 @@ namespace Diag {
                     const Vector_1D& xCoord, const Vector_1D& yCoord,
                     const Vector_1D& xEdges, const Vector_1D& yEdges,
                     const Meteorology &met)
+    {
+        AIM::Grid_Aerosol::Diagnostics diag;
+        Diag_TS_Phys( rootName, hh, mm, ss, iceAer, H2O, xCoord, yCoord, xEdges, yEdges, met, diag );
+    }
+
+    void Diag_TS_Phys( const char* rootName,
+                    const int hh, const int mm, const int ss,
+                    const AIM::Grid_Aerosol& iceAer, const Vector_2D& H2O,
+                    const Vector_1D& xCoord, const Vector_1D& yCoord,
+                    const Vector_1D& xEdges, const Vector_1D& yEdges,
+                    const Meteorology &met, AIM::Grid_Aerosol::Diagnostics& diag )
     {   
         long unsigned int nBin = iceAer.getNBin();
         long unsigned int nx = xCoord.size();
@@ -251,6 +268,12 @@ namespace Diag {
         Vector_2D areas = VectorUtils::cellAreas(xEdges, yEdges);
         Vector_1D dx_vec(nx, xCoord[1] - xCoord[0]);
         Vector_1D dy_vec(ny, yCoord[1] - yCoord[0]);
+        {
+            Timing::Scope timer("Diagnostics");
+            diag.full = true;
+            iceAer.Diagnose( diag, areas, xCoord, yCoord, dx_vec, dy_vec );
+        }
+        Timing::Scope timer("NetCDF");
         std::filesystem::path rootPath( rootName );
         std::string fileName = rootPath.filename().generic_string();
 
@@ -260,6 +283,7 @@ namespace Diag {
         const char* outFile = fileName.c_str();
 
         // Open file and don't worry about overwrite
+        std::lock_guard<std::mutex> lock(netCDFMutex());
         NcFile currFile(outFile,NcFile::replace);
 
         time_t rawtime;
@@ -331,47 +355,446 @@ namespace Diag {
         add2DVar(currFile, met.Temp(), xyDims, "Temperature", "Temperature", "K");
 
         /* Saving ice aerosol particle number */
-        add2DVar(currFile, iceAer.TotalNumber(), xyDims, "Ice aerosol particle number", "Ice aerosol particle number concentration", "# / cm^3");
+        add2DVar(currFile, diag.number, xyDims, "Ice aerosol particle number", "Ice aerosol particle number concentration", "# / cm^3");
 
         // /* Saving ice aerosol surface area 
-        add2DVar(currFile, iceAer.TotalArea(), xyDims, "Ice aerosol surface area", "Ice aerosol surface area", "m^2 / cm^3");
+        add2DVar(currFile, diag.area, xyDims, "Ice aerosol surface area", "Ice aerosol surface area", "m^2 / cm^3");
     
         /* Saving ice aerosol volume */
-        add2DVar(currFile, iceAer.TotalVolume(), xyDims, "Ice aerosol volume", "Ice aerosol volume", "m^3 / cm^3");
+        add2DVar(currFile, diag.volume, xyDims, "Ice aerosol volume", "Ice aerosol volume", "m^3 / cm^3");
 
         /* Saving ice aerosol effective radius */
-        add2DVar(currFile, iceAer.EffRadius(), xyDims, "Effective radius", "Ice aerosol effective radius", "m");
+        add2DVar(currFile, diag.effRadius, xyDims, "Effective radius", "Ice aerosol effective radius", "m");
 
         /* Saving horizontal optical depth */
-        add1DVar(currFile, iceAer.xOD(dx_vec), yDim, "Horizontal optical depth", "Horizontally-integrated optical depth", "-");
+        add1DVar(currFile, diag.xOD, yDim, "Horizontal optical depth", "Horizontally-integrated optical depth", "-");
 
         /* Saving vertical optical depth */
-        add1DVar(currFile, iceAer.yOD(dy_vec), xDim, "Vertical optical depth", "Vertically-integrated optical depth", "-");
+        add1DVar(currFile, diag.yOD, xDim, "Vertical optical depth", "Vertically-integrated optical depth", "-");
     
         /* Saving overall size distribution */ 
-        add1DVar(currFile, iceAer.Overall_Size_Dist(areas), binRadDim, "Overall size distribution", "Overall size distribution of ice particles", "part / m");
+        add1DVar(currFile, diag.sizeDist, binRadDim, "Overall size distribution", "Overall size distribution of ice particles", "part / m");
 
         /* Saving Total Ice Mass [kg/m] */
-        add0DVar(currFile, iceAer.TotalIceMass_sum(areas), tDim, "Ice Mass", "Total Mass of Ice Crystals of Cross Section", "kg / m");
+        add0DVar(currFile, diag.totalIceMass, tDim, "Ice Mass", "Total Mass of Ice Crystals of Cross Section", "kg / m");
 
         /* Saving Num Ice Particles [#/m] */
-        add0DVar(currFile, iceAer.TotalNumber_sum(areas), tDim, "Number Ice Particles", "Total Number of Ice Particles of Cross Section", "# / m");
+        add0DVar(currFile, diag.totalNumber, tDim, "Number Ice Particles", "Total Number of Ice Particles of Cross Section", "# / m");
 
         /* Saving Extinction [-/m]*/
-        add2DVar(currFile, iceAer.Extinction(), xyDims, "Extinction", "Extinction", "m^-1");
+        add2DVar(currFile, diag.extinction, xyDims, "Extinction", "Extinction", "m^-1");
 
         /* Saving IWC */
-        add2DVar(currFile, iceAer.IWC(), xyDims, "IWC", "Ice Water Content", "kg / m^3");
+        add2DVar(currFile, diag.IWC, xyDims, "IWC", "Ice Water Content", "kg / m^3");
 
         /* Saving RHi */
         add2DVar(currFile, physFunc::RHi_Field(H2O, met.Temp(), met.Press()), xyDims, "RHi", "Relative Humidity w.r.t. Ice", "%");
 
         //Contrail width, depth, and integrated OD
-        add0DVar(currFile, iceAer.extinctionWidth(xCoord), tDim, "width", "Contrail Extinction-Defined Width", "m");
-        add0DVar(currFile, iceAer.extinctionDepth(yCoord), tDim, "depth", "Contrail Extinction-Defined Depth", "m");
-        add0DVar(currFile, iceAer.intYOD(dx_vec, dy_vec), tDim, "intOD", "Integrated Vertical Optical Depth", "m");
+        add0DVar(currFile, diag.width, tDim, "width", "Contrail Extinction-Defined Width", "m");
+        add0DVar(currFile, diag.depth, tDim, "depth", "Contrail Extinction-Defined Depth", "m");
+        add0DVar(currFile, diag.intOD, tDim, "intOD", "Integrated Vertical Optical Depth", "m");
     } /* End of Diag_TS_Phys */
 
+    namespace {
+        struct VarInfo {
+            const char* name;
+            const char* desc;
+            const char* units;
+        };
+
+        /* Variables of TS_PhysSeries, in the order their values are computed in append */
+        const VarInfo CELL_VARS[] = {
+            { "H2O", "H2O molecular concentration", "molec / cm^3" },
+            { "Temperature", "Temperature", "K" },
+            { "Ice aerosol particle number", "Ice aerosol particle number concentration", "# / cm^3" },
+            { "Ice aerosol surface area", "Ice aerosol surface area", "m^2 / cm^3" },
+            { "Ice aerosol volume", "Ice aerosol volume", "m^3 / cm^3" },
+            { "Effective radius", "Ice aerosol effective radius", "m" },
+            { "Extinction", "Extinction", "m^-1" },
+            { "IWC", "Ice Water Content", "kg / m^3" },
+            { "RHi", "Relative Humidity w.r.t. Ice", "%" },
+        };
+        const VarInfo Y_VARS[] = {
+            { "Pressure", "Pressure", "Pa" },
+            { "Altitude", "Altitude", "m" },
+            { "Horizontal optical depth", "Horizontally-integrated optical depth", "-" },
+        };
+        const VarInfo X_VARS[] = {
+            { "Vertical optical depth", "Vertically-integrated optical depth", "-" },
+        };
+        const VarInfo T_VARS[] = {
+            { "Ice Mass", "Total Mass of Ice Crystals of Cross Section", "kg / m" },
+            { "Number Ice Particles", "Total Number of Ice Particles of Cross Section", "# / m" },
+            { "width", "Contrail Extinction-Defined Width", "m" },
+            { "depth", "Contrail Extinction-Defined Depth", "m" },
+            { "intOD", "Integrated Vertical Optical Depth", "m" },
+        };
+        const char* const RECORD_OFFSETS[] = { "x_start", "nx", "y_start", "ny", "cell_start" };
+
+        /* Records within this time [hr] of each other are the same output time */
+        const float TIME_EPS = 1.0E-04;
+        /* Chunk length along t */
+        const std::size_t T_CHUNK = 256;
+
+        std::vector<float> toFloat( const Vector_1D& values ) {
+            return std::vector<float>( values.begin(), values.end() );
+        }
+
+        /* Flattened in (y, x) order */
+        std::vector<float> toFloat( const Vector_2D& values ) {
+            std::vector<float> flat;
+            flat.reserve( values.size() * ( values.empty() ? 0 : values[0].size() ) );
+            for ( const Vector_1D& row: values )
+                flat.insert( flat.end(), row.begin(), row.end() );
+            return flat;
+        }
+    }
+
+    string seriesFileName( const string& rootName )
+    {
+        std::filesystem::path rootPath( rootName );
+        string fileName = rootPath.filename().generic_string();
+        for ( const char* field: { "hh", "mm", "ss" } ) {
+            size_t pos;
+            while ( ( pos = fileName.find( field ) ) != string::npos )
+                fileName.erase( pos, 2 );
+        }
+        /* Drop the separator left in front of the extension */
+        size_t ext = fileName.rfind( '.' );
+        if ( ext == string::npos )
+            ext = fileName.size();
+        while ( ext > 0 && ( fileName[ext - 1] == '_' || fileName[ext - 1] == '-' ) )
+            fileName.erase( --ext, 1 );
+        return std::filesystem::path( rootPath.parent_path() / fileName ).generic_string();
+    }
+
+    TS_PhysSeries::TS_PhysSeries( const string& fileName, const SeriesSettings& settings, bool resume ):
+        fileName_( fileName ),
+        settings_( settings ),
+        resume_( resume )
+    { }
+
+    void TS_PhysSeries::create( NcFile& file, const AIM::Grid_Aerosol& iceAer ) const
+    {
+        const std::size_t nBin = iceAer.getNBin();
+
+        // Record dimension and ragged grid dimensions are all unlimited
+        const NcDim tDim       = file.addDim( "t" );
+        const NcDim xDim       = file.addDim( "x" );
+        const NcDim yDim       = file.addDim( "y" );
+        const NcDim cellDim    = file.addDim( "cell" );
+        const NcDim binEdgeDim = file.addDim( "r_b", nBin + 1 );
+        const NcDim binRadDim  = file.addDim( "r", nBin );
+
+        auto addVar = [&file]( const VarInfo& info, const NcType& type, const vector<NcDim>& dims ) {
+            NcVar var = file.addVar( info.name, type, dims );
+            var.putAtt( "units", info.units );
+            var.putAtt( "long_name", info.desc );
+            return var;
+        };
+        auto setStorage = [this]( NcVar& var, vector<size_t> chunks, bool quantize ) {
+            var.setChunking( NcVar::nc_CHUNKED, chunks );
+            if ( settings_.deflateLevel > 0 )
+                var.setCompression( settings_.shuffle, true, settings_.deflateLevel );
+            if ( quantize && settings_.significantDigits > 0 ) {
+                #ifdef NC_QUANTIZE_BITGROOM
+                    ncCheck( nc_def_var_quantize( var.getParentGroup().getId(), var.getId(), \
+                                                  NC_QUANTIZE_BITGROOM, settings_.significantDigits ), __FILE__, __LINE__ );
+                #endif /* NC_QUANTIZE_BITGROOM */
+            }
+        };
+        #ifndef NC_QUANTIZE_BITGROOM
+            if ( settings_.significantDigits > 0 )
+                std::cout << "WARNING: netCDF library without quantization support, time series are stored exactly" << std::endl;
+        #endif /* NC_QUANTIZE_BITGROOM */
+
+        NcVar tVar = addVar( { "t", "time", "hours since simulation start" }, ncFloat, { tDim } );
+        setStorage( tVar, { T_CHUNK }, false );
+        for ( const char* name: RECORD_OFFSETS ) {
+            NcVar var = addVar( { name, "Ragged storage of the record", "-" }, ncInt64, { tDim } );
+            setStorage( var, { T_CHUNK }, false );
+        }
+
+        NcVar xVar = addVar( { "x", "Grid cell horizontal centers", "m" }, ncFloat, { xDim } );
+        setStorage( xVar, { settings_.chunkSize }, false );
+        NcVar yVar = addVar( { "y", "Grid cell vertical centers", "m" }, ncFloat, { yDim } );
+        setStorage( yVar, { settings_.chunkSize }, false );
+        for ( const VarInfo& info: X_VARS ) {
+            NcVar var = addVar( info, ncFloat, { xDim } );
+            setStorage( var, { settings_.chunkSize }, true );
+        }
+        for ( const VarInfo& info: Y_VARS ) {
+            NcVar var = addVar( info, ncFloat, { yDim } );
+            setStorage( var, { settings_.chunkSize }, true );
+        }
+        for ( const VarInfo& info: CELL_VARS ) {
+            NcVar var = addVar( info, ncFloat, { cellDim } );
+            setStorage( var, { settings_.chunkSize }, true );
+        }
+        for ( const VarInfo& info: T_VARS ) {
+            NcVar var = addVar( info, ncFloat, { tDim } );
+            setStorage( var, { T_CHUNK }, true );
+        }
+        NcVar sizeDistVar = addVar( { "Overall size distribution", "Overall size distribution of ice particles", "part / m" }, \
+                                    ncFloat, { tDim, binRadDim } );
+        setStorage( sizeDistVar, { 1, nBin }, true );
+
+        NcVar binEdgeVar = addVar( { "r_e", "ice bin edge radius", "m" }, ncFloat, { binEdgeDim } );
+        binEdgeVar.putVar( toFloat( iceAer.getBinEdges() ).data() );
+        NcVar binRadVar = addVar( { "r", "Ice bin center radius", "m" }, ncFloat, { binRadDim } );
+        binRadVar.putVar( toFloat( iceAer.getBinCenters() ).data() );
+
+        time_t rawtime;
+        char buffer[80];
+        time( &rawtime );
+        strftime(buffer, sizeof(buffer),"%d-%m-%Y %H:%M:%S", localtime(&rawtime));
+
+        std::string author = "Thibaud M. Fritz (fritzt@mit.edu)";
+        file.putAtt( "FileName", fileName_ );
+        file.putAtt( "Author", author );
+        file.putAtt( "Contact", author );
+        file.putAtt( "Generation Date", buffer );
+        file.putAtt( "Format", "NetCDF-4" );
+        file.putAtt( "Layout", "Record n holds x and y from x_start(n) and y_start(n), nx(n) and ny(n) values long, "
+                               "and 2D fields as ny(n) rows of nx(n) values from cell_start(n)" );
+    }
+
+    void TS_PhysSeries::seek( const NcFile& file, float cur_time )
+    {
+        if ( file.getDim( "cell" ).isNull() )
+            throw std::runtime_error( "Cannot resume time series " + fileName_ + ", not written by TS_PhysSeries" );
+
+        const std::size_t nTimes = file.getDim( "t" ).getSize();
+        std::vector<float> times( nTimes );
+        if ( nTimes > 0 )
+            file.getVar( "t" ).getVar( times.data() );
+
+        record_ = 0;
+        while ( record_ < nTimes && times[record_] < cur_time - TIME_EPS )
+            record_++;
+
+        xStart_ = yStart_ = cellStart_ = 0;
+        if ( record_ == 0 )
+            return;
+        long long offsets[5];
+        for ( int i = 0; i < 5; i++ )
+            file.getVar( RECORD_OFFSETS[i] ).getVar( { record_ - 1 }, &offsets[i] );
+        xStart_ = offsets[0] + offsets[1];
+        yStart_ = offsets[2] + offsets[3];
+        cellStart_ = offsets[4] + offsets[1] * offsets[3];
+    }
+
+    void TS_PhysSeries::append( const int hh, const int mm, const int ss,
+                                const AIM::Grid_Aerosol& iceAer, const Vector_2D& H2O,
+                                const Vector_1D& xCoord, const Vector_1D& yCoord,
+                                const Vector_1D& xEdges, const Vector_1D& yEdges,
+                                const Meteorology &met )
+    {
+        const std::size_t nBin = iceAer.getNBin();
+        const std::size_t nx = xCoord.size();
+        const std::size_t ny = yCoord.size();
+        const float cur_time = hh+mm/60.0+ss/3600.0;
+
+        // Diagnostics are computed before taking the netCDF lock
+        Vector_2D areas = VectorUtils::cellAreas(xEdges, yEdges);
+        Vector_1D dx_vec(nx, xCoord[1] - xCoord[0]);
+        Vector_1D dy_vec(ny, yCoord[1] - yCoord[0]);
+        std::optional<Timing::Scope> diagTimer( std::in_place, "Diagnostics" );
+        diag_.full = true;
+        iceAer.Diagnose( diag_, areas, xCoord, yCoord, dx_vec, dy_vec );
+
+        const std::vector<std::vector<float>> cellValues = {
+            toFloat( H2O ), toFloat( met.Temp() ),
+            toFloat( diag_.number ), toFloat( diag_.area ), toFloat( diag_.volume ),
+            toFloat( diag_.effRadius ), toFloat( diag_.extinction ), toFloat( diag_.IWC ),
+            toFloat( physFunc::RHi_Field( H2O, met.Temp(), met.Press() ) ),
+        };
+        const std::vector<std::vector<float>> yValues = {
+            toFloat( met.Press() ), toFloat( met.Altitude() ), toFloat( diag_.xOD ),
+        };
+        const std::vector<std::vector<float>> xValues = {
+            toFloat( diag_.yOD ),
+        };
+        const std::vector<float> tValues = {
+            float( diag_.totalIceMass ), float( diag_.totalNumber ),
+            float( diag_.width ), float( diag_.depth ), float( diag_.intOD ),
+        };
+        const std::vector<float> sizeDist = toFloat( diag_.sizeDist );
+        diagTimer.reset();
+
+        Timing::Scope timer("NetCDF");
+        std::lock_guard<std::mutex> lock(netCDFMutex());
+        const bool fresh = !created_ && !( resume_ && std::filesystem::exists( fileName_ ) );
+        NcFile file;
+        if ( fresh ) {
+            file.open( fileName_, NcFile::replace, NcFile::nc4 );
+            create( file, iceAer );
+        }
+        else {
+            file.open( fileName_, NcFile::write );
+            if ( !created_ )
+                seek( file, cur_time );
+        }
+        created_ = true;
+        if ( file.getDim( "r" ).getSize() != nBin )
+            throw std::runtime_error( "Cannot append to time series " + fileName_ + ", number of bins differs" );
+
+        file.getVar( "t" ).putVar( { record_ }, cur_time );
+        const long long offsets[5] = { (long long) xStart_, (long long) nx, (long long) yStart_, (long long) ny, (long long) cellStart_ };
+        for ( int i = 0; i < 5; i++ )
+            file.getVar( RECORD_OFFSETS[i] ).putVar( { record_ }, offsets[i] );
+
+        file.getVar( "x" ).putVar( { xStart_ }, { nx }, toFloat( xCoord ).data() );
+        file.getVar( "y" ).putVar( { yStart_ }, { ny }, toFloat( yCoord ).data() );
+        for ( std::size_t i = 0; i < xValues.size(); i++ )
+            file.getVar( X_VARS[i].name ).putVar( { xStart_ }, { nx }, xValues[i].data() );
+        for ( std::size_t i = 0; i < yValues.size(); i++ )
+            file.getVar( Y_VARS[i].name ).putVar( { yStart_ }, { ny }, yValues[i].data() );
+        for ( std::size_t i = 0; i < cellValues.size(); i++ )
+            file.getVar( CELL_VARS[i].name ).putVar( { cellStart_ }, { nx * ny }, cellValues[i].data() );
+        for ( std::size_t i = 0; i < tValues.size(); i++ )
+            file.getVar( T_VARS[i].name ).putVar( { record_ }, tValues[i] );
+        file.getVar( "Overall size distribution" ).putVar( { record_, 0 }, { 1, nBin }, sizeDist.data() );
+
+        record_++;
+        xStart_ += nx;
+        yStart_ += ny;
+        cellStart_ += nx * ny;
+    }
+
+    TS_PhysWriter::TS_PhysWriter( std::size_t nBuffers ):
+        buffers_( std::max<std::size_t>( nBuffers, 1 ) )
+    {
+        for ( std::size_t i = buffers_.size(); i > 0; i-- )
+            free_.push_back( i - 1 );
+    }
+
+    TS_PhysWriter::~TS_PhysWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if ( thread_.joinable() )
+            thread_.join();
+        if ( error_ && !errorThrown_ ) {
+            try { std::rethrow_exception( error_ ); }
+            catch ( const std::exception& e ) { std::cout << "Failed writing time series: " << e.what() << std::endl; }
+            catch ( ... ) { std::cout << "Failed writing time series" << std::endl; }
+        }
+    }
+
+    void TS_PhysWriter::write( const char* rootName,
+                               const int hh, const int mm, const int ss,
+                               const AIM::Grid_Aerosol& iceAer, const Vector_2D& H2O,
+                               const Vector_1D& xCoord, const Vector_1D& yCoord,
+                               const Vector_1D& xEdges, const Vector_1D& yEdges,
+                               const Meteorology &met )
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait( lock, [this] { return !free_.empty() || error_; } );
+        rethrow();
+        const std::size_t iBuffer = free_.back();
+        free_.pop_back();
+        lock.unlock();
+
+        /* Copy assignment reuses the storage of the buffer when the grid has not grown */
+        Snapshot& snapshot = buffers_[iBuffer];
+        snapshot.rootName = rootName;
+        snapshot.hh = hh;
+        snapshot.mm = mm;
+        snapshot.ss = ss;
+        snapshot.iceAer = iceAer;
+        snapshot.H2O = H2O;
+        snapshot.xCoord = xCoord;
+        snapshot.yCoord = yCoord;
+        snapshot.xEdges = xEdges;
+        snapshot.yEdges = yEdges;
+        snapshot.met = met;
+
+        lock.lock();
+        queued_.push_back( iBuffer );
+        if ( !thread_.joinable() )
+            thread_ = std::thread( &TS_PhysWriter::run, this, Timing::Profile::current() );
+        lock.unlock();
+        cv_.notify_all();
+    }
+
+    void TS_PhysWriter::useSeries( std::unique_ptr<TS_PhysSeries> series )
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if ( thread_.joinable() )
+            throw std::logic_error( "TS_PhysWriter::useSeries called after the first write" );
+        series_ = std::move( series );
+    }
+
+    void TS_PhysWriter::flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait( lock, [this] { return ( queued_.empty() && !writing_ ) || error_; } );
+        rethrow();
+    }
+
+    void TS_PhysWriter::rethrow()
+    {
+        /* Called with mutex_ held. The writer thread stops at its first error */
+        if ( error_ ) {
+            errorThrown_ = true;
+            std::rethrow_exception( error_ );
+        }
+    }
+
+    void TS_PhysWriter::run( Timing::Profile* profile )
+    {
+        #ifdef OMP
+            /* Diagnostics run serially, the simulation keeps the threads */
+            omp_set_num_threads( 1 );
+        #endif /* OMP */
+        /* Time spent writing goes to the profile of the case */
+        std::optional<Timing::Profile::Active> timing;
+        if ( profile )
+            timing.emplace( *profile, "time series writer" );
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while ( true ) {
+            cv_.wait( lock, [this] { return !queued_.empty() || stop_; } );
+            if ( queued_.empty() )
+                return;
+            const std::size_t iBuffer = queued_.front();
+            queued_.erase( queued_.begin() );
+            writing_ = true;
+            lock.unlock();
+
+            const Snapshot& snapshot = buffers_[iBuffer];
+            std::exception_ptr error;
+            try {
+                Timing::Scope timer("Time series");
+                if ( series_ )
+                    series_->append( snapshot.hh, snapshot.mm, snapshot.ss,
+                                     snapshot.iceAer, snapshot.H2O, snapshot.xCoord, snapshot.yCoord,
+                                     snapshot.xEdges, snapshot.yEdges, snapshot.met );
+                else
+                    Diag_TS_Phys( snapshot.rootName.c_str(), snapshot.hh, snapshot.mm, snapshot.ss,
+                                  snapshot.iceAer, snapshot.H2O, snapshot.xCoord, snapshot.yCoord,
+                                  snapshot.xEdges, snapshot.yEdges, snapshot.met, diag_ );
+            }
+            catch ( ... ) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            writing_ = false;
+            free_.push_back( iBuffer );
+            cv_.notify_all();
+            if ( error ) {
+                error_ = error;
+                return;
+            }
+        }
+    }
+
 }
 
 /* End of Diag_Mod.cpp */
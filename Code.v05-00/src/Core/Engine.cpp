@@ -26,34 +26,29 @@ Engine::Engine( const char *engineName, std::string engineFileName, double tempe
 {
     Name = engineName;
 
-    std::ifstream engineFile;
-    OpenFile( engineFileName.c_str(), engineFile );
-    
-    std::string idle, approach, climbout, takeoff;
-    bool foundEngine;
-    
-    /* Get value at specific thrust settings from the EDB database */
-    foundEngine = GetEDB( engineFile, engineName, idle, approach, climbout, takeoff );
-    
-    if ( foundEngine == 0 ) {
+    /* The databank is parsed once per file and shared by all cases */
+    const EngineLTO *lto = EngineDatabase::load( engineFileName )->find( engineName );
+
+    if ( lto == nullptr ) {
         std::cout << "Engine " << engineName << " was not found in " << engineFileName << std::endl;
         return;
     }
 
-    CloseFile( engineFile );
-
-    /* Set fuelflow */
-    fuelflow = 0.8;
+    ComputeEI( *lto, tempe_K, pres_Pa, relHum_w, machNumber );
 
+} /* End of Engine::Engine */
 
-    std::string delimiter = ",";
+Engine::Engine( const std::string &engineName, const EngineLTO &lto, double tempe_K, double pres_Pa, double relHum_w, double machNumber )
+{
+    Name = engineName;
+    ComputeEI( lto, tempe_K, pres_Pa, relHum_w, machNumber );
 
-    ratedThrust.push_back(4);
-    LTO_fuelflow.push_back(4);
-    LTO_NOx.push_back(4);
-    LTO_CO.push_back(4);
-    LTO_HC.push_back(4);
+} /* End of Engine::Engine */
 
+void Engine::ComputeEI( const EngineLTO &lto, double tempe_K, double pres_Pa, double relHum_w, double machNumber )
+{
+    /* Set fuelflow */
+    fuelflow = 0.8;
 
     /* BOEING FUEL FLOW METHOD 2 (BFFM2) */
     /* See:
@@ -62,137 +57,21 @@ Engine::Engine( const char *engineName, std::string engineFileName, double tempe
      * Version 1.5, Technical Manual (2005)
      */
 
-    /* Conversion of uninstalled conditions to installed conditions */
-    /* Adjustment/correction factor for installation effects (engine air bleed) */
-    std::vector<double> fuelAdjustmentFactor = {1.100, 1.020, 1.013, 1.010};
-
-    std::vector<std::string> tokens;
-    std::string token;
-    std::istringstream tokenStream;
-
-    /* Idle */
-    tokenStream.str(idle);
-    while ( std::getline( tokenStream, token, delimiter.c_str()[0] ) )
-        tokens.push_back( token );
-  
-    ratedThrust[0]  = 0.07;
-    LTO_fuelflow[0] = std::stod(tokens[7]) * fuelAdjustmentFactor[0];
-    LTO_NOx[0]      = std::stod(tokens[4]);
-    LTO_CO[0]       = std::stod(tokens[2]);
-    LTO_HC[0]       = std::stod(tokens[3]);
-    tokens.clear();
-    tokenStream.clear();
-
-    /* Approach */
-    tokenStream.str(approach);
-    while ( std::getline( tokenStream, token, delimiter.c_str()[0] ) )
-        tokens.push_back( token );
-  
-    ratedThrust[1]  = 0.30;
-    LTO_fuelflow[1] = std::stod(tokens[7]) * fuelAdjustmentFactor[1];
-    LTO_NOx[1]      = std::stod(tokens[4]);
-    LTO_CO[1]       = std::stod(tokens[2]);
-    LTO_HC[1]       = std::stod(tokens[3]);
-    tokens.clear();
-    tokenStream.clear();
-
-    /* Climb out */
-    tokenStream.str(climbout);
-    while ( std::getline( tokenStream, token, delimiter.c_str()[0] ) )
-        tokens.push_back( token );
-  
-    ratedThrust[2]  = 0.70;
-    LTO_fuelflow[2] = std::stod(tokens[7]) * fuelAdjustmentFactor[2];
-    LTO_NOx[2]      = std::stod(tokens[4]);
-    LTO_CO[2]       = std::stod(tokens[2]);
-    LTO_HC[2]       = std::stod(tokens[3]);
-    tokens.clear();
-    tokenStream.clear();
-
-    /* Take off */
-    tokenStream.str(takeoff);
-    while ( std::getline( tokenStream, token, delimiter.c_str()[0] ) )
-        tokens.push_back( token );
-  
-    ratedThrust[3]  = 1.00;
-    LTO_fuelflow[3] = std::stod(tokens[7]) * fuelAdjustmentFactor[3];
-    LTO_NOx[3]      = std::stod(tokens[4]);
-    LTO_CO[3]       = std::stod(tokens[2]);
-    LTO_HC[3]       = std::stod(tokens[3]);
-    tokens.clear();
-    tokenStream.clear();
-
-    /* Check that all values are strictly positives */
+    /* Check that all values are strictly positives, the fits in lto use replacement values */
     for ( unsigned int i = 0; i < 4; i++ ) {
-        if ( LTO_fuelflow[i] <= 0.0 ) {
-            std::cout << "LTO_fuelflow is negative for engine: " << engineName << " LTO index: " << i << ", fuelflow: " << LTO_fuelflow[i] << std::endl;
-            LTO_fuelflow[i] = 0.1;
-        }
-        if ( LTO_NOx[i] <= 0.0 ) {
-            std::cout << "LTO_NOx is negative for engine: " << engineName << " LTO index: " << i << ", EI_NOx: " << LTO_NOx[i] << std::endl;
-            LTO_NOx[i] = 0.01;
-        }
-        if ( LTO_CO[i] <= 0.0 ) {
-            std::cout << "LTO_CO is negative for engine: " << engineName << " LTO index: " << i << ", EI_CO: " << LTO_CO[i] << std::endl;
-            LTO_CO[i] = 0.1;
-        }
-        if ( LTO_HC[i] <= 0.0 ) {
-            std::cout << "LTO_HC is negative for engine: " << engineName << " LTO index: " << i << ", EI_HC: " << LTO_HC[i] << std::endl;
-            LTO_CO[i] = 0.1;
-        }
+        if ( lto.LTO_fuelflow[i] <= 0.0 )
+            std::cout << "LTO_fuelflow is negative for engine: " << Name << " LTO index: " << i << ", fuelflow: " << lto.LTO_fuelflow[i] << std::endl;
+        if ( lto.LTO_NOx[i] <= 0.0 )
+            std::cout << "LTO_NOx is negative for engine: " << Name << " LTO index: " << i << ", EI_NOx: " << lto.LTO_NOx[i] << std::endl;
+        if ( lto.LTO_CO[i] <= 0.0 )
+            std::cout << "LTO_CO is negative for engine: " << Name << " LTO index: " << i << ", EI_CO: " << lto.LTO_CO[i] << std::endl;
+        if ( lto.LTO_HC[i] <= 0.0 )
+            std::cout << "LTO_HC is negative for engine: " << Name << " LTO index: " << i << ", EI_HC: " << lto.LTO_HC[i] << std::endl;
     }
 
-    /** Computing engine NOx emission index **/
-    /* Finding log-log relationship between fuelflow and EI_NOx */
-    std::vector<double> log_LTO_fuelflow(4);
-    std::vector<double> log_LTO_NOx(4);
-
-    std::vector<double> p(2); /* Parameters y = p(1)*x + p(2) */
-
-    /* (1) Compute logs */
-    for ( unsigned int i = 0; i < 4; i++ ) {
-        log_LTO_fuelflow[i] = log10( LTO_fuelflow[i] );
-        log_LTO_NOx[i]      = log10( LTO_NOx[i] );
-    }
-
-    /* (2) Build Vandermonde matrix */
-    std::vector<std::vector<double> > V{{log_LTO_fuelflow[0], 1.0},
-                                        {log_LTO_fuelflow[1], 1.0},
-                                        {log_LTO_fuelflow[2], 1.0},
-                                        {log_LTO_fuelflow[3], 1.0}};
-
-    /* (3) Some linear algebra magic */
-    std::vector<std::vector<double> > VV, invVV;
-    std::vector<double> vect(2);
-
-    for ( unsigned int i = 0; i < 2; i++ ) {
-        VV.push_back( std::vector<double>( 2 ) );
-        invVV.push_back( std::vector<double>( 2 ) );
-        for ( unsigned int j = 0; j < 2; j++ ) {
-            for ( unsigned int k = 0; k < 4; k++ )
-                VV[i][j] += V[k][i] * V[k][j];
-        }
-    }
-
-    double determinant = VV[0][0] * VV[1][1] - VV[0][1] * VV[1][0];
-    if ( abs(determinant) < 1E-20 )
+    if ( lto.singularNOxFit )
         std::cout << "Matrix is badly-scaled or singular" << std::endl;
 
-    invVV[0][0] =  VV[1][1] / determinant;
-    invVV[0][1] = -VV[0][1] / determinant;
-    invVV[1][0] = -VV[1][0] / determinant;
-    invVV[1][1] =  VV[0][0] / determinant;
-
-    for ( unsigned int i = 0; i < 2; i++ ) {
-        for ( unsigned int k = 0; k < 4; k++ )
-            vect[i] = vect[i] + V[k][i] * log_LTO_NOx[k];
-    }
-
-    for ( unsigned int i = 0; i < 2; i++ ) {
-        for ( unsigned int k = 0; k < 2; k++ )
-            p[i] += invVV[i][k] * vect[k];
-    }
-
     delta = pres_Pa / physConst::PRES_SL;
     theta = tempe_K / physConst::TEMP_SL;
 
@@ -201,7 +80,7 @@ Engine::Engine( const char *engineName, std::string engineFileName, double tempe
     
     /* Fuel flow rate converted to SLS-ISA conditions (installed engine) */
     fuelflow_factor = fuelflow / delta * pow( theta, 3.8 ) * exp( 0.2 * mach );
-    EI_NOx = pow( 10.0, log10( fuelflow_factor ) * p[0] + p[1] );
+    EI_NOx = pow( 10.0, log10( fuelflow_factor ) * lto.NOxFit[0] + lto.NOxFit[1] );
 
     /* Cruise correction for NOx */
     double beta, Pv, H;
@@ -232,74 +111,14 @@ Engine::Engine( const char *engineName, std::string engineFileName, double tempe
 
 
     /** Computing engine CO emission index **/
-    double line1, line2, line3, horzline, intercept;
-    
-    line1 = (log10( LTO_CO[1] ) - log10( LTO_CO[0] )) / ( log10( LTO_fuelflow[1] ) - log10( LTO_fuelflow[0]) );
-    line2 = log10( LTO_fuelflow[0] );
-    line3 = log10( LTO_CO[0] );
-
-    /* Horizontal line is bisect of two higher power values */
-    horzline = log10( LTO_CO[2] ) + log10( LTO_CO[3] ) / 2.0;
-
-    /* Find intercept of the two lines */
-    intercept = ( 2 * log10( LTO_fuelflow[0] ) * line1 + log10( LTO_CO[2] ) + log10( LTO_CO[3] ) - 2 * log10( LTO_CO[0]) ) / ( 2 * line1 );
-    
-    /* Intercept might be greater than 85% value, set intercept to be at 85% value (SAGE v1.5, Issue 1) */
-    if ( intercept > log10( LTO_fuelflow[2] ) ) 
-        intercept = log10( LTO_fuelflow[2] );
-    /* Intercept might be lower than 30% value, create horz line at the 30% value (SAGE v1.5, Issue 2) */
-    else if ( intercept < log10( LTO_fuelflow[1] ) && ( line1 < 0 ) ) {
-        horzline = log10( LTO_CO[1] );
-        intercept = log10( LTO_fuelflow[1] );
-    }
-    /* If the gradient of the slanted line is +ve, use horz line for all values (SAGE v1.5, Issue 3) */
-    else if ( line1 >= 0 ) {
-        line1 = 0;
-        line2 = 0;
-        line3 = horzline;
-        intercept = log10( LTO_fuelflow[1] );
-    }
-
-    if ( log10( fuelflow_factor ) < intercept  && fuelflow_factor > 0 )
-        EI_CO = pow( 10.0, line1 * ( log10(fuelflow_factor) - line2) + line3 );
-    else
-        EI_CO = pow( 10.0, horzline );
+    EI_CO = lto.COFit( fuelflow_factor );
 
     /* Cruise correction for CO */
     EI_CO *= pow( theta, 3.3 ) / pow(delta, 1.02 );
 
 
-    /** Computing engine CO emission index **/
-    line1 = (log10( LTO_HC[1] ) - log10( LTO_HC[0] )) / ( log10( LTO_fuelflow[1] ) - log10( LTO_fuelflow[0]) );
-    line2 = log10( LTO_fuelflow[0] );
-    line3 = log10( LTO_HC[0] );
-
-    /* Horizontal line is bisect of two higher power values */
-    horzline = log10( LTO_HC[2] ) + log10( LTO_HC[3] ) / 2.0;
-
-    /* Find intercept of the two lines */
-    intercept = ( 2 * log10( LTO_fuelflow[0] ) * line1 + log10( LTO_HC[2] ) + log10( LTO_HC[3] ) - 2 * log10( LTO_HC[0]) ) / ( 2 * line1 );
-
-    /* Intercept might be greater than 85% value, set intercept to be at 85% value (SAGE v1.5, Issue 1) */
-    if ( intercept > log10( LTO_fuelflow[2] ) )
-        intercept = log10( LTO_fuelflow[2] );
-    /* Intercept might be lower than 30% value, create horz line at the 30% value (SAGE v1.5, Issue 2) */
-    else if ( intercept < log10( LTO_fuelflow[1] ) && ( line1 < 0 ) ) {
-        horzline = log10( LTO_HC[1] );
-        intercept = log10( LTO_fuelflow[1] );
-    }
-    /* If the gradient of the slanted line is +ve, use horz line for all values (SAGE v1.5, Issue 3) */
-    else if ( line1 >= 0 ) {
-        line1 = 0;
-        line2 = 0;
-        line3 = horzline;
-        intercept = log10( LTO_fuelflow[1] );
-    }
-
-    if ( log10( fuelflow_factor ) < intercept  && fuelflow_factor > 0 )
-        EI_HC = pow( 10.0, line1 * ( log10(fuelflow_factor) - line2) + line3 );
-    else
-        EI_HC = pow( 10.0, horzline );
+    /** Computing engine HC emission index **/
+    EI_HC = lto.HCFit( fuelflow_factor );
 
     /* Cruise correction for HC */
     EI_HC *= pow( theta, 3.3 ) / pow(delta, 1.02 );
@@ -309,7 +128,7 @@ Engine::Engine( const char *engineName, std::string engineFileName, double tempe
     EI_Soot = 0.02; /* [g/kg fuel] */
     SootRad = 20.0E-09; /* [m] */
 
-} /* End of Engine::Engine */
+} /* End of Engine::ComputeEI */
 
 Engine::Engine( const Engine &e )
 {
@@ -358,57 +177,6 @@ Engine::~Engine( )
 
 } /* End of Engine::~Engine */
 
-void Engine::OpenFile( const char *fileName, std::ifstream &file )
-{
-    
-    file.open( fileName );
-
-    if ( !file ) {
-        std::string const currFunc("Engine::OpenFile");
-        std::cout << "ERROR: In " << currFunc << ": Cannot read (" << fileName << ")" << std::endl;
-        return;
-    }
-
-} /* End of Engine::OpenFile */
-
-void Engine::CloseFile( std::ifstream &file )
-{
-    file.close( );
-
-} /* End of Engine::CloseFile */
-
-bool Engine::GetEDB( std::ifstream &enginefile, const char *engineName, std::string &idle, std::string &approach, std::string &climbout, std::string &takeoff )
-{
-    
-    std::string search( engineName );
-    std::string delimiter = ",";
-
-    std::string endch(1,search.back());
-    if ( delimiter.compare(endch) != 0 )
-        search += delimiter;
-
-    size_t pos;
-    bool found = 0;
-    std::string line;
-    while ((enginefile.eof() == 0) && (found == 0)) {
-        getline( enginefile, line );
-        pos = line.find( search );
-        if ( pos != std::string::npos ) {
-            approach = line;
-            getline( enginefile, line );
-            climbout = line;
-            getline( enginefile, line );
-            takeoff = line;
-            getline( enginefile, line );
-            idle = line;
-            found = 1;
-        }
-    }
-
-    return found;
-
-} /* End of Engine::GetEDB */
-
 std::string Engine::getName() const
 {
 
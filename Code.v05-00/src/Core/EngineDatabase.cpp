@@ -0,0 +1,184 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* EngineDatabase Program File                                      */
+/*                                                                  */
+/* File                 : EngineDatabase.cpp                        */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include "Core/EngineDatabase.hpp"
+
+namespace {
+    std::mutex cacheMutex;
+    std::map<std::string, std::shared_ptr<const EngineDatabase>> cache;
+
+    std::vector<std::string> splitLine( const std::string& line ) {
+        std::vector<std::string> tokens;
+        std::string token;
+        std::istringstream tokenStream(line);
+        while ( std::getline( tokenStream, token, ',' ) )
+            tokens.push_back( token );
+        return tokens;
+    }
+}
+
+EngineLTO::EmissionIndexFit::EmissionIndexFit( const std::array<double, 4>& LTO_fuelflow, const std::array<double, 4>& LTO_EI )
+{
+    line1 = (log10( LTO_EI[1] ) - log10( LTO_EI[0] )) / ( log10( LTO_fuelflow[1] ) - log10( LTO_fuelflow[0]) );
+    line2 = log10( LTO_fuelflow[0] );
+    line3 = log10( LTO_EI[0] );
+
+    /* Horizontal line is bisect of two higher power values */
+    horzline = log10( LTO_EI[2] ) + log10( LTO_EI[3] ) / 2.0;
+
+    /* Find intercept of the two lines */
+    intercept = ( 2 * log10( LTO_fuelflow[0] ) * line1 + log10( LTO_EI[2] ) + log10( LTO_EI[3] ) - 2 * log10( LTO_EI[0]) ) / ( 2 * line1 );
+
+    /* Intercept might be greater than 85% value, set intercept to be at 85% value (SAGE v1.5, Issue 1) */
+    if ( intercept > log10( LTO_fuelflow[2] ) )
+        intercept = log10( LTO_fuelflow[2] );
+    /* Intercept might be lower than 30% value, create horz line at the 30% value (SAGE v1.5, Issue 2) */
+    else if ( intercept < log10( LTO_fuelflow[1] ) && ( line1 < 0 ) ) {
+        horzline = log10( LTO_EI[1] );
+        intercept = log10( LTO_fuelflow[1] );
+    }
+    /* If the gradient of the slanted line is +ve, use horz line for all values (SAGE v1.5, Issue 3) */
+    else if ( line1 >= 0 ) {
+        line1 = 0;
+        line2 = 0;
+        line3 = horzline;
+        intercept = log10( LTO_fuelflow[1] );
+    }
+}
+
+double EngineLTO::EmissionIndexFit::operator()( double fuelflow_factor ) const
+{
+    if ( log10( fuelflow_factor ) < intercept  && fuelflow_factor > 0 )
+        return pow( 10.0, line1 * ( log10(fuelflow_factor) - line2) + line3 );
+    else
+        return pow( 10.0, horzline );
+}
+
+void EngineLTO::computeFits()
+{
+    /* Same replacement values as the original Engine constructor, including
+     * the non-positive HC entry resetting the CO entry */
+    std::array<double, 4> fuelflow = LTO_fuelflow;
+    std::array<double, 4> NOx = LTO_NOx;
+    std::array<double, 4> CO = LTO_CO;
+    std::array<double, 4> HC = LTO_HC;
+    for ( unsigned int i = 0; i < 4; i++ ) {
+        if ( fuelflow[i] <= 0.0 ) fuelflow[i] = 0.1;
+        if ( NOx[i] <= 0.0 ) NOx[i] = 0.01;
+        if ( CO[i] <= 0.0 ) CO[i] = 0.1;
+        if ( HC[i] <= 0.0 ) CO[i] = 0.1;
+    }
+
+    /** Computing engine NOx emission index **/
+    /* Least squares fit of the log-log relationship between fuelflow and EI_NOx */
+    double VV[2][2] = {{0.0, 0.0}, {0.0, 0.0}};
+    double vect[2] = {0.0, 0.0};
+    for ( unsigned int k = 0; k < 4; k++ ) {
+        const double x = log10( fuelflow[k] );
+        const double y = log10( NOx[k] );
+        VV[0][0] += x * x;
+        VV[0][1] += x;
+        VV[1][0] += x;
+        VV[1][1] += 1.0;
+        vect[0] += x * y;
+        vect[1] += y;
+    }
+
+    double determinant = VV[0][0] * VV[1][1] - VV[0][1] * VV[1][0];
+    singularNOxFit = std::abs(determinant) < 1E-20;
+
+    const double invVV[2][2] = {{ VV[1][1] / determinant, -VV[0][1] / determinant},
+                                {-VV[1][0] / determinant,  VV[0][0] / determinant}};
+    NOxFit[0] = invVV[0][0] * vect[0] + invVV[0][1] * vect[1];
+    NOxFit[1] = invVV[1][0] * vect[0] + invVV[1][1] * vect[1];
+
+    COFit = EmissionIndexFit( fuelflow, CO );
+    HCFit = EmissionIndexFit( fuelflow, HC );
+}
+
+EngineDatabase::EngineDatabase( const std::string& fileName )
+{
+    std::ifstream engineFile( fileName );
+    if ( !engineFile ) {
+        std::cout << "ERROR: In EngineDatabase::EngineDatabase: Cannot read (" << fileName << ")" << std::endl;
+        return;
+    }
+
+    std::vector<std::string> lines;
+    std::string line;
+    while ( std::getline( engineFile, line ) )
+        lines.push_back( line );
+
+    /* Conversion of uninstalled conditions to installed conditions */
+    /* Adjustment/correction factor for installation effects (engine air bleed) */
+    const std::array<double, 4> fuelAdjustmentFactor = {1.100, 1.020, 1.013, 1.010};
+
+    /* Each engine has four consecutive lines, in order approach, climb out, take off and idle */
+    const std::array<unsigned int, 4> lineOffset = {3, 0, 1, 2};
+    for ( std::size_t iLine = 0; iLine + 3 < lines.size(); iLine++ ) {
+        const std::vector<std::string> first = splitLine( lines[iLine] );
+        if ( first.empty() || engines_.count( first[0] ) > 0 ) continue;
+
+        EngineLTO engine;
+        try {
+            for ( unsigned int i = 0; i < 4; i++ ) {
+                const std::vector<std::string> tokens = splitLine( lines[iLine + lineOffset[i]] );
+                engine.LTO_fuelflow[i] = std::stod(tokens.at(7)) * fuelAdjustmentFactor[i];
+                engine.LTO_NOx[i]      = std::stod(tokens.at(4));
+                engine.LTO_CO[i]       = std::stod(tokens.at(2));
+                engine.LTO_HC[i]       = std::stod(tokens.at(3));
+            }
+        }
+        catch ( std::exception& e ) {
+            /* Header or malformed entry */
+            continue;
+        }
+        engine.computeFits();
+        engines_.emplace( first[0], engine );
+        iLine += 3;
+    }
+}
+
+const EngineLTO* EngineDatabase::find( const std::string& engineName ) const
+{
+    /* Names may be given with the trailing delimiter, as for the former line search */
+    std::string key = engineName;
+    if ( !key.empty() && key.back() == ',' )
+        key.pop_back();
+
+    auto it = engines_.find( key );
+    return it == engines_.end() ? nullptr : &it->second;
+}
+
+std::shared_ptr<const EngineDatabase> EngineDatabase::load( const std::string& fileName )
+{
+    std::error_code ec;
+    const std::filesystem::path path = std::filesystem::absolute( fileName, ec );
+    const std::string key = ec ? fileName : path.lexically_normal().string();
+
+    /* Parsing the databank takes a few milliseconds, simply hold the lock meanwhile */
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(key);
+    if ( it != cache.end() )
+        return it->second;
+
+    auto database = std::make_shared<const EngineDatabase>( fileName );
+    cache.emplace( key, database );
+    return database;
+}
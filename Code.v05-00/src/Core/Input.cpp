@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include "Core/Input.hpp"
+#include "YamlInputReader/CaseSpace.hpp"
 
 Input::Input( unsigned int iCase,               \
               const Vector_2D &parameters,      \
@@ -123,6 +124,64 @@ Input::Input( unsigned int iCase,               \
 {
 
 }
+
+Input::Input( unsigned int iCase,               \
+              const YamlInputReader::CaseParameters &parameters, \
+              const std::string fileName,       \
+              const std::string fileName_ADJ,   \
+              const std::string fileName_BOX,   \
+              const std::string fileName_micro, \
+              const std::string author          ):
+    Case_          ( iCase                     ),
+    simulationTime_( parameters.simulationTime ),
+    temperature_K_ ( parameters.temperature_K  ),
+    relHumidity_w_ ( parameters.relHumidity_w  ),
+    horizDiff_     ( parameters.horizDiff      ),
+    vertiDiff_     ( parameters.vertiDiff      ),
+    shear_         ( parameters.shear          ),
+
+    longitude_deg_ ( parameters.longitude_deg  ),
+    latitude_deg_  ( parameters.latitude_deg   ),
+    pressure_Pa_   ( parameters.pressure_Pa    ),
+
+    emissionDOY_   ( parameters.emissionDOY    ),
+    emissionTime_  ( parameters.emissionTime   ),
+
+    EI_NOx_        ( parameters.EI_NOx         ),
+    EI_CO_         ( parameters.EI_CO          ),
+    EI_HC_         ( parameters.EI_HC          ),
+    EI_SO2_        ( parameters.EI_SO2         ),
+    EI_SO2TOSO4_   ( parameters.EI_SO2TOSO4    ),
+    EI_Soot_       ( parameters.EI_Soot        ),
+    sootRad_       ( parameters.sootRad        ),
+
+    fuelFlow_      ( parameters.fuelFlow       ),
+    aircraftMass_  ( parameters.aircraftMass   ),
+
+    backgNOx_      ( parameters.backgNOx       ),
+    backgHNO3_     ( parameters.backgHNO3      ),
+    backgO3_       ( parameters.backgO3        ),
+    backgCO_       ( parameters.backgCO        ),
+    backgCH4_      ( parameters.backgCH4       ),
+    backgSO2_      ( parameters.backgSO2       ),
+
+    flightSpeed_   ( parameters.flightSpeed    ),
+    numEngines_    ( parameters.numEngines     ),
+    wingspan_      ( parameters.wingspan       ),
+    coreExitTemp_  ( parameters.coreExitTemp   ),
+    bypassArea_    ( parameters.bypassArea     ),
+    fileName_      ( fileName ),
+    fileName_ADJ_  ( fileName_ADJ ),
+    fileName_BOX_  ( fileName_BOX ),
+    fileName_micro_ ( fileName_micro ),
+    author_        ( author ),
+
+    nBV_           ( parameters.nBV            )
+
+{
+
+}
+
 Input::~Input()
 {
 
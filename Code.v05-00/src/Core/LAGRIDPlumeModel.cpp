@@ -1,8 +1,17 @@
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include "AIM/Settling.hpp"
 #include "Util/PlumeModelUtils.hpp"
+#include "Util/BinaryIO.hpp"
+#include "Util/MC_Rand.hpp"
+#include "Util/Timing.hpp"
 #include "Core/Status.hpp"
 #include "Core/SZA.hpp"
+#include "Core/CaseScheduler.hpp"
 #include "Core/LAGRIDPlumeModel.hpp"
 
 LAGRIDPlumeModel::LAGRIDPlumeModel( const OptInput &optInput, const Input &input ):
@@ -13,7 +22,11 @@ LAGRIDPlumeModel::LAGRIDPlumeModel( const OptInput &optInput, const Input &input
     aircraft_(Aircraft(input, optInput.SIMULATION_INPUT_ENG_EI)),
     jetA_(Fuel("C12H24")),
     simVars_(MPMSimVarsWrapper(input, optInput)),
-    timestepVars_(TimestepVarsWrapper(input, optInput))
+    timestepVars_(TimestepVarsWrapper(input, optInput)),
+    rngKey_({getSeed(), input.Case()}),
+    diffusionSolver_(FVM_ANDS::diffusionSolverFromString(optInput.TRANSPORT_DIFFUSION_SOLVER)),
+    tracerDiffusionSolver_(FVM_ANDS::diffusionSolverFromString(optInput.TRANSPORT_TRACER_DIFFUSION_SOLVER)),
+    advectionScheme_(FVM_ANDS::advectionSchemeFromString(optInput.TRANSPORT_ADVECTION_SCHEME))
 {
     /* Multiply by 500 since it gets multiplied by 1/500 within the Emission object ... */ 
     jetA_.setFSC( input.EI_SO2() * 500.0 );
@@ -23,19 +36,46 @@ LAGRIDPlumeModel::LAGRIDPlumeModel( const OptInput &optInput, const Input &input
     timestepVars_.setTimeArray(PlumeModelUtils::BuildTime ( timestepVars_.tInitial_s, timestepVars_.tFinal_s, 3600.0*sun_.sunRise, 3600.0*sun_.sunSet, timestepVars_.dt ));
 
     createOutputDirectories();
+
+    if(tracerDiffusionSolver_ == FVM_ANDS::DiffusionSolver::Spectral) {
+        FVM_ANDS::setFFTWWisdom(optInput.SIMULATION_USE_FFTW_WISDOM, optInput.SIMULATION_DIRECTORY_W_WRITE_PERMISSION);
+    }
 }
 SimStatus LAGRIDPlumeModel::runFullModel() {
     auto start = std::chrono::high_resolution_clock::now();
-    omp_set_num_threads(numThreads_);
-    SimStatus EPM_RC = runEPM();
+    omp_set_num_threads(CaseScheduler::threadShare(numThreads_));
+    SimStatus EPM_RC;
+    {
+        Timing::Scope timer("EPM");
+        EPM_RC = runEPM();
+    }
     if(EPM_RC != SimStatus::EPMSuccess) {
         return EPM_RC;
     }
 
     //Initialize aerosol into grid and init H2O
-    initializeGrid();
-    initH2O();
-    saveTSAerosol();
+    {
+        Timing::Scope timer("Initialization");
+        initializeGrid();
+        initH2O();
+    }
+    /* Pick up where an interrupted run of this case left off, its initial state is already saved */
+    const bool CHECKPOINT = optInput_.SIMULATION_CHECKPOINT;
+    const bool resumed = CHECKPOINT && loadCheckpoint();
+    if ( simVars_.TS_AERO && optInput_.TS_AERO_SINGLE_FILE ) {
+        Diag::SeriesSettings settings;
+        settings.chunkSize = optInput_.TS_AERO_CHUNK_SIZE;
+        settings.deflateLevel = optInput_.TS_AERO_DEFLATE_LEVEL;
+        settings.shuffle = optInput_.TS_AERO_SHUFFLE;
+        settings.significantDigits = optInput_.TS_AERO_SIGNIFICANT_DIGITS;
+        /* A resumed run continues the series of the interrupted one */
+        tsWriter_.useSeries( std::make_unique<Diag::TS_PhysSeries>( Diag::seriesFileName( simVars_.TS_AERO_FILEPATH ), settings, resumed ) );
+    }
+    if ( !resumed ) {
+        saveTSAerosol();
+    }
+    auto lastCheckpoint = std::chrono::steady_clock::now();
+    const auto checkpointInterval = std::chrono::duration<double>( optInput_.SIMULATION_CHECKPOINT_INTERVAL * 60.0 );
 
     //Setup settling velocities
     if ( simVars_.GRAVSETTLING ) {
@@ -47,6 +87,9 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
     SimStatus status = SimStatus::Incomplete;
     //Start time loop
     while ( timestepVars_.curr_Time_s < timestepVars_.tFinal_s ) {
+        /* Take over the threads of cases that have finished meanwhile */
+        omp_set_num_threads(CaseScheduler::threadShare(numThreads_));
+
         /* Print message */
         std::cout << "\n";
         std::cout << "\n - Time step: " << timestepVars_.nTime + 1 << " out of " << timestepVars_.timeArray.size();
@@ -56,6 +99,7 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
         Vector_2D H2O_before_cocip, H2O_amb_after_cocip;
         MaskType numberMask_before_cocip, numberMask_after_cocip;
         if(COCIP_MIXING) {
+            Timing::Scope timer("CoCiP mixing");
             H2O_before_cocip = H2O_;
             numberMask_before_cocip = iceNumberMask();
         }
@@ -64,6 +108,7 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
         std::cout << "Running Transport" << std::endl;
         bool timeForTransport = (simVars_.TRANSPORT && (timestepVars_.nTime == 0 || timestepVars_.checkTimeForTransport()));
         if (timeForTransport) {
+            Timing::Scope timer("Transport");
             runTransport(timestepVars_.TRANSPORT_DT);
         }
 
@@ -72,12 +117,14 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
             tool used to tune the intensity of the simulated turbulence, but we can also just vary the amplitude.
         */
         if (simVars_.TEMP_PERTURB){
-            met_.updateTempPerturb();
+            Timing::Scope timer("Temperature perturbation");
+            met_.updateTempPerturb(rngKey_, timestepVars_.nTime);
         }
 
         solarTime_h_ = ( timestepVars_.curr_Time_s + timestepVars_.TRANSPORT_DT / 2 ) / 3600.0;
         simTime_h_ = ( timestepVars_.curr_Time_s + timestepVars_.TRANSPORT_DT / 2 - timestepVars_.timeArray[0] ) / 3600;
         if(COCIP_MIXING) {
+            Timing::Scope timer("CoCiP mixing");
             Meteorology met_temp = met_;
             met_temp.Update( timestepVars_.TRANSPORT_DT, solarTime_h_, simTime_h_);
             H2O_amb_after_cocip = met_temp.H2O_field();
@@ -89,6 +136,7 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
         if (simVars_.ICE_GROWTH && timestepVars_.checkTimeForIceGrowth()) {
             std::cout << "Running ice growth..." << std::endl;
             timestepVars_.lastTimeIceGrowth = timestepVars_.curr_Time_s + timestepVars_.dt;
+            Timing::Scope timer("Ice growth");
             iceAerosol_.Grow( timestepVars_.ICE_GROWTH_DT, H2O_, met_.Temp(), met_.Press());
         }
         // Vector_2D areas = VectorUtils::cellAreas(xEdges_, yEdges_);
@@ -97,7 +145,10 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
 
         //Perform Met Update, which includes the vertical advection and timestepping in other met variables
         std::cout << "Updating Met..." << std::endl;
-        met_.Update( timestepVars_.TRANSPORT_DT, solarTime_h_, simTime_h_);
+        {
+            Timing::Scope timer("Met update");
+            met_.Update( timestepVars_.TRANSPORT_DT, solarTime_h_, simTime_h_);
+        }
 
         //Vertical advection shifts the y coordinates which are synced to altitude, so we need to update the y edges and coordinates here too.
         yEdges_ = met_.yEdges();
@@ -105,7 +156,8 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
 
         // Update the tracer of contrail influence to include all locations where we have ice
         // Set it to 1 when there's at least 1 particle per m3 
-        auto number = iceAerosol_.TotalNumber();
+        diagnoseIce();
+        const Vector_2D& number = iceDiag_.number;
         for (std::size_t j=0; j<yCoords_.size(); j++){
             for (std::size_t i=0; i<xCoords_.size(); i++){
                 Contrail_[j][i] = std::max(0.0,std::min(1.0,Contrail_[j][i] + number[j][i]*1.0e6));
@@ -117,7 +169,11 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
         // WARNING: H2O approach may not work well with temperature
         // fluctuation field active
         //auto dataMask = H2OMask();
-        auto dataMask = ContrailMask(1.0e-2);
+        MaskType dataMask;
+        {
+            Timing::Scope timer("Mask");
+            dataMask = ContrailMask(1.0e-2);
+        }
         auto& mask = dataMask.first;
         auto& maskInfo = dataMask.second;
         if (maskInfo.count == 0){
@@ -129,12 +185,15 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
 
         //Remap the grid to account for changes in shape due to vertical advection and the growth of the contrail
         std::cout << "Remapping... " << std::endl;
-        remapAllVars(timestepVars_.TRANSPORT_DT, mask, maskInfo);
+        {
+            Timing::Scope timer("Remap");
+            remapAllVars(timestepVars_.TRANSPORT_DT, mask, maskInfo);
+        }
 
-        Vector_2D areas = VectorUtils::cellAreas(xEdges_, yEdges_);
-        double numparts = iceAerosol_.TotalNumber_sum(areas);
+        diagnoseIce();
+        double numparts = iceDiag_.totalNumber;
         std::cout << "Num Particles: " << numparts << std::endl;
-        std::cout << "Ice Mass: " << iceAerosol_.TotalIceMass_sum(areas) << std::endl;
+        std::cout << "Ice Mass: " << iceDiag_.totalIceMass << std::endl;
         if(numparts / initNumParts_ < 1e-5) {
             std::cout << "Less than 0.001% of the particles remain, stopping sim" << std::endl;
             EARLY_STOP = true;
@@ -150,6 +209,25 @@ SimStatus LAGRIDPlumeModel::runFullModel() {
             status = SimStatus::Complete;
             break;
         }
+
+        if ( CHECKPOINT && std::chrono::steady_clock::now() - lastCheckpoint >= checkpointInterval ) {
+            /* The time series up to the checkpoint must be on disk before it */
+            Timing::Scope timer("Checkpoint");
+            tsWriter_.flush();
+            saveCheckpoint();
+            lastCheckpoint = std::chrono::steady_clock::now();
+        }
+    }
+    {
+        Timing::Scope timer("Output");
+        tsWriter_.flush();
+        if(tracerDiffusionSolver_ == FVM_ANDS::DiffusionSolver::Spectral) {
+            FVM_ANDS::exportFFTWWisdom();
+        }
+    }
+    if ( CHECKPOINT ) {
+        std::error_code ec;
+        std::filesystem::remove( checkpointFileName(), ec );
     }
     auto stop = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop-start);
@@ -202,7 +280,7 @@ SimStatus LAGRIDPlumeModel::runEPM() {
     epmSolution.getData(VAR, FIX, i_0, j_0);
 
     //RUN EPM
-    EPM_result_ = EPM::Integrate(met_.tempRef(), simVars_.pressure_Pa, met_.rhwRef(), input_.bypassArea(), input_.coreExitTemp(), VAR, aerArray, aircraft_, EI_, simVars_.CHEMISTRY, optInput_.ADV_AMBIENT_LAPSERATE, input_.fileName_micro() );
+    EPM_result_ = EPM::ResultCache::Integrate(met_.tempRef(), simVars_.pressure_Pa, met_.rhwRef(), input_.bypassArea(), input_.coreExitTemp(), VAR, aerArray, aircraft_, EI_, simVars_.CHEMISTRY, optInput_.ADV_AMBIENT_LAPSERATE, input_.fileName_micro() );
     EPM::EPMOutput& epmOutput = EPM_result_.first;
     SimStatus EPM_RC = EPM_result_.second;
 
@@ -275,7 +353,7 @@ void LAGRIDPlumeModel::initializeGrid() {
     double rho_air = simVars_.pressure_Pa / (physConst::R_Air * epmOut.finalTemp);
     double B1 = optInput_.ADV_CSIZE_WIDTH_BASE + optInput_.ADV_CSIZE_WIDTH_SCALING_FACTOR * N_dil(aircraft_.vortex().t()) * m_F / ( physConst::PI/4 * rho_air * D1); // initial contrail width [m]
 
-    Vector_3D pdf_init;
+    Field_3D pdf_init(iceAerosol_.getNBin(), yCoords_.size(), xCoords_.size());
     
     //Initialize area assuming ellipse-like shape
     double initPlumeArea = EPM_result_.first.area;
@@ -293,26 +371,32 @@ void LAGRIDPlumeModel::initializeGrid() {
         double EPM_nPart_bin = epmIceAer.binMoment(n) * epmOut.area;
         double logBinRatio = log(iceAerosol_.getBinEdges()[n+1] / iceAerosol_.getBinEdges()[n]);
         //Start contrail at altitude -D1/2 to reflect the sinking.
-        pdf_init.push_back( LAGRID::initVarToGridGaussian(EPM_nPart_bin, xEdges_, yEdges_, 0, -D1/2, sigma_x, sigma_y, logBinRatio) );
-        //pdf_init.push_back( LAGRID::initVarToGridBimodalY(EPM_nPart_bin, xEdges_, yEdges_, 0, -D1/2, initWidth, initDepth, logBinRatio) );
+        pdf_init.setBin(n, LAGRID::initVarToGridGaussian(EPM_nPart_bin, xEdges_, yEdges_, 0, -D1/2, sigma_x, sigma_y, logBinRatio) );
+        //pdf_init.setBin(n, LAGRID::initVarToGridBimodalY(EPM_nPart_bin, xEdges_, yEdges_, 0, -D1/2, initWidth, initDepth, logBinRatio) );
     }
     iceAerosol_.updatePdf(std::move(pdf_init));
-    Vector_2D areas = VectorUtils::cellAreas(xEdges_, yEdges_);
-    initNumParts_ = iceAerosol_.TotalNumber_sum(areas);
+    diagnoseIce();
+    initNumParts_ = iceDiag_.totalNumber;
     std::cout << "EPM Num Particles: " << epmIceAer.Moment(0) * epmOut.area * 1e6 << std::endl;
     std::cout << "Initial Num Particles: " << initNumParts_ << std::endl;
-    std::cout << "Initial Ice Mass: " << iceAerosol_.TotalIceMass_sum(areas) << std::endl;
+    std::cout << "Initial Ice Mass: " << iceDiag_.totalIceMass << std::endl;
 
 }
 
+void LAGRIDPlumeModel::diagnoseIce() {
+    Timing::Scope timer("Diagnostics");
+    iceDiag_.full = false;
+    iceAerosol_.Diagnose(iceDiag_, VectorUtils::cellAreas(xEdges_, yEdges_), xCoords_, yCoords_, Vector_1D(), Vector_1D());
+}
+
 void LAGRIDPlumeModel::initH2O() {
     Contrail_ = Vector_2D(yCoords_.size(), Vector_1D(xCoords_.size()));
     H2O_ = met_.H2O_field();
 
     //Add emitted plume H2O. This function is called after releasing the initial crystals into the grid,
-    //so we can use that as a "mask" for where to emit the H2O.
+    //so we can use that as a "mask" for where to emit the H2O. initializeGrid already diagnosed their number.
 
-    auto maskInfo = VectorUtils::Vec2DMask(iceAerosol_.TotalNumber(), [](double val) { return val > 1e-4; } );
+    auto maskInfo = VectorUtils::Vec2DMask(iceDiag_.number, [](double val) { return val > 1e-4; } );
     auto& mask = maskInfo.first;
     int nonMaskCount = maskInfo. second;
 
@@ -345,7 +429,8 @@ void LAGRIDPlumeModel::updateDiffVecs() {
     // Update Diffusion
     PlumeModelUtils::DiffParam( timestepVars_.curr_Time_s - timestepVars_.tInitial_s + timestepVars_.TRANSPORT_DT / 2.0,
                                 dh_enhanced, dv_enhanced, input_.horizDiff(), input_.vertiDiff() );
-    auto number = iceAerosol_.TotalNumber();
+    //Transport runs first in the time step, iceDiag_ still holds the number from the end of the previous one
+    const Vector_2D& number = iceDiag_.number;
     auto num_max = VectorUtils::VecMax2D(number);
     
     diffCoeffX_ = Vector_2D(yCoords_.size(), Vector_1D(xCoords_.size()));
@@ -372,32 +457,37 @@ void LAGRIDPlumeModel::runTransport(double timestep) {
     shear_rep_ = met_.shear(maxIdx);
 
     const FVM_ANDS::AdvDiffParams fvmSolverInitParams(0, 0, shear_rep_, input_.horizDiff(), input_.vertiDiff(), timestepVars_.TRANSPORT_DT);
-    const FVM_ANDS::BoundaryConditions ZERO_BC_INIT = FVM_ANDS::bcFrom2DVector(iceAerosol_.getPDF()[0], true);
     updateDiffVecs();
+
+    //All transported fields share the grid, boundary conditions and shear,
+    //so a single batch solver (one point list, one diffusion matrix per diffusivity) handles all of them.
+    FVM_ANDS::FVM_BatchSolver solver(fvmSolverInitParams, xCoords_, yCoords_, ZERO_BC);
+    solver.updateTimestep(timestep);
+    solver.setDiffusionSolver(diffusionSolver_);
+    solver.setAdvectionScheme(advectionScheme_);
+
     //Transport the Ice Aerosol PDF
-    #pragma omp parallel for default(shared)
-    for ( UInt n = 0; n < iceAerosol_.getNBin(); n++ ) {
+    {
         /* Transport particle number and volume for each bin and
             * recompute centers of each bin for each grid cell
             * accordingly */
-        FVM_ANDS::FVM_Solver solver(fvmSolverInitParams, xCoords_, yCoords_, ZERO_BC_INIT, FVM_ANDS::std2dVec_to_eigenVec(H2O_));
-        //Update solver params
-        solver.updateTimestep(timestep);
         solver.updateDiffusion(diffCoeffX_, diffCoeffY_);
-        solver.updateAdvection(0, -vFall_[n], shear_rep_);
-
-        //passing in "false" to the "parallelAdvection" param to not spawn more threads
-        solver.operatorSplitSolve2DVec(iceAerosol_.getPDF_nonConstRef()[n], ZERO_BC, false);
+        Vector_1D vSettling(iceAerosol_.getNBin());
+        for ( UInt n = 0; n < iceAerosol_.getNBin(); n++ ) {
+            vSettling[n] = -vFall_[n];
+        }
+        //Bins are distributed over threads, advection within each bin is serial
+        Timing::Scope timer("Ice");
+        solver.operatorSplitSolve2DVec(iceAerosol_.getPDF_nonConstRef(), vSettling);
     }
 
+    //Dont use enhanced diffusion on the H2O and contrail tracer (and zero settling velocity)
+    solver.updateDiffusion(input_.horizDiff(), input_.vertiDiff());
+    solver.setDiffusionSolver(tracerDiffusionSolver_);
+
     //Transport H2O
     {   
-        //Dont use enhanced diffusion on the H2O (and zero settling velocity)
-        FVM_ANDS::FVM_Solver solver(fvmSolverInitParams, xCoords_, yCoords_, ZERO_BC_INIT, FVM_ANDS::std2dVec_to_eigenVec(H2O_));
-        solver.updateTimestep(timestep);
-        solver.updateDiffusion(input_.horizDiff(), input_.vertiDiff());
-        solver.updateAdvection(0, 0, shear_rep_);
-
+        Timing::Scope timer("H2O");
         // Calculate diffusion relative to a vertically-varying background H2O field
         // This prevents APCEMM from smoothing out pre-existing meteorological gradients
         // which will remain in the background/boundary conditions.
@@ -410,7 +500,7 @@ void LAGRIDPlumeModel::runTransport(double timestep) {
             }
         }
         // BC is zero, since we're calculating the difference relative to background.
-        solver.operatorSplitSolve2DVec(H2O_Delta, ZERO_BC);
+        solver.operatorSplitSolve2DVec(H2O_Delta);
         for (std::size_t j=0; j<yCoords_.size(); j++){
             for (std::size_t i=0; i<xCoords_.size(); i++){
                 H2O_[j][i] = H2O_Delta[j][i] + H2O_Background[j][i];
@@ -421,23 +511,17 @@ void LAGRIDPlumeModel::runTransport(double timestep) {
     //Transport the contrail tracer
     {   
         //Identical settings to H2O
-        FVM_ANDS::FVM_Solver solver(fvmSolverInitParams, xCoords_, yCoords_, ZERO_BC_INIT, FVM_ANDS::std2dVec_to_eigenVec(Contrail_));
-        solver.updateTimestep(timestep);
-        solver.updateDiffusion(input_.horizDiff(), input_.vertiDiff());
-        solver.updateAdvection(0, 0, shear_rep_);
-
-        solver.operatorSplitSolve2DVec(Contrail_, ZERO_BC);
+        Timing::Scope timer("Contrail tracer");
+        solver.operatorSplitSolve2DVec(Contrail_);
     }
 }
 
-std::pair<LAGRID::twoDGridVariable,LAGRID::twoDGridVariable> LAGRIDPlumeModel::remapVariable(const VectorUtils::MaskInfo& maskInfo, const BufferInfo& buffers, const Vector_2D& phi, const std::vector<std::vector<int>>& mask) {
-    double dy_grid_old = yCoords_[1] - yCoords_[0];
-    double dx_grid_old = xCoords_[1] - xCoords_[0];
-
+LAGRID::RemapOperator LAGRIDPlumeModel::remapOperator(const VectorUtils::MaskInfo& maskInfo, const BufferInfo& buffers, const std::vector<std::vector<int>>& mask) {
     // TODO: Add adaptive mesh size. This current implementation causes memory corruptions.
     // We need an extra grid cell on each side to avoid dealing with nasty indexing edge cases
     // if the boxes' and remapping's minX, maxX, minY, maxY are the same.
-    auto boxGrid = LAGRID::rectToBoxGrid(dy_grid_old, met_.dy_vec(), dx_grid_old, xEdges_[0], yEdges_[0], phi, mask);
+
+    double dx_grid_old = xCoords_[1] - xCoords_[0];
 
     //Enforce at least x many points in the contrail while limiting minimum/maximum dx and dy
     double dx_grid_new =  std::max(20.0, std::min((maskInfo.maxX - maskInfo.minX) / 50.0, 50.0));
@@ -447,22 +531,17 @@ std::pair<LAGRID::twoDGridVariable,LAGRID::twoDGridVariable> LAGRIDPlumeModel::r
     int ny_new = floor((maskInfo.maxY - maskInfo.minY) / dy_grid_new) + 2;
     LAGRID::Remapping remapping(maskInfo.minX - dx_grid_new, maskInfo.minY - dy_grid_new, dx_grid_new, dy_grid_new, nx_new, ny_new);
 
-    auto remappedGrid = LAGRID::mapToStructuredGrid(boxGrid, remapping);
-    auto unusedFraction = LAGRID::getUnusedFraction(boxGrid, remapping);
-
-    remappedGrid.addBuffer(buffers.leftBuffer, buffers.rightBuffer, buffers.topBuffer, buffers.botBuffer,0.0);
-    unusedFraction.addBuffer(buffers.leftBuffer, buffers.rightBuffer, buffers.topBuffer, buffers.botBuffer,1.0);
-
-    // std::cout << "remap successful" << std::endl;
-    return std::make_pair(remappedGrid,unusedFraction);
+    //The box-to-cell overlaps only depend on the mask and the grids, so they are computed once and shared by all remapped fields
+    return LAGRID::RemapOperator(met_.dy_vec(), dx_grid_old, xEdges_[0], yEdges_[0], mask, remapping,
+                                 buffers.leftBuffer, buffers.rightBuffer, buffers.topBuffer, buffers.botBuffer);
 }
 
 void LAGRIDPlumeModel::remapAllVars(double remapTimestep, const std::vector<std::vector<int>>& mask, const VectorUtils::MaskInfo& maskInfo) {
     //Generate free box grid from met post-advection
     //Vector_2D iceTotalNum = iceAerosol_.TotalNumber();
 
-    Vector_3D& pdfRef = iceAerosol_.getPDF_nonConstRef();
-    Vector_3D volume = iceAerosol_.Volume();
+    const Field_3D& pdfRef = iceAerosol_.getPDF();
+    Field_3D volume = iceAerosol_.Volume();
 
     double vertDiffLengthScale = sqrt(VectorUtils::VecMax2D(diffCoeffY_) * remapTimestep);
     double horizDiffLengthScale = sqrt(VectorUtils::VecMax2D(diffCoeffX_) * remapTimestep);
@@ -492,37 +571,34 @@ void LAGRIDPlumeModel::remapAllVars(double remapTimestep, const std::vector<std:
     buffers.botBuffer = std::min((vertDiffLengthScale + settlingLengthScale) * BOT_BUFFER_SCALING, 300.0);
     //std::cout << buffers.botBuffer << std::endl;
 
-    /* TODO: Benchmark various ways of parallelizing this section, mainly the volume calculation that requires a reduction */
-    #pragma omp parallel for default(shared)
-    for(UInt n = 0; n < iceAerosol_.getNBin(); n++) {
-        //Update pdf and volume
-        pdfRef[n] = remapVariable(maskInfo, buffers, pdfRef[n], mask).first.phi;
-        volume[n] = remapVariable(maskInfo, buffers, volume[n], mask).first.phi;
-    }
+    const LAGRID::RemapOperator remap = remapOperator(maskInfo, buffers, mask);
+    const std::size_t ny_new = remap.ny();
+    const std::size_t nx_new = remap.nx();
 
-    //Only update nx and ny of iceAerosol after the loop, otherwise functions will get messed up if we later add other calls in the loop above
-    iceAerosol_.updateNx(pdfRef[0][0].size());
-    iceAerosol_.updateNy(pdfRef[0].size());
+    //All bins are remapped at once
+    Field_3D volumeRemapped = remap.apply(volume);
+    iceAerosol_.updatePdf(remap.apply(pdfRef));
+    iceAerosol_.updateNx(nx_new);
+    iceAerosol_.updateNy(ny_new);
 
     //Recalculate VCenters
-    iceAerosol_.UpdateCenters(volume, pdfRef);
+    iceAerosol_.UpdateCenters(volumeRemapped, iceAerosol_.getPDF());
 
     //Remap the tracer of contrail presence
-    auto contrailRemap = remapVariable(maskInfo, buffers, Contrail_, mask).first;
-    Contrail_ = std::move(contrailRemap.phi);
+    Contrail_ = remap.apply(Contrail_);
     
-    //Remap H2O - but also return the fraction of each cell not written to
-    auto [H2ORemap,unusedFraction] = remapVariable(maskInfo, buffers, H2O_, mask);
-    H2O_ = std::move(H2ORemap.phi);
+    //Remap H2O - the fraction of each cell not written to is filled with met H2O below
+    H2O_ = remap.apply(H2O_);
+    const Vector_2D& unusedFraction = remap.unusedFraction().phi;
     
     //Need to update bottom-of-domain altitude before updating coordinates
-    double dy = H2ORemap.dy;
-    double dx = H2ORemap.dx;
+    double dy = remap.dy();
+    double dx = remap.dx();
     std::cout << "dx: " << dx << ", dy: " << dy << std::endl;
 
     //Update Coordinates
-    yCoords_ = std::move(H2ORemap.yCoords);
-    xCoords_ = std::move(H2ORemap.xCoords);
+    yCoords_ = remap.yCoords();
+    xCoords_ = remap.xCoords();
     yEdges_.resize(yCoords_.size() + 1);
     xEdges_.resize(xCoords_.size() + 1);
     std::generate(yEdges_.begin(), yEdges_.end(), [dy, this, j = 0.0]() mutable { return yCoords_[0] + dy*(j++ - 0.5); });
@@ -556,7 +632,7 @@ void LAGRIDPlumeModel::remapAllVars(double remapTimestep, const std::vector<std:
     int nx = H2O_[0].size();
     for(int j=0; j < ny; j++) {
         for(int i=0; i < nx; i++) {
-            H2O_[j][i] += std::max(0.0,unusedFraction.phi[j][i]) * met_H2O[j][i];
+            H2O_[j][i] += std::max(0.0,unusedFraction[j][i]) * met_H2O[j][i];
         }
     }
 }
@@ -643,14 +719,211 @@ void LAGRIDPlumeModel::saveTSAerosol() {
         (( simVars_.TS_AERO_FREQ == 0 ) || \
         ( std::fmod((timestepVars_.curr_Time_s - timestepVars_.timeArray[0])/60.0, simVars_.TS_AERO_FREQ) < MOD_EPS )) ) 
     {
+        Timing::Scope timer("Output");
         std::cout << "Saving aerosol data.." << std::endl;    
         int hh = (int) (timestepVars_.curr_Time_s - timestepVars_.timeArray[0])/3600;
         int mm = (int) (timestepVars_.curr_Time_s - timestepVars_.timeArray[0])/60   - 60 * hh;
         int ss = (int) (timestepVars_.curr_Time_s - timestepVars_.timeArray[0])      - 60 * ( mm + 60 * hh );
 
-        Diag::Diag_TS_Phys( simVars_.TS_AERO_FILEPATH.c_str(), hh, mm, ss, \
-                        iceAerosol_, H2O_, xCoords_, yCoords_, xEdges_, yEdges_, met_);
-        std::cout << "Save Complete" << std::endl;    
+        tsWriter_.write( simVars_.TS_AERO_FILEPATH.c_str(), hh, mm, ss, \
+                         iceAerosol_, H2O_, xCoords_, yCoords_, xEdges_, yEdges_, met_);
+    }
+
+}
+
+namespace {
+    const char CHECKPOINT_MAGIC[] = "APCEMM_LAGRID_CKPT";
+    const std::uint32_t CHECKPOINT_VERSION = 2;
+}
+
+std::string LAGRIDPlumeModel::checkpointFileName() const {
+    std::ostringstream fileName;
+    fileName << optInput_.SIMULATION_OUTPUT_FOLDER << "Checkpoint" << std::setw(6) << std::setfill('0') << input_.Case() << ".bin";
+    return fileName.str();
+}
+
+Vector_1D LAGRIDPlumeModel::checkpointKey() const {
+    return { input_.simulationTime(), input_.temperature_K(), input_.pressure_Pa(), input_.relHumidity_w(),
+             input_.horizDiff(), input_.vertiDiff(), input_.shear(), input_.nBV(),
+             input_.longitude_deg(), input_.latitude_deg(), double(input_.emissionDOY()), input_.emissionTime(),
+             input_.EI_Soot(), input_.sootRad(), input_.fuelFlow(), input_.aircraftMass(), input_.flightSpeed(),
+             input_.numEngines(), input_.wingspan(), input_.coreExitTemp(), input_.bypassArea(),
+             double(optInput_.ADV_GRID_NX), double(optInput_.ADV_GRID_NY),
+             optInput_.ADV_GRID_XLIM_LEFT, optInput_.ADV_GRID_XLIM_RIGHT,
+             optInput_.ADV_GRID_YLIM_DOWN, optInput_.ADV_GRID_YLIM_UP,
+             timestepVars_.dt, double(timestepVars_.timeArray.size()) };
+}
+
+void LAGRIDPlumeModel::saveCheckpoint() const {
+    const std::string fileName = checkpointFileName();
+    const std::string tmpFileName = fileName + ".tmp";
+    {
+        std::ofstream file( tmpFileName, std::ios::binary | std::ios::trunc );
+        if ( !file ) {
+            std::cout << "WARNING: could not write checkpoint " << tmpFileName << std::endl;
+            return;
+        }
+        file.write( CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC) );
+        BinaryIO::write( file, CHECKPOINT_VERSION );
+        BinaryIO::write( file, checkpointKey() );
+
+        BinaryIO::write( file, timestepVars_.curr_Time_s );
+        BinaryIO::write( file, timestepVars_.nTime );
+        BinaryIO::write( file, Vector_1D{ timestepVars_.lastTimeTransport, timestepVars_.lastTimeChem,
+                                          timestepVars_.lastTimeLiqCoag, timestepVars_.lastTimeIceCoag,
+                                          timestepVars_.lastTimeIceGrowth, timestepVars_.lastTimeTempPerturb } );
+        BinaryIO::write( file, Vector_1D{ timestepVars_.totalIceParticles_before, timestepVars_.totalIceMass_before,
+                                          timestepVars_.totalIceParticles_initial, timestepVars_.totalIceMass_initial,
+                                          timestepVars_.totalIceParticles_now, timestepVars_.totalIceMass_now,
+                                          timestepVars_.totalIceParticles_last, timestepVars_.totalIceMass_last,
+                                          timestepVars_.totalIceParticles_after, timestepVars_.totalIceMass_after,
+                                          timestepVars_.totPart_lost, timestepVars_.totIce_lost } );
+        BinaryIO::write( file, Vector_1D{ initNumParts_, simTime_h_, solarTime_h_, shear_rep_ } );
+        BinaryIO::write( file, rngKey_ );
+
+        BinaryIO::write( file, xCoords_ );
+        BinaryIO::write( file, xEdges_ );
+        BinaryIO::write( file, yCoords_ );
+        BinaryIO::write( file, yEdges_ );
+        BinaryIO::write( file, H2O_ );
+        BinaryIO::write( file, Contrail_ );
+        BinaryIO::write( file, diffCoeffX_ );
+        BinaryIO::write( file, diffCoeffY_ );
+
+        BinaryIO::write( file, iceAerosol_.getNx() );
+        BinaryIO::write( file, iceAerosol_.getNy() );
+        BinaryIO::write( file, iceAerosol_.getPDF() );
+        BinaryIO::write( file, iceAerosol_.getBinVCenters() );
+
+        met_.saveState( file );
+
+        if ( !file.flush() ) {
+            std::cout << "WARNING: could not write checkpoint " << tmpFileName << std::endl;
+            return;
+        }
+    }
+    /* Replace the previous checkpoint only once the new one is complete */
+    std::error_code ec;
+    std::filesystem::rename( tmpFileName, fileName, ec );
+    if ( ec ) {
+        std::cout << "WARNING: could not write checkpoint " << fileName << ": " << ec.message() << std::endl;
+        return;
+    }
+    std::cout << "Saved checkpoint " << fileName << std::endl;
+}
+
+bool LAGRIDPlumeModel::loadCheckpoint() {
+    Timing::Scope timer("Checkpoint");
+    const std::string fileName = checkpointFileName();
+    std::ifstream file( fileName, std::ios::binary );
+    if ( !file )
+        return false;
+
+    try {
+        char magic[sizeof(CHECKPOINT_MAGIC)];
+        std::uint32_t version;
+        Vector_1D key;
+        file.read( magic, sizeof(magic) );
+        BinaryIO::read( file, version );
+        BinaryIO::read( file, key );
+        if ( std::memcmp( magic, CHECKPOINT_MAGIC, sizeof(magic) ) != 0 || version != CHECKPOINT_VERSION ) {
+            std::cout << "WARNING: ignoring checkpoint " << fileName << " of unknown format" << std::endl;
+            return false;
+        }
+        if ( key != checkpointKey() ) {
+            std::cout << "WARNING: ignoring checkpoint " << fileName << " written with different inputs" << std::endl;
+            return false;
+        }
+
+        /* Read everything before touching the model state, a truncated file leaves it untouched */
+        double curr_Time_s;
+        int nTime;
+        Vector_1D lastTimes, totals, scalars;
+        Vector_1D xCoords, xEdges, yCoords, yEdges;
+        Vector_2D H2O, Contrail, diffCoeffX, diffCoeffY;
+        int nx, ny;
+        Field_3D pdf, binVCenters;
+        Philox::Key rngKey;
+        Meteorology met = met_;
+        BinaryIO::read( file, curr_Time_s );
+        BinaryIO::read( file, nTime );
+        BinaryIO::read( file, lastTimes );
+        BinaryIO::read( file, totals );
+        BinaryIO::read( file, scalars );
+        BinaryIO::read( file, rngKey );
+        BinaryIO::read( file, xCoords );
+        BinaryIO::read( file, xEdges );
+        BinaryIO::read( file, yCoords );
+        BinaryIO::read( file, yEdges );
+        BinaryIO::read( file, H2O );
+        BinaryIO::read( file, Contrail );
+        BinaryIO::read( file, diffCoeffX );
+        BinaryIO::read( file, diffCoeffY );
+        BinaryIO::read( file, nx );
+        BinaryIO::read( file, ny );
+        BinaryIO::read( file, pdf );
+        BinaryIO::read( file, binVCenters );
+        met.loadState( file );
+
+        const std::size_t nBin = iceAerosol_.getNBin();
+        if ( lastTimes.size() != 6 || totals.size() != 12 || scalars.size() != 4
+             || nx < 0 || ny < 0 || xCoords.size() != std::size_t(nx) || yCoords.size() != std::size_t(ny)
+             || xEdges.size() != xCoords.size() + 1 || yEdges.size() != yCoords.size() + 1
+             || H2O.size() != yCoords.size() || Contrail.size() != yCoords.size()
+             || pdf.nBin() != nBin || pdf.ny() != yCoords.size() || pdf.nx() != xCoords.size()
+             || binVCenters.nBin() != nBin || binVCenters.ny() != yCoords.size() || binVCenters.nx() != xCoords.size() ) {
+            throw std::runtime_error( "Inconsistent checkpoint" );
+        }
+
+        timestepVars_.curr_Time_s = curr_Time_s;
+        timestepVars_.nTime = nTime;
+        timestepVars_.lastTimeTransport = lastTimes[0];
+        timestepVars_.lastTimeChem = lastTimes[1];
+        timestepVars_.lastTimeLiqCoag = lastTimes[2];
+        timestepVars_.lastTimeIceCoag = lastTimes[3];
+        timestepVars_.lastTimeIceGrowth = lastTimes[4];
+        timestepVars_.lastTimeTempPerturb = lastTimes[5];
+        timestepVars_.totalIceParticles_before = totals[0];
+        timestepVars_.totalIceMass_before = totals[1];
+        timestepVars_.totalIceParticles_initial = totals[2];
+        timestepVars_.totalIceMass_initial = totals[3];
+        timestepVars_.totalIceParticles_now = totals[4];
+        timestepVars_.totalIceMass_now = totals[5];
+        timestepVars_.totalIceParticles_last = totals[6];
+        timestepVars_.totalIceMass_last = totals[7];
+        timestepVars_.totalIceParticles_after = totals[8];
+        timestepVars_.totalIceMass_after = totals[9];
+        timestepVars_.totPart_lost = totals[10];
+        timestepVars_.totIce_lost = totals[11];
+        initNumParts_ = scalars[0];
+        simTime_h_ = scalars[1];
+        solarTime_h_ = scalars[2];
+        shear_rep_ = scalars[3];
+        /* Draw the same perturbations as the interrupted run, even with a new seed */
+        rngKey_ = rngKey;
+
+        xCoords_ = std::move( xCoords );
+        xEdges_ = std::move( xEdges );
+        yCoords_ = std::move( yCoords );
+        yEdges_ = std::move( yEdges );
+        H2O_ = std::move( H2O );
+        Contrail_ = std::move( Contrail );
+        diffCoeffX_ = std::move( diffCoeffX );
+        diffCoeffY_ = std::move( diffCoeffY );
+
+        iceAerosol_.updateNx( nx );
+        iceAerosol_.updateNy( ny );
+        iceAerosol_.getPDF_nonConstRef() = std::move( pdf );
+        iceAerosol_.getBinVCenters_nonConstRef() = std::move( binVCenters );
+
+        met_ = std::move( met );
+    }
+    catch ( const std::runtime_error& e ) {
+        std::cout << "WARNING: ignoring checkpoint " << fileName << ": " << e.what() << std::endl;
+        return false;
     }
 
+    diagnoseIce();
+    std::cout << "Resuming from checkpoint " << fileName << " at time step " << timestepVars_.nTime + 1 << std::endl;
+    return true;
 }
@@ -19,6 +19,7 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <optional>
 #include <cstdio>
 #include <ctime>
 #include <filesystem>
@@ -29,14 +30,22 @@
 #include "YamlInputReader/YamlInputReader.hpp"
 #include "Core/Parameters.hpp"
 #include "Core/Input.hpp"
+#include "Core/EngineDatabase.hpp"
+#include "Core/CaseManifest.hpp"
+#include "Core/CaseScheduler.hpp"
+#include "Core/CaseSelection.hpp"
 #include "Core/LAGRIDPlumeModel.hpp"
+#include "EPM/ResultCache.hpp"
+#include "AIM/CoagulationTable.hpp"
 #include "Core/Status.hpp"
 #include "Util/MC_Rand.hpp"
+#include "Util/Timing.hpp"
 
 
 void CreateREADME( const std::string folder, const std::string fileName, \
                    const std::string purpose );
 void CreateStatusOutput(const std::string folder, const int caseNumber, const SimStatus status);
+void CreateTimingReport(const std::string folder, const int caseNumber, const SimStatus status, const Timing::Profile& profile);
 int PlumeModel( OptInput &Input_Opt, const Input &inputCase );
 
 inline bool exist( const std::string &name )
@@ -50,8 +59,13 @@ inline bool exist( const std::string &name )
 int main( int argc, char* argv[])
 {
 
-    std::vector<std::unordered_map<std::string, double> > parameters;
-    unsigned int iCase;
+    /* Cases are decoded from the parameter sweep when they are run */
+    YamlInputReader::CaseSpace caseSpace({});
+    /* Cases run by this job, all of them unless a shard or range is given */
+    CaseSelection caseSelection;
+    /* Cases already finished by earlier jobs */
+    CaseManifest manifest;
+    unsigned int iRun;
     // Help compiler tell this variable is initialized
     unsigned int nCases = 0;
     const unsigned int iOFFSET = 0;
@@ -81,13 +95,42 @@ int main( int argc, char* argv[])
      *                  +
      *              Plume Model
      */
-    if(argc < 2){
-        std::cout << "No Input File Detected!" << std::endl;
-        std::cout << "Exiting ... " << std::endl;
-        return 1;
+    /*
+     * Usage: APCEMM input.yaml [--shard i/N] [--cases first:last]
+     *
+     * --shard i/N        -> Run cases i, i+N, i+2N, ...
+     * --cases first:last -> Run cases first to last-1
+     *
+     * Both options may be combined to split a sweep over several jobs
+     */
+    std::string inputFileName;
+    for ( int iArg = 1; iArg < argc; iArg++ ) {
+        const std::string arg = argv[iArg];
+        if ( ( arg == "--shard" || arg == "--cases" ) && iArg + 1 < argc ) {
+            try {
+                if ( arg == "--shard" )
+                    caseSelection.setShard( argv[++iArg] );
+                else
+                    caseSelection.setRange( argv[++iArg] );
+            }
+            catch ( const std::invalid_argument& e ) {
+                std::cout << e.what() << std::endl;
+                std::cout << "Exiting ... " << std::endl;
+                return 1;
+            }
+        }
+        else if ( inputFileName.empty() && arg.rfind( "--", 0 ) != 0 ) {
+            inputFileName = arg;
+        }
+        else {
+            std::cout << "Unexpected Input: " << arg << std::endl;
+            std::cout << "Usage: " << argv[0] << " input.yaml [--shard i/N] [--cases first:last]" << std::endl;
+            std::cout << "Exiting ... " << std::endl;
+            return 1;
+        }
     }
-    else if(argc > 2){
-        std::cout << "Unexpected Input: " << argv[2] << std::endl;
+    if(inputFileName.empty()){
+        std::cout << "No Input File Detected!" << std::endl;
         std::cout << "Exiting ... " << std::endl;
         return 1;
     }
@@ -95,17 +138,17 @@ int main( int argc, char* argv[])
     #pragma omp master
     {
         std::string FILESEP = "/";
-        std::string FILENAME = argv[1];
+        std::string FILENAME = inputFileName;
         std::filesystem::path INPUT_FILE_PATH(FILENAME);
         INPUT_FILE_PATH = std::filesystem::canonical(INPUT_FILE_PATH);
 
         YamlInputReader::readYamlInputFile( Input_Opt, INPUT_FILE_PATH.generic_string() );
 
         /* Collect parameters and create cases */
-        parameters = YamlInputReader::generateCases( Input_Opt );
+        caseSpace = YamlInputReader::CaseSpace( Input_Opt.PARAMETER_PARAM_MAP );
 
         /* Number of cases */
-        nCases  = parameters.size();
+        nCases  = caseSpace.size();
         
         /* Ensure cases were created properly */
         if (nCases == 0)
@@ -137,6 +180,18 @@ int main( int argc, char* argv[])
             CreateREADME( Input_Opt.SIMULATION_OUTPUT_FOLDER, "README", description );
 
         }
+
+        /* Finished cases of earlier runs into this folder, from any shard */
+        manifest = CaseManifest( Input_Opt.SIMULATION_OUTPUT_FOLDER );
+
+        /* Parse the engine emissions databank once, all cases look their engine up in it */
+        EngineDatabase::load( Input_Opt.SIMULATION_INPUT_ENG_EI );
+
+        /* Cases sharing their early plume inputs reuse the first EPM result */
+        EPM::ResultCache::configure( Input_Opt.SIMULATION_EPM_CACHE, Input_Opt.SIMULATION_EPM_CACHE_FOLDER );
+
+        /* Exact coagulation kernels unless tables are requested */
+        AIM::CoagulationTable::configure( Input_Opt.AEROSOL_COAGULATION_TABLE );
     } /* master CPU */
 
     /* ====================================================================== */
@@ -163,14 +218,28 @@ int main( int argc, char* argv[])
     // }
 
     //PARALLEL_CASES = Input_Opt.SIMULATION_PARAMETER_SWEEP;
+    const bool parallelCases = PARALLEL_CASES || Input_Opt.SIMULATION_PARALLEL_CASES;
+
+    /* Parallel loops inside a case use the threads not taken by the other running cases */
+    if ( parallelCases && !PARALLEL_CASES )
+        omp_set_max_active_levels( 2 );
+
+    const CaseScheduler caseOrder( caseSpace, Input_Opt.MET_LOADMET, parallelCases, caseSelection );
+    const unsigned int nRuns = caseOrder.size();
+    std::cout << "\n Running " << nRuns << " of " << nCases << " cases";
+    if ( manifest.size() > 0 && !Input_Opt.SIMULATION_OVERWRITE )
+        std::cout << ", skipping those among the " << manifest.size() << " finished cases in " << CaseManifest::FILENAME;
+    std::cout << std::endl;
 
     /* ====================================================================== */
     /* ---- CASE LOOP STARTS HERE ------------------------------------------- */
     /* ====================================================================== */
 
-    #pragma omp parallel for schedule(dynamic, 1) shared(Input_Opt, parameters, nCases) if( PARALLEL_CASES )
-    for ( iCase = 0; iCase < nCases; iCase++ ) {
+    #pragma omp parallel for schedule(dynamic, 1) shared(Input_Opt, caseSpace, caseOrder, manifest, nRuns) \
+        num_threads( Input_Opt.SIMULATION_OMP_NUM_THREADS ) if( parallelCases )
+    for ( iRun = 0; iRun < nRuns; iRun++ ) {
 
+        const unsigned int iCase = caseOrder[iRun];
         unsigned int jCase = iOFFSET + iCase;
 
         std::string fullPath, fullPath_ADJ, fullPath_BOX, fullPath_micro, jCaseString;
@@ -187,14 +256,18 @@ int main( int argc, char* argv[])
         fullPath_BOX   = Input_Opt.SIMULATION_OUTPUT_FOLDER + file_BOX;
         fullPath_micro = Input_Opt.SIMULATION_OUTPUT_FOLDER + file_micro;
 
-        bool fileExist = 0;
-
-        if ( Input_Opt.SIMULATION_ADJOINT ) {
-            #pragma omp critical
-            { fileExist = exist( fullPath_ADJ ); }
-        } else {
-            #pragma omp critical
-            { fileExist = exist( fullPath ); }
+        /* Cases finished by earlier jobs are in the manifest, the output file check
+         * covers folders written before the manifest existed */
+        bool fileExist = manifest.finished( iCase );
+
+        if ( !fileExist ) {
+            if ( Input_Opt.SIMULATION_ADJOINT ) {
+                #pragma omp critical
+                { fileExist = exist( fullPath_ADJ ); }
+            } else {
+                #pragma omp critical
+                { fileExist = exist( fullPath ); }
+            }
         }
 
         // Hardcode for now
@@ -202,7 +275,9 @@ int main( int argc, char* argv[])
 
         if ( !fileExist || Input_Opt.SIMULATION_OVERWRITE ) {
 
-            const Input inputCase( iCase, parameters, \
+            const CaseScheduler::RunningCase runningCase;
+
+            const Input inputCase( iCase, caseSpace.parameters( iCase ), \
                                    fullPath,          \
                                    fullPath_ADJ,      \
                                    fullPath_BOX,      \
@@ -217,7 +292,15 @@ int main( int argc, char* argv[])
                 #endif /* OMP */
                 std::cout << "" << std::endl;
             }
-            Input_Opt.TS_AERO_FILENAME = "ts_aerosol_case" + std::to_string(iCase) + "_hhmm.nc";
+            /* Cases may run concurrently, keep case-specific options out of the shared object */
+            OptInput caseOpt = Input_Opt;
+            caseOpt.TS_AERO_FILENAME = "ts_aerosol_case" + std::to_string(iCase) + "_hhmm.nc";
+
+            /* Phases of the case are timed while the profile is active */
+            Timing::Profile profile;
+            std::optional<Timing::Profile::Active> timing;
+            if ( Input_Opt.SIMULATION_TIMING_REPORT )
+                timing.emplace( profile, "case" );
 
             SimStatus case_status;
             switch (model) {
@@ -231,7 +314,7 @@ int main( int argc, char* argv[])
                 /* Plume Model (APCEMM) */
                 case 1: {
                     std::cout << "running epm... " << std::endl;
-                    LAGRIDPlumeModel LAGRID_Model(Input_Opt, inputCase);
+                    LAGRIDPlumeModel LAGRID_Model(caseOpt, inputCase);
                     case_status = LAGRID_Model.runFullModel();
                     // iERR = PlumeModel( Input_Opt, inputCase );
                     break;
@@ -291,6 +374,11 @@ int main( int argc, char* argv[])
                 CreateStatusOutput(Input_Opt.SIMULATION_OUTPUT_FOLDER, iCase, case_status);
             }
 
+            if ( Input_Opt.SIMULATION_TIMING_REPORT ) {
+                timing.reset();
+                CreateTimingReport(Input_Opt.SIMULATION_OUTPUT_FOLDER, iCase, case_status, profile);
+            }
+
         }
 
     }
@@ -300,6 +388,8 @@ int main( int argc, char* argv[])
     /* ====================================================================== */
    
     std::cout << "\n All cases have been completed!" << std::endl;
+    if ( Input_Opt.SIMULATION_EPM_CACHE )
+        std::cout << " " << EPM::ResultCache::summary() << std::endl;
 
     /* ====================================================================== */
     /* ---- END NORMALLY ---------------------------------------------------- */
@@ -398,34 +488,29 @@ void CreateStatusOutput(const std::string folder, const int caseNumber, const Si
 
     const std::string fullPath = folder + "/" + fileName;
     statusFile.open( fullPath.c_str() );
-
-    switch (status)
-    {
-    case SimStatus::Complete:
-        statusFile << "Complete" << std::endl;
-        break;
-    case SimStatus::Incomplete:
-        statusFile << "Incomplete" << std::endl;
-        break;
-    case SimStatus::NoWaterSaturation:
-        statusFile << "NoWaterSaturation" << std::endl;
-        break;
-    case SimStatus::NoPersistence:
-        statusFile << "NoPersistence" << std::endl;
-        break;
-    case SimStatus::NoSurvivalVortex:
-        statusFile << "NoSurvivalVortex" << std::endl;
-        break;
-    case SimStatus::Failed:
-        statusFile << "Failed" << std::endl;
-        break;
-    default:
-        statusFile << "Unknown exit code" << std::endl;
-        break;
-    }
-
+    statusFile << statusName( status ) << std::endl;
     statusFile.close();
 
+    /* Record the case once its status file is written */
+    CaseManifest::append( folder, caseNumber, status );
+
 } /* End of CreateStatusOutput */
 
+void CreateTimingReport(const std::string folder, const int caseNumber, const SimStatus status, const Timing::Profile& profile)
+{
+    int thread = 0;
+    #ifdef OMP
+        thread = omp_get_thread_num();
+    #endif /* OMP */
+
+    const std::string fullPath = folder + "/timing_case" + std::to_string(caseNumber) + ".json";
+    std::ofstream reportFile( fullPath.c_str() );
+    profile.writeJSON( reportFile, { { "case", std::to_string(caseNumber) },
+                                     { "status", Timing::quote( statusName( status ) ) },
+                                     { "sweep_thread", std::to_string(thread) } } );
+    if ( !reportFile )
+        std::cout << " Could not write timing report " << fullPath << std::endl;
+
+} /* End of CreateTimingReport */
+
 /* End of Main.cpp */
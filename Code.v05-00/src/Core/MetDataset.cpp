@@ -0,0 +1,134 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* MetDataset Program File                                          */
+/*                                                                  */
+/* File                 : MetDataset.cpp                            */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <netcdf>
+#include "Core/MetDataset.hpp"
+#include "Core/NetCDFMutex.hpp"
+
+using namespace netCDF;
+using namespace netCDF::exceptions;
+
+namespace {
+    /* Met variables read by Meteorology, loaded when present in the file */
+    const std::string MET_VARIABLES[] = {"temperature", "relative_humidity_ice", "shear", "w"};
+
+    std::mutex cacheMutex;
+    std::map<std::string, std::shared_future<std::shared_ptr<const MetDataset>>> cache;
+
+    std::string cacheKey( const std::string& fileName ) {
+        std::error_code ec;
+        std::filesystem::path path = std::filesystem::absolute(fileName, ec);
+        return ec ? fileName : path.lexically_normal().string();
+    }
+}
+
+MetDataset::MetDataset( const std::string& fileName )
+{
+    std::lock_guard<std::mutex> lock(netCDFMutex());
+
+    /*
+        Met data format:
+        2 dimensions: altitude and time
+        RHw, Temp, Shear given as time series.
+    */
+    NcFile dataFile;
+    int altitudeDim = 0;
+    try {
+        dataFile.open( fileName.c_str(), NcFile::read );
+        altitudeDim = dataFile.getDim("altitude").getSize();
+        timeDim_ = dataFile.getDim("time").getSize();
+
+        altitude_.resize(altitudeDim);
+        pressure_.resize(altitudeDim);
+        dataFile.getVar("altitude").getVar(altitude_.data());
+        dataFile.getVar("pressure").getVar(pressure_.data());
+    }
+    catch (NcException& e) {
+        throw std::runtime_error("Could not parse altitude and pressure data from met input file " + fileName);
+    }
+
+    for (int i = 0; i < altitudeDim; i++ ) {
+        pressure_[i] *= 100.0; //convert from hPa to Pa
+        altitude_[i] *= 1000.0; //convert from km to m
+    }
+
+    for ( const std::string& varName: MET_VARIABLES ) {
+        try {
+            NcVar ncvar = dataFile.getVar(varName.c_str());
+            if ( ncvar.isNull() ) continue;
+
+            Variable& var = variables_[varName];
+            var.supportsTimeseries = ncvar.getDimCount() == 2;
+            const int nTime = var.supportsTimeseries ? timeDim_ : 1;
+            Vector_1D flat(altitudeDim * nTime); //flattened array to hold values for all altitude and time
+            ncvar.getVar(flat.data());
+
+            var.data = Vector_2D(altitudeDim);
+            for ( int i = 0; i < altitudeDim; i++ ) {
+                var.data[i].assign(flat.begin() + i*nTime, flat.begin() + (i + 1)*nTime);
+            }
+        }
+        catch (NcException& e) {
+            throw std::runtime_error("Could not parse " + varName + " data from met input file " + fileName);
+        }
+    }
+}
+
+const MetDataset::Variable& MetDataset::variable( const std::string& varName ) const {
+    auto it = variables_.find(varName);
+    if ( it == variables_.end() ) {
+        throw std::runtime_error("Variable \"" + varName + "\" not found in met input file!");
+    }
+    return it->second;
+}
+
+std::shared_ptr<const MetDataset> MetDataset::load( const std::string& fileName ) {
+    const std::string key = cacheKey(fileName);
+    std::promise<std::shared_ptr<const MetDataset>> promise;
+    std::shared_future<std::shared_ptr<const MetDataset>> pending;
+    bool firstRequest = false;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cache.find(key);
+        if ( it == cache.end() ) {
+            pending = promise.get_future().share();
+            cache.emplace(key, pending);
+            firstRequest = true;
+        }
+        else {
+            pending = it->second;
+        }
+    }
+    /* Wait outside of the lock, so other files can be requested meanwhile */
+    if ( !firstRequest ) return pending.get();
+
+    try {
+        auto dataset = std::make_shared<const MetDataset>(fileName);
+        promise.set_value(dataset);
+        return dataset;
+    }
+    catch (...) {
+        /* Waiting callers get the error, later calls retry the read */
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache.erase(key);
+        throw;
+    }
+}
+
+void MetDataset::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.clear();
+}
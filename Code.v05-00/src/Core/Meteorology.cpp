@@ -12,8 +12,10 @@
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
 #include <algorithm>
+#include <iostream>
 #include "Util/PhysFunction.hpp"
 #include "Util/PhysConstant.hpp"
+#include "Util/BinaryIO.hpp"
 #include "Core/Parameters.hpp"
 #include "Core/Meteorology.hpp"
 #include "Util/MC_Rand.hpp"
@@ -75,48 +77,17 @@ Meteorology::Meteorology( const OptInput &optInput,
 
     diurnalPert_ = diurnalAmplitude_ * cos( 2.0E+00 * physConst::PI * ( ambParams_.solarTime_h - diurnalPhase_ ) / 24.0E+00 );
 
-    //Declare met input file here, keeps ownership of file to constructor only.
-    //Dont want to deal with using a ptr and worry about what functions deference it.
-    NcFile dataFile;
+    //The met file is read once per process and shared with every other case using it.
+    //Parsing errors are reported by MetDataset.
     if( optInput.MET_LOADMET ) {
-        dataFile.open( optInput.MET_FILENAME.c_str(), NcFile::read );
-    }
-
-    try {
-        initAltitudeAndPress( dataFile );
-    }
-    catch (NcException& e) {
-        throw std::runtime_error("Could not parse altitude and pressure data from specified met input file");
-    }
-
-    try {
-        initTemperature( dataFile );
-    }
-    catch (NcException& e) {
-        throw std::runtime_error("Could not parse temperature data from specified met input file");
-    }
-
-    try {
-        initH2O( dataFile, optInput );
-    }
-    catch (NcException& e) {
-        throw std::runtime_error("Could not parse relative humidity data from specified met input file");
-    }
-
-    try {
-        initShear( dataFile );
-    }
-    catch (NcException& e) {
-        throw std::runtime_error("Could not parse shear data from specified met input file");
-    }
-
-    try {
-        initVertVeloc( dataFile );
-    }
-    catch (NcException& e) {
-        throw std::runtime_error("Could not parse vertical velocity data from specified met input file");
+        metData_ = MetDataset::load( optInput.MET_FILENAME );
     }
 
+    initAltitudeAndPress();
+    initTemperature();
+    initH2O( optInput );
+    initShear();
+    initVertVeloc();
 
     double invkB = 1.00E-06 / physConst::kB;
 
@@ -234,7 +205,7 @@ void Meteorology::Update( const double dt, const double solarTime_h, \
     updateAirMolecDens();
 } /* End of Meteorology::UpdateMet */
 
-void Meteorology::initAltitudeAndPress( const NcFile& dataFile ) {
+void Meteorology::initAltitudeAndPress() {
     //Must call this before the other initialize functions!
     if( !useMetFileInput_ ) {
             
@@ -251,31 +222,9 @@ void Meteorology::initAltitudeAndPress( const NcFile& dataFile ) {
         return;
     }
 
-    /*
-        Met data format:
-        2 dimensions: altitude and time
-        RHw, Temp, Shear given as time series.
-    */
-
-    /* Identify the length of variables in input file */
-    altitudeDim_ = dataFile.getDim("altitude").getSize();
-    timeDim_ = dataFile.getDim("time").getSize();
-
-    /* Extract pressure and altitude from input file. */
-    altitudeInit_.resize(altitudeDim_);
-    pressureInit_.resize(altitudeDim_);
-
-    //The netcdf API is garbage and makes you pass in a C style array despite being branded as a "C++" library
-    NcVar altitude_ncVar = dataFile.getVar("altitude");
-    NcVar pressure_ncVar = dataFile.getVar("pressure");
-    altitude_ncVar.getVar(altitudeInit_.data());
-    pressure_ncVar.getVar(pressureInit_.data());
-
-    //Cache initial pressure and altitude values for generating later met vars.
-    for (int i = 0; i < altitudeDim_; i++ ) {
-        pressureInit_[i] *= 100.0; //convert from hPa to Pa
-        altitudeInit_[i] *= 1000.0; //convert from km to m
-    }
+    altitudeDim_ = metData_->altitudeDim();
+    timeDim_ = metData_->timeDim();
+    altitudeInit_ = metData_->altitude();
 
     for ( int j = 0; j < ny_; j++ ) {
         altitude_[j] = altitudeRef_ + yCoords_[j];
@@ -289,29 +238,12 @@ void Meteorology::initAltitudeAndPress( const NcFile& dataFile ) {
     i_Zp_ = met::nearestNeighbor( pressure_, pressureRef_); 
 }
 
-void Meteorology::readMetVar( const NcFile& dataFile, std::string varName, Vector_2D& vec_ts, bool timeseries) {
-    NcVar ncvar = dataFile.getVar(varName.c_str());
-    bool supportsTimeseries = ncvar.getDimCount() == 2;
-    if( !supportsTimeseries && timeseries ) {
+const Vector_2D* Meteorology::readMetVar( const std::string& varName, bool timeseries ) const {
+    const MetDataset::Variable& var = metData_->variable(varName);
+    if( !var.supportsTimeseries && timeseries ) {
         throw std::runtime_error("Variable\"" + varName + "\" in met input file does not support time series input! Please set the corresponding time series input option to false.");
     }
-    int dataLength = supportsTimeseries ? altitudeDim_ * timeDim_ : altitudeDim_;
-    double data[dataLength]; //flattened array to hold values for all altitude and time
-    ncvar.getVar(data);
-
-    vec_ts = Vector_2D(altitudeDim_, Vector_1D(timeDim_, 0));
-    
-
-    for ( int i = 0; i < altitudeDim_; i++ ) {
-        for ( int itime = 0; itime < timeDim_; itime++ ) {
-            int data_idx;
-
-            if(!supportsTimeseries) data_idx = i;
-            else data_idx = timeseries ? i*timeDim_ + itime : i*timeDim_; 
-
-            vec_ts[i][itime] = data[data_idx];
-        }
-    }
+    return &var.data;
 }
 
 void Meteorology::initTempNoMet (const Vector_1D& yCoords) {
@@ -323,18 +255,18 @@ void Meteorology::initTempNoMet (const Vector_1D& yCoords) {
         tempTotal_[j].assign(nx_, tempBase_[j]);
     }
 }
-void Meteorology::initTemperature( const NcFile& dataFile ) {
+void Meteorology::initTemperature() {
 
     if ( tempLoadType_ == MetVarLoadType::NoMetInput ) {
         initTempNoMet(yCoords_);
         return;
     }
 
-    readMetVar(dataFile, "temperature", tempTimeseriesData_, tempLoadType_ == MetVarLoadType::TimeSeries); 
+    tempTimeseriesData_ = readMetVar("temperature", tempLoadType_ == MetVarLoadType::TimeSeries);
     
     tempInit_.resize(altitudeDim_);
     for (int i = 0; i < altitudeDim_; i++) {
-        tempInit_[i] = tempTimeseriesData_[i][0];
+        tempInit_[i] = (*tempTimeseriesData_)[i][0];
     }
 
     /* Identify closest temperature to given pressure */
@@ -372,7 +304,7 @@ void Meteorology::initH2ONoMet (const Vector_1D& yCoords) {
     }
 }
 
-void Meteorology::initH2O( const NcFile& dataFile, const OptInput& optInput ) { 
+void Meteorology::initH2O( const OptInput& optInput ) { 
     //Cannot call this before initTemperature!
 
     if( rhLoadType_ == MetVarLoadType::NoMetInput ) {
@@ -380,20 +312,20 @@ void Meteorology::initH2O( const NcFile& dataFile, const OptInput& optInput ) {
         return;
     }
 
-    readMetVar(dataFile, "relative_humidity_ice", rhiTimeseriesData_, rhLoadType_ == MetVarLoadType::TimeSeries); 
+    rhiTimeseriesData_ = readMetVar("relative_humidity_ice", rhLoadType_ == MetVarLoadType::TimeSeries);
     
     rhiInit_.resize(altitudeDim_);
     
     for (int i = 0; i < altitudeDim_; i++) {
         //Scale RHi if specified
         if (optInput.MET_HUMIDSCAL_MODIFICATION_SCHEME == "scaling") {
-            rhiInit_[i] = met::rhiCorrection(rhiTimeseriesData_[i][0], optInput.MET_HUMIDSCAL_SCALING_A, optInput.MET_HUMIDSCAL_SCALING_B);
+            rhiInit_[i] = met::rhiCorrection((*rhiTimeseriesData_)[i][0], optInput.MET_HUMIDSCAL_SCALING_A, optInput.MET_HUMIDSCAL_SCALING_B);
         }
         else if (optInput.MET_HUMIDSCAL_MODIFICATION_SCHEME == "constant") {
             rhiInit_[i] = optInput.MET_HUMIDSCAL_CONST_RHI;
         }
         else {
-            rhiInit_[i] = rhiTimeseriesData_[i][0];
+            rhiInit_[i] = (*rhiTimeseriesData_)[i][0];
         }
     }
     Vector_1D localRHi(ny_);
@@ -434,17 +366,17 @@ void Meteorology::initH2O( const NcFile& dataFile, const OptInput& optInput ) {
     }
 }
 
-void Meteorology::initShear ( const NcFile& dataFile ) {
+void Meteorology::initShear() {
 
     if ( shearLoadType_ == MetVarLoadType::NoMetInput ) {
         shear_.assign(ny_, ambParams_.shear);
         return;
     }
 
-    readMetVar(dataFile, "shear", shearTimeseriesData_, shearLoadType_ == MetVarLoadType::TimeSeries); 
+    shearTimeseriesData_ = readMetVar("shear", shearLoadType_ == MetVarLoadType::TimeSeries);
     shearInit_.resize(altitudeDim_);
     for (int i = 0; i < altitudeDim_; i++) {
-        shearInit_[i] = shearTimeseriesData_[i][0];
+        shearInit_[i] = (*shearTimeseriesData_)[i][0];
     }
 
     for ( int jNy = 0;  jNy < ny_; jNy++ ) {
@@ -456,18 +388,18 @@ void Meteorology::initShear ( const NcFile& dataFile ) {
     }
 }
 
-void Meteorology::initVertVeloc ( const NcFile& dataFile ) {
+void Meteorology::initVertVeloc() {
     if ( vertVelocLoadType_ == MetVarLoadType::NoMetInput ) {
         vertVeloc_.assign(ny_, 0);
         return;
     }
 
     //Vert veloc is assumed default as timeseries input.
-    readMetVar(dataFile, "w", vertVelocTimeseriesData_, vertVelocLoadType_ == MetVarLoadType::TimeSeries);
+    vertVelocTimeseriesData_ = readMetVar("w", vertVelocLoadType_ == MetVarLoadType::TimeSeries);
     
     vertVelocInit_.resize(altitudeDim_);
     for (int i = 0; i < altitudeDim_; i++) {
-        vertVelocInit_[i] = vertVelocTimeseriesData_[i][0];
+        vertVelocInit_[i] = (*vertVelocTimeseriesData_)[i][0];
     }
 
     for ( int jNy = 0;  jNy < ny_; jNy++ ) {
@@ -480,13 +412,19 @@ void Meteorology::initVertVeloc ( const NcFile& dataFile ) {
 
 Vector_1D Meteorology::interpMetTimeseriesData(double simTime_h, const Vector_2D& ts_data, bool timeseries) const {
 
-    int itime = timeseries 
-              ? std::min(static_cast<int>(simTime_h / met_dt_h_), timeDim_ - 1)
-              : 0;
+    Vector_1D interp(altitudeDim_);
+    //Without time series input the initial profile is used throughout
+    if ( !timeseries ) {
+        for ( int i = 0; i < altitudeDim_; i++ ) {
+            interp[i] = ts_data[i][0];
+        }
+        return interp;
+    }
+
+    int itime = std::min(static_cast<int>(simTime_h / met_dt_h_), timeDim_ - 1);
 
     double before;
     double after;
-    Vector_1D interp(altitudeDim_);
 
     /* Extract temperature data before and after current time, and interpolate */
     for ( int i = 0; i < altitudeDim_; i++ ) {
@@ -521,7 +459,7 @@ void Meteorology::updateTemperature(double solarTime_h, double simTime_h) {
         return;
     }
     bool timeseries = (tempLoadType_ == MetVarLoadType::TimeSeries);
-    tempInit_ = interpMetTimeseriesData(simTime_h, tempTimeseriesData_, timeseries);
+    tempInit_ = interpMetTimeseriesData(simTime_h, *tempTimeseriesData_, timeseries);
 
     #pragma omp parallel for if (!PARALLEL_CASES)
     for ( int j = 0; j < ny_; j++ ) {
@@ -543,7 +481,7 @@ void Meteorology::updateH2O(double simTime_h) {
         if RH timeseries is not specified, the RH field will not be changed by the update function.
      */
     if (rhLoadType_ == MetVarLoadType::NoMetInput) return;
-    rhiInit_ = interpMetTimeseriesData(simTime_h, rhiTimeseriesData_, true);
+    rhiInit_ = interpMetTimeseriesData(simTime_h, *rhiTimeseriesData_, rhLoadType_ == MetVarLoadType::TimeSeries);
 
     #pragma omp parallel for if (!PARALLEL_CASES)
     for ( int j = 0; j < ny_; j++ ) {
@@ -558,7 +496,7 @@ void Meteorology::updateShear(double simTime_h) {
     if( shearLoadType_ == MetVarLoadType::NoMetInput )  return;
 
     bool timeseries = (shearLoadType_ == MetVarLoadType::TimeSeries);
-    shearInit_ = interpMetTimeseriesData(simTime_h, shearTimeseriesData_, timeseries);
+    shearInit_ = interpMetTimeseriesData(simTime_h, *shearTimeseriesData_, timeseries);
 
     for ( int jNy = 0; jNy < ny_; jNy++ ) {
         int i_Z = met::nearestNeighbor( altitudeInit_, altitude_[jNy] );
@@ -572,7 +510,7 @@ void Meteorology::updateVertVeloc(double simTime_h) {
     if( vertVelocLoadType_ == MetVarLoadType::NoMetInput )  return;
 
     bool timeseries = (vertVelocLoadType_ == MetVarLoadType::TimeSeries);
-    vertVelocInit_ = interpMetTimeseriesData(simTime_h, vertVelocTimeseriesData_, timeseries);
+    vertVelocInit_ = interpMetTimeseriesData(simTime_h, *vertVelocTimeseriesData_, timeseries);
 
     for ( int jNy = 0; jNy < ny_; jNy++ ) {
         int i_Z = met::nearestNeighbor( altitudeInit_, altitude_[jNy] );
@@ -582,14 +520,16 @@ void Meteorology::updateVertVeloc(double simTime_h) {
     }
 }
 
-void Meteorology::updateTempPerturb() {
+void Meteorology::updateTempPerturb( const Philox::Key& key, std::uint32_t step ) {
     #pragma omp parallel for\
     if(!PARALLEL_CASES) \
     default(shared)
     for (int j = 0; j < ny_; j++){
         for(int i = 0; i < nx_; i++){
-            double epsilon1 = fRand(-1.0, 1.0);
-            double epsilon2 = fRand(-1.0, 1.0);
+            const std::uint32_t cell = j * nx_ + i;
+            const Philox::Counter draw = Philox::generate({cell, step, Philox::TEMP_PERTURB, 0}, key);
+            double epsilon1 = Philox::uniform(draw[0], draw[1], -1.0, 1.0);
+            double epsilon2 = Philox::uniform(draw[2], draw[3], -1.0, 1.0);
             tempPerturbation_[j][i] = epsilon1 * epsilon2 * turbTempPertAmplitude_;
             tempTotal_[j][i] = tempBase_[j] + tempPerturbation_[j][i]; //Bad practice of having 1 function update both the temp perturb and the total temp but whatever
         }
@@ -672,5 +612,46 @@ void Meteorology::vertAdvectAltPress(double dt) {
     }
 }
 
+void Meteorology::saveState( std::ostream& os ) const {
+    for ( const double value: { temp_user_, shear_user_, rhw_user_, met_depth_, satdepth_user_, rhi_far_,
+                                altitudeRef_, pressureRef_, lapseRate_, diurnalAmplitude_, diurnalPhase_,
+                                diurnalPert_, turbTempPertAmplitude_ } ) {
+        BinaryIO::write( os, value );
+    }
+    BinaryIO::write( os, i_Zp_ );
+    BinaryIO::write( os, nx_ );
+    BinaryIO::write( os, ny_ );
+    BinaryIO::write( os, ambParams_ );
+    for ( const Vector_1D* vec: { &yCoords_, &yEdges_, &altitudeInit_, &tempInit_, &shearInit_, &rhiInit_, &vertVelocInit_,
+                                  &tempBase_, &shear_, &vertVeloc_, &altitude_, &pressure_, &altitudeEdges_, &pressureEdges_ } ) {
+        BinaryIO::write( os, *vec );
+    }
+    for ( const Vector_2D* field: { &tempTotal_, &tempPerturbation_, &airMolecDens_, &H2O_ } ) {
+        BinaryIO::write( os, *field );
+    }
+}
+
+void Meteorology::loadState( std::istream& is ) {
+    for ( double* value: { &temp_user_, &shear_user_, &rhw_user_, &met_depth_, &satdepth_user_, &rhi_far_,
+                           &altitudeRef_, &pressureRef_, &lapseRate_, &diurnalAmplitude_, &diurnalPhase_,
+                           &diurnalPert_, &turbTempPertAmplitude_ } ) {
+        BinaryIO::read( is, *value );
+    }
+    BinaryIO::read( is, i_Zp_ );
+    BinaryIO::read( is, nx_ );
+    BinaryIO::read( is, ny_ );
+    BinaryIO::read( is, ambParams_ );
+    for ( Vector_1D* vec: { &yCoords_, &yEdges_, &altitudeInit_, &tempInit_, &shearInit_, &rhiInit_, &vertVelocInit_,
+                            &tempBase_, &shear_, &vertVeloc_, &altitude_, &pressure_, &altitudeEdges_, &pressureEdges_ } ) {
+        BinaryIO::read( is, *vec );
+    }
+    for ( Vector_2D* field: { &tempTotal_, &tempPerturbation_, &airMolecDens_, &H2O_ } ) {
+        BinaryIO::read( is, *field );
+    }
+    if ( static_cast<int>(yCoords_.size()) != ny_ || static_cast<int>(tempTotal_.size()) != ny_ ) {
+        throw std::runtime_error( "Inconsistent meteorology in checkpoint" );
+    }
+}
+
 /* End of Meteorology.cpp */
 
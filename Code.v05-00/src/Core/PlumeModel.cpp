@@ -797,7 +797,7 @@ SimStatus PlumeModel( OptInput &Input_Opt, const Input &input )
 
         if (simVars.TEMP_PERTURB && (timestepVars.nTime == 0 || timestepVars.checkTimeForTempPerturb())){
             std::cout << "Running temp. perturb..." << std::endl;
-            Met.updateTempPerturb();
+            Met.updateTempPerturb( { getSeed(), input.Case() }, timestepVars.nTime );
             timestepVars.lastTimeTempPerturb = timestepVars.curr_Time_s + timestepVars.dt;
         }
 
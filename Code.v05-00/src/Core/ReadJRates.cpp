@@ -13,8 +13,10 @@
 
 #include <algorithm>
 #include <iomanip>
+#include <mutex>
 #include "Util/ForwardDecl.hpp"
 #include "Core/ReadJRates.hpp"
+#include "Core/NetCDFMutex.hpp"
 
 void ReadJRates( const char* ROOTDIR,                          \
                  const unsigned int MM, const unsigned int DD, \
@@ -48,6 +50,7 @@ void ReadJRates( const char* ROOTDIR,                          \
     //    std::cout << " Photolysis rate input file '" << fullPath << "' not found!" << std::endl;
     //    exit(-1);
     //}
+    std::lock_guard<std::mutex> lock(netCDFMutex());
     NcFile dataFile( fullPath.c_str(), NcFile::read );
 
     varName = "lon";
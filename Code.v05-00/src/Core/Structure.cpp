@@ -11,12 +11,14 @@
 /*                                                                  */
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include <fstream>
 #include "KPP/KPP.hpp"
 #include "KPP/KPP_Parameters.h"
 #include "Core/LiquidAer.hpp"
 #include "Core/Parameters.hpp"
 #include "Core/SZA.hpp"
 #include "Core/Structure.hpp"
+#include "AIM/CoagulationTable.hpp"
 #include "Util/PhysConstant.hpp"
 
 Solution::Solution(const OptInput& optInput) : \
@@ -204,10 +206,12 @@ void Solution::Initialize( char const *fileName,      \
         nBin_LA = 2;
         //dumb hardcoded Grid_Aerosol default constructor
     }
-    const AIM::Coagulation kernel1( "liquid", LA_rJ, LA_vJ, physConst::RHO_SULF, \
-                                    input.temperature_K(), input.pressure_Pa() );
-
-    LA_Kernel = kernel1;
+    if ( AIM::CoagulationTable::enabled() ) {
+        LA_Kernel = AIM::CoagulationTable::load( "liquid", LA_rJ, physConst::RHO_SULF )->kernel( input.temperature_K(), input.pressure_Pa(), LA_vJ );
+    } else {
+        LA_Kernel = AIM::Coagulation( "liquid", LA_rJ, LA_vJ, physConst::RHO_SULF, \
+                                      input.temperature_K(), input.pressure_Pa() );
+    }
 
     nBin_PA = std::floor( 1 + log( pow( (PA_R_HIG/PA_R_LOW), 3.0 ) ) / log( PA_VRAT ) );
 
@@ -240,10 +244,12 @@ void Solution::Initialize( char const *fileName,      \
         solidAerosol = PAAerosol;
     }
 
-    const AIM::Coagulation kernel2( "ice", PA_rJ, PA_vJ, physConst::RHO_ICE, \
-                                    input.temperature_K(), input.pressure_Pa() );
-
-    PA_Kernel = kernel2;
+    if ( AIM::CoagulationTable::enabled() ) {
+        PA_Kernel = AIM::CoagulationTable::load( "ice", PA_rJ, physConst::RHO_ICE )->kernel( input.temperature_K(), input.pressure_Pa(), PA_vJ );
+    } else {
+        PA_Kernel = AIM::Coagulation( "ice", PA_rJ, PA_vJ, physConst::RHO_ICE, \
+                                      input.temperature_K(), input.pressure_Pa() );
+    }
 
 } /* End of Solution::Initialize */
 
@@ -11,6 +11,7 @@
 /*                                                                  */
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+#include "AIM/CoagulationTable.hpp"
 #include "AIM/Nucleation.hpp"
 #include "KPP/KPP_Parameters.h"
 #include "Util/MolarWeights.hpp"
@@ -130,11 +131,14 @@ namespace EPM
             Ice_rJ[iBin] = 0.5 * ( Ice_rE[iBin] + Ice_rE[iBin+1] );                                            /* [m] */
 
 
-        /* Create coagulation kernels */ 
-        const AIM::Coagulation Kernel( "liquid", SO4_rJ, SO4_vJ, physConst::RHO_SULF, temperature_K, pressure_Pa );
-        const AIM::Coagulation Kernel_SO4_Soot( "liquid", SO4_rJ, physConst::RHO_SULF, EI.getSootRad(), physConst::RHO_SOOT, temperature_K, pressure_Pa );
-       
-        const Vector_1D KernelSO4Soot = Kernel_SO4_Soot.getKernel_1D();
+        /* Create coagulation kernels, optionally interpolated from tables shared by all cases */ 
+        const bool coagTables = AIM::CoagulationTable::enabled();
+        const AIM::Coagulation Kernel = coagTables ?
+            AIM::CoagulationTable::load( "liquid", SO4_rJ, physConst::RHO_SULF )->kernel( temperature_K, pressure_Pa, SO4_vJ ) :
+            AIM::Coagulation( "liquid", SO4_rJ, SO4_vJ, physConst::RHO_SULF, temperature_K, pressure_Pa );
+        const Vector_1D KernelSO4Soot = coagTables ?
+            AIM::CoagulationTable::load( "liquid", SO4_rJ, physConst::RHO_SULF, EI.getSootRad(), physConst::RHO_SOOT )->kernel_1D( temperature_K, pressure_Pa ) :
+            AIM::Coagulation( "liquid", SO4_rJ, physConst::RHO_SULF, EI.getSootRad(), physConst::RHO_SOOT, temperature_K, pressure_Pa ).getKernel_1D();
 
         /* Create SO4 aerosol number distribution.
          * We allocate the PDF with a very small number of existing particles */
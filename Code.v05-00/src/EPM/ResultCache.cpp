@@ -0,0 +1,285 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*                      Early Plume Microphysics                    */
+/*                              (EPM)                               */
+/*                                                                  */
+/* ResultCache Program File                                         */
+/*                                                                  */
+/* File                 : ResultCache.cpp                           */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include "KPP/KPP_Parameters.h"
+#include "Util/BinaryIO.hpp"
+#include "AIM/CoagulationTable.hpp"
+#include "EPM/ResultCache.hpp"
+
+namespace EPM
+{
+    namespace {
+        struct Entry {
+            Vector_1D key;
+            std::pair<EPMOutput, SimStatus> result;
+            /* Microphysics trace written by the run that produced the result, empty if read from disk */
+            std::string microFile;
+        };
+        typedef std::shared_future<std::shared_ptr<const Entry>> PendingEntry;
+
+        const char FILE_MAGIC[] = "APCEMM_EPM_CACHE";
+        const std::uint32_t FILE_VERSION = 1;
+
+        std::mutex cacheMutex;
+        bool cacheEnabled = true;
+        std::string cacheFolder;
+        std::unordered_map<std::uint64_t, PendingEntry> cache;
+
+        std::atomic<std::size_t> nHits(0);
+        std::atomic<std::size_t> nDiskHits(0);
+        std::atomic<std::size_t> nMisses(0);
+
+        Vector_1D buildKey( double tempInit_K, double pressure_Pa, double rhw, double bypassArea, double coreExitTemp, const double varArray[],
+                            const Vector_2D& aerArray, const Aircraft& AC, const Emission& EI, bool CHEMISTRY, double ambientLapseRate )
+        {
+            /* Everything EPM::Integrate reads */
+            Vector_1D key = { tempInit_K, pressure_Pa, rhw, bypassArea, coreExitTemp,
+                              AC.deltaz1(), AC.FuelFlow(), static_cast<double>(AC.EngNumber()), AC.VFlight(),
+                              EI.getH2O(), EI.getSO2(), EI.getSoot(), EI.getSootRad(),
+                              static_cast<double>(CHEMISTRY), ambientLapseRate,
+                              static_cast<double>(AIM::CoagulationTable::enabled()) };
+            key.insert( key.end(), varArray, varArray + NVAR );
+            key.push_back( aerArray.size() );
+            for ( const Vector_1D& aer: aerArray ) {
+                key.push_back( aer.size() );
+                key.insert( key.end(), aer.begin(), aer.end() );
+            }
+            return key;
+        }
+
+        std::string cacheFileName( std::uint64_t hash ) {
+            std::ostringstream name;
+            name << "EPM_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+            return ( std::filesystem::path(cacheFolder) / name.str() ).string();
+        }
+
+        void writeAerosol( std::ostream& os, const AIM::Aerosol& aer ) {
+            BinaryIO::write( os, aer.getBinCenters() );
+            BinaryIO::write( os, aer.getBinEdges() );
+            BinaryIO::write( os, aer.getPDF() );
+        }
+        void readAerosol( std::istream& is, AIM::Aerosol& aer ) {
+            Vector_1D centers, edges, pdf;
+            BinaryIO::read( is, centers );
+            BinaryIO::read( is, edges );
+            BinaryIO::read( is, pdf );
+            if ( centers.empty() || edges.size() != centers.size() + 1 || pdf.size() != centers.size() )
+                throw std::runtime_error( "Inconsistent aerosol in EPM cache file" );
+            /* Distribution parameters only matter for the initial pdf, which is replaced right away */
+            aer = AIM::Aerosol( centers, edges, 0.0, centers[0], 2.0 );
+            aer.updatePdf( pdf );
+        }
+
+        void saveEntry( std::uint64_t hash, const Entry& entry ) {
+            const std::string fileName = cacheFileName( hash );
+            std::ostringstream tmpName;
+            tmpName << fileName << ".tmp" << std::this_thread::get_id();
+
+            std::error_code ec;
+            std::filesystem::create_directories( cacheFolder, ec );
+            {
+                std::ofstream os( tmpName.str(), std::ios::binary );
+                if ( !os ) {
+                    std::cout << "WARNING: Could not write EPM cache file " << fileName << std::endl;
+                    return;
+                }
+                os.write( FILE_MAGIC, sizeof(FILE_MAGIC) );
+                BinaryIO::write( os, FILE_VERSION );
+                BinaryIO::write( os, entry.key );
+                BinaryIO::write<std::int32_t>( os, static_cast<std::int32_t>(entry.result.second) );
+                /* Only successful runs fill the output */
+                if ( entry.result.second == SimStatus::EPMSuccess ) {
+                    const EPMOutput& out = entry.result.first;
+                    BinaryIO::write( os, Vector_1D{ out.finalTemp, out.iceRadius, out.iceDensity, out.sootDensity, out.H2O_mol,
+                                       out.SO4g_mol, out.SO4l_mol, out.area, out.bypassArea, out.coreExitTemp } );
+                    writeAerosol( os, out.SO4Aer );
+                    writeAerosol( os, out.IceAer );
+                }
+            }
+            /* Readers only ever see complete files */
+            std::filesystem::rename( tmpName.str(), fileName, ec );
+            if ( ec ) std::filesystem::remove( tmpName.str(), ec );
+        }
+
+        std::shared_ptr<Entry> loadEntry( std::uint64_t hash, const Vector_1D& key ) {
+            std::ifstream is( cacheFileName( hash ), std::ios::binary );
+            if ( !is ) return nullptr;
+
+            char magic[sizeof(FILE_MAGIC)];
+            std::uint32_t version;
+            if ( !is.read( magic, sizeof(magic) ) || std::memcmp( magic, FILE_MAGIC, sizeof(magic) ) != 0 ) return nullptr;
+
+            try {
+                BinaryIO::read( is, version );
+                if ( version != FILE_VERSION ) return nullptr;
+
+                auto entry = std::make_shared<Entry>();
+                std::int32_t status;
+                /* Same hash but different inputs is a collision, not a hit */
+                BinaryIO::read( is, entry->key );
+                if ( entry->key != key ) return nullptr;
+                BinaryIO::read( is, status );
+                entry->result.second = static_cast<SimStatus>(status);
+                entry->result.first = EPMOutput();
+                if ( entry->result.second == SimStatus::EPMSuccess ) {
+                    Vector_1D scalars;
+                    BinaryIO::read( is, scalars );
+                    if ( scalars.size() != 10 ) return nullptr;
+                    EPMOutput& out = entry->result.first;
+                    out.finalTemp = scalars[0];
+                    out.iceRadius = scalars[1];
+                    out.iceDensity = scalars[2];
+                    out.sootDensity = scalars[3];
+                    out.H2O_mol = scalars[4];
+                    out.SO4g_mol = scalars[5];
+                    out.SO4l_mol = scalars[6];
+                    out.area = scalars[7];
+                    out.bypassArea = scalars[8];
+                    out.coreExitTemp = scalars[9];
+                    readAerosol( is, out.SO4Aer );
+                    readAerosol( is, out.IceAer );
+                }
+                return entry;
+            }
+            catch ( std::runtime_error& e ) {
+                /* Truncated or corrupt file, integrate again */
+                return nullptr;
+            }
+        }
+    }
+
+    void ResultCache::configure( bool enabled, const std::string& folder )
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cacheEnabled = enabled;
+        cacheFolder = folder;
+    }
+
+    std::pair<EPMOutput, SimStatus> ResultCache::Integrate( double tempInit_K, double pressure_Pa, double rhw, double bypassArea, double coreExitTemp, double varArray[],
+                                                            const Vector_2D& aerArray, const Aircraft& AC, const Emission& EI, bool CHEMISTRY, double ambientLapseRate, std::string micro_data_out )
+    {
+        bool enabled;
+        std::string folder;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            enabled = cacheEnabled;
+            folder = cacheFolder;
+        }
+        if ( !enabled ) {
+            return EPM::Integrate( tempInit_K, pressure_Pa, rhw, bypassArea, coreExitTemp, varArray, aerArray, AC, EI, CHEMISTRY, ambientLapseRate, micro_data_out );
+        }
+
+        const Vector_1D key = buildKey( tempInit_K, pressure_Pa, rhw, bypassArea, coreExitTemp, varArray, aerArray, AC, EI, CHEMISTRY, ambientLapseRate );
+        const std::uint64_t keyHash = hash( key );
+
+        /* Cases with identical inputs running at the same time wait for the first one instead of integrating again */
+        std::promise<std::shared_ptr<const Entry>> promise;
+        PendingEntry pending;
+        bool firstRequest = false;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto it = cache.find( keyHash );
+            if ( it == cache.end() ) {
+                pending = promise.get_future().share();
+                cache.emplace( keyHash, pending );
+                firstRequest = true;
+            }
+            else {
+                pending = it->second;
+            }
+        }
+
+        if ( !firstRequest ) {
+            std::shared_ptr<const Entry> entry = pending.get();
+            if ( entry->key != key ) {
+                /* Hash collision: run uncached */
+                nMisses++;
+                return EPM::Integrate( tempInit_K, pressure_Pa, rhw, bypassArea, coreExitTemp, varArray, aerArray, AC, EI, CHEMISTRY, ambientLapseRate, micro_data_out );
+            }
+            nHits++;
+            std::error_code ec;
+            if ( !micro_data_out.empty() && !entry->microFile.empty() && entry->microFile != micro_data_out ) {
+                std::filesystem::copy_file( entry->microFile, micro_data_out, std::filesystem::copy_options::overwrite_existing, ec );
+            }
+            return entry->result;
+        }
+
+        try {
+            std::shared_ptr<Entry> entry = folder.empty() ? nullptr : loadEntry( keyHash, key );
+            if ( entry ) {
+                nHits++;
+                nDiskHits++;
+            }
+            else {
+                nMisses++;
+                entry = std::make_shared<Entry>();
+                entry->key = key;
+                entry->result = EPM::Integrate( tempInit_K, pressure_Pa, rhw, bypassArea, coreExitTemp, varArray, aerArray, AC, EI, CHEMISTRY, ambientLapseRate, micro_data_out );
+                entry->microFile = micro_data_out;
+                if ( !folder.empty() ) saveEntry( keyHash, *entry );
+            }
+            promise.set_value( entry );
+            return entry->result;
+        }
+        catch (...) {
+            /* Waiting cases get the error, later cases retry */
+            promise.set_exception( std::current_exception() );
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            cache.erase( keyHash );
+            throw;
+        }
+    }
+
+    void ResultCache::clearCache()
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        cache.clear();
+    }
+
+    std::size_t ResultCache::hits()
+    {
+        return nHits;
+    }
+
+    std::size_t ResultCache::misses()
+    {
+        return nMisses;
+    }
+
+    std::string ResultCache::summary()
+    {
+        std::ostringstream os;
+        os << "EPM result cache: " << nHits << " hits (" << nDiskHits << " from disk), " << nMisses << " misses";
+        return os.str();
+    }
+
+    std::uint64_t ResultCache::hash( const Vector_1D& key )
+    {
+        std::uint64_t h = 14695981039346656037ULL;
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.data());
+        for ( std::size_t i = 0; i < key.size() * sizeof(double); i++ ) {
+            h ^= bytes[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+}
@@ -1,5 +1,7 @@
 #include <FVM_ANDS/AdvDiffSystem.hpp>
-#include <chrono>
+#include <FVM_ANDS/SpectralDiffusion.hpp>
+#include <algorithm>
+#include <cmath>
 #include <math.h>
 
 namespace FVM_ANDS{
@@ -22,7 +24,8 @@ namespace FVM_ANDS{
         bcVals_left_ (bc.bcVals_left),
         bcVals_right_ (bc.bcVals_right),
         bcVals_bot_ (bc.bcVals_bot),
-        phi_(phi_init)
+        phi_(phi_init),
+        coefPatternBuilt_(false)
     {
         invdx_ = 1.0/dx_;
         invdy_ = 1.0/dy_;
@@ -47,6 +50,7 @@ namespace FVM_ANDS{
         updateDiffusion(params.Dh, params.Dv);
         initVelocVecs();
         buildPointList();
+        buildStencil();
         applyBoundaryCondition();
     }
 
@@ -158,38 +162,13 @@ namespace FVM_ANDS{
         //Crank-Nicholson Discretization. Builds the Advection terms of the A matrix 
         //in the system A * phi_t+1 = b.
 
-        //Num non-zeros calculation: 
-        std::vector<Eigen::Triplet<double>> tripletList;
-        auto start = std::chrono::high_resolution_clock::now();
-        for(int i = 0; i < nTotalPoints_; i++){
-
-            if(points_[i]->isGhost()){
-                switch(points_[i]->bcType()){
-                    case BoundaryConditionFlag::DIRICHLET_GHOSTPOINT:{
-                        // (phi_int + phi_ghost) / 2 = phi_boundary
-                        // if inhomog, the bc value will appear in the rhs.
-                        tripletList.emplace_back(i, i, 0.5);
-                        tripletList.emplace_back(i, points_[i]->corrPoint(), 0.5);
-                        break;
-                    }
-                    case BoundaryConditionFlag::PERIODIC_GHOSTPOINT:{
-                        // Ghost node will exactly equal to the cell on the other end of the domain
-                        // effectively makes opposite ends of the domain neighbor points.
-                        throw std::runtime_error("Periodic BCs not yet implemented.");
-                        break;
-                    }
-                    default: {
-                        throw std::runtime_error("Ghost point doesn't have a bcType associated with being a ghost point!");
-                    }
-                }
-                continue;
-            }
-
-            int idx_E = neighbor_point(FaceDirection::EAST, i);
-            int idx_W = neighbor_point(FaceDirection::WEST, i);
-            int idx_N = neighbor_point(FaceDirection::NORTH, i);
-            int idx_S = neighbor_point(FaceDirection::SOUTH, i);
-
+        //The sparsity pattern only depends on the point list, so it is assembled once.
+        //Later calls only overwrite the coefficients of the interior rows in place.
+        if(!coefPatternBuilt_){
+            buildCoeffPattern();
+        }
+        double* values = totalCoefMatrix_.valuePtr();
+        for(int i = 0; i < nInteriorPoints_; i++){
             //Diffusion Terms
             double coeff_C = 1 + 2 * dt_ * (Dh_vec_[i] / (dx_ * dx_) + Dv_vec_[i] / (dy_ * dy_));
             double coeff_E = -Dh_vec_[i] * dt_ / (dx_ * dx_);
@@ -202,17 +181,58 @@ namespace FVM_ANDS{
                 buildAdvectionCoeffs(i, coeff_C, coeff_N, coeff_S, coeff_E, coeff_W);
             }
 
-            //Triplet Format: row, col, value
-            tripletList.emplace_back(i, idx_E, coeff_E);
-            tripletList.emplace_back(i, idx_W, coeff_W);
-            tripletList.emplace_back(i, idx_N, coeff_N);
-            tripletList.emplace_back(i, idx_S, coeff_S);
-            tripletList.emplace_back(i, i, coeff_C);
+            //Same as summing duplicate triplets in case two stencil entries share a column
+            const int* pos = &coefPos_[5*i];
+            values[pos[0]] = 0;
+            values[pos[1]] = 0;
+            values[pos[2]] = 0;
+            values[pos[3]] = 0;
+            values[pos[4]] = 0;
+            values[pos[0]] += coeff_E;
+            values[pos[1]] += coeff_W;
+            values[pos[2]] += coeff_N;
+            values[pos[3]] += coeff_S;
+            values[pos[4]] += coeff_C;
         } 
-
-        auto stop = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop-start);
+    }
+    void AdvDiffSystem::buildCoeffPattern(){
+        std::vector<Eigen::Triplet<double>> tripletList;
+        tripletList.reserve(5 * nInteriorPoints_ + 2 * nGhostPoints_);
+        for(int i = 0; i < nInteriorPoints_; i++){
+            //Triplet Format: row, col, value
+            tripletList.emplace_back(i, nbrE_[i], 0.0);
+            tripletList.emplace_back(i, nbrW_[i], 0.0);
+            tripletList.emplace_back(i, nbrN_[i], 0.0);
+            tripletList.emplace_back(i, nbrS_[i], 0.0);
+            tripletList.emplace_back(i, i, 0.0);
+        }
+        for(int g = 0; g < nGhostPoints_; g++){
+            // (phi_int + phi_ghost) / 2 = phi_boundary
+            // if inhomog, the bc value will appear in the rhs.
+            int i = nInteriorPoints_ + g;
+            tripletList.emplace_back(i, i, 0.5);
+            tripletList.emplace_back(i, ghostCorr_[g], 0.5);
+        }
+        totalCoefMatrix_.resize(nTotalPoints_, nTotalPoints_);
         totalCoefMatrix_.setFromTriplets(tripletList.begin(), tripletList.end());
+
+        //Record where each interior stencil coefficient lives in the compressed value array
+        auto valueIndex = [this](int row, int col) -> int {
+            for(Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(totalCoefMatrix_, row); it; ++it){
+                if(it.col() == col) return &it.valueRef() - totalCoefMatrix_.valuePtr();
+            }
+            throw std::runtime_error("Stencil entry missing from coefficient matrix pattern");
+        };
+        coefPos_.resize(5 * nInteriorPoints_);
+        for(int i = 0; i < nInteriorPoints_; i++){
+            coefPos_[5*i] = valueIndex(i, nbrE_[i]);
+            coefPos_[5*i + 1] = valueIndex(i, nbrW_[i]);
+            coefPos_[5*i + 2] = valueIndex(i, nbrN_[i]);
+            coefPos_[5*i + 3] = valueIndex(i, nbrS_[i]);
+            coefPos_[5*i + 4] = valueIndex(i, i);
+        }
+        coloring_ = greedyColoring(totalCoefMatrix_);
+        coefPatternBuilt_ = true;
     }
     void AdvDiffSystem::buildAdvectionCoeffs(int i, double& coeff_C, double& coeff_N, double& coeff_S, double& coeff_E, double& coeff_W){
         //Advection Terms
@@ -276,163 +296,30 @@ namespace FVM_ANDS{
     }
 
     const Eigen::VectorXd& AdvDiffSystem::calcRHS(){
-        for(int i = 0; i < nTotalPoints_; i++){
-            if(points_[i]->isGhost()){
-                switch(points_[i]->bcType()){
-                    case BoundaryConditionFlag::DIRICHLET_GHOSTPOINT:{
-                        // Equation: (phi_int + phi_ghost) / 2 = phi_boundary
-                        rhs_[i] = points_[i]->bcVal();
-                        break;
-                    }
-                    case BoundaryConditionFlag::PERIODIC_GHOSTPOINT:{
-                        // Ghost node will exactly equal to the cell on the other end of the domain
-                        // effectively makes opposite ends of the domain neighbor points.
-                        throw std::runtime_error("Periodic BCs not yet implemented.");
-                        break;
-                    }
-                    default: {
-                        throw std::runtime_error("Ghost point doesn't have a bcType associated with being a ghost point!");
-                    }                
-                }
-                continue;
-            }
-
-            switch(points_[i]->bcType()){
-                case BoundaryConditionFlag::INTERIOR:{
-                    rhs_[i] = phi_[i] + deferredCorr_[i] + source_[i]*dt_;
-                    break;
-                }
-                case BoundaryConditionFlag::DIRICHLET_INT_BPOINT:{
-                    rhs_[i] = phi_[i] + deferredCorr_[i] + source_[i]*dt_;
-                    switch(points_[i]->bcDirection()){
-                        case FaceDirection::NORTH:
-                            rhs_[i] -= v_vec_[i] * dt_ / dy_ * points_[i]->bcVal();
-                            break;
-                        case FaceDirection::SOUTH:
-                            rhs_[i] += v_vec_[i] * dt_ / dy_ * points_[i]->bcVal();
-                            break;
-                        case FaceDirection::EAST:
-                            rhs_[i] -= u_vec_[i] * dt_ / dx_ * points_[i]->bcVal();
-                            break;
-                        case FaceDirection::WEST:
-                            rhs_[i] += u_vec_[i] * dt_ / dx_ * points_[i]->bcVal();
-                            break;
-                        case FaceDirection::ERROR:
-                            throw std::runtime_error("Invalid FaceDirection in Dirichlet boundary condition");
-                    }
-                    if (!points_[i]->secondBoundaryConds()) break;
-                    BoundaryCondDescription bc_2 = points_[i]->secondBoundaryConds().value();
-                    switch(bc_2.direction){
-                        case FaceDirection::EAST:
-                            rhs_[i] -= u_vec_[i] * dt_ / dx_ * bc_2.bcVal;
-                            break;
-                        case FaceDirection::WEST:
-                            rhs_[i] += u_vec_[i] * dt_ / dx_ * bc_2.bcVal;
-                            break;
-                        default:
-                            throw std::runtime_error("Can't have anything but EAST or WEST as secondary BC!");
-                    }
-                    break;
-                }
-                case BoundaryConditionFlag::PERIODIC_INT_BPOINT:{
-                    throw std::runtime_error("Periodic BCs not yet implemented.");
-                    break;
-                }
-                default: {
-                    throw std::runtime_error("Interior boundary point has invalid bcType");
-                }                
-            }
-            continue;
-        }
-
+        Eigen::VectorXd phi_corr = phi_;
+        phi_corr.head(nInteriorPoints_) = phi_.head(nInteriorPoints_) + deferredCorr_ + source_*dt_;
+        calcRHS(phi_corr, v_double_, rhs_);
         return rhs_;
     }
-    void AdvDiffSystem::applyBoundaryCondition(){
-        //top and bottom bc
-        for(int i = 0; i < nx_; i++){
-            //top
-            int bPointID_top = twoDIdx_to_vecIdx(i, ny_ - 1, nx_, ny_, format_);
-            switch(bcType_top_){
-                case BoundaryConditionFlag::DIRICHLET_INT_BPOINT: {
-                    int ghostPointID = points_[bPointID_top]->corrPoint();
-                    phi_[ghostPointID] = 2 * points_[bPointID_top]->bcVal() - phi_[bPointID_top];
-                    break;
-                }
-                default: {
-                    throw std::runtime_error("Chosen boundary condition not implemented yet");
-                }
-            }
-
-            //bottom
-            int bPointID_bot = twoDIdx_to_vecIdx(i, 0, nx_, ny_, format_);
-            switch(bcType_bot_){
-                case BoundaryConditionFlag::DIRICHLET_INT_BPOINT: {
-                    int ghostPointID = points_[bPointID_bot]->corrPoint();
-                    phi_[ghostPointID] = 2 * points_[bPointID_bot]->bcVal() - phi_[bPointID_bot];
-                    break;
-                }
-                default: {
-                    throw std::runtime_error("Chosen boundary condition not implemented yet");
-                }
-            }
+    void AdvDiffSystem::calcRHS(const Eigen::VectorXd& phi, double v, Eigen::VectorXd& rhs) const {
+        //Boundary face values are zero on faces without a boundary, so the Dirichlet terms can be added unconditionally.
+        const double cy = v * dt_ / dy_;
+        for(int i = 0; i < nInteriorPoints_; i++){
+            const double cx = u_vec_[i] * dt_ / dx_;
+            rhs[i] = phi[i] - cy * bcValN_[i] + cy * bcValS_[i] - cx * bcValE_[i] + cx * bcValW_[i];
         }
-
-        //left and right bc
-        for(int j = 0; j < ny_; j++){
-            //corner cases
-            if(j == 0 || j == ny_ - 1){
-                int bPointID_cornerLeft = twoDIdx_to_vecIdx(0, j, nx_, ny_, format_);
-                int ghostPointID = points_[bPointID_cornerLeft]->secondBoundaryConds().value().corrPoint;
-                double bcVal =  points_[bPointID_cornerLeft]->secondBoundaryConds().value().bcVal;
-                switch(bcType_left_){
-                    case BoundaryConditionFlag::DIRICHLET_INT_BPOINT: {
-                        phi_[ghostPointID] = 2 * bcVal - phi_[bPointID_cornerLeft];
-                        break;
-                    }
-                    default: {
-                        throw std::runtime_error("Chosen boundary condition not implemented yet");
-                    }
-                }
-
-                int bPointID_cornerRight = twoDIdx_to_vecIdx(nx_ - 1, j, nx_, ny_, format_);
-                ghostPointID = points_[bPointID_cornerRight]->secondBoundaryConds().value().corrPoint;
-                bcVal = points_[bPointID_cornerRight]->secondBoundaryConds().value().bcVal;
-
-                switch(bcType_right_){
-                    case BoundaryConditionFlag::DIRICHLET_INT_BPOINT: {
-                        phi_[ghostPointID] = 2 * bcVal - phi_[bPointID_cornerRight];
-                        break;
-                    }
-                    default: {
-                        throw std::runtime_error("Chosen boundary condition not implemented yet");
-                    }
-                }
-            }
-
-            //left
-            int bPointID_left = twoDIdx_to_vecIdx(0, j, nx_, ny_, format_);
-            switch(bcType_left_){
-                case BoundaryConditionFlag::DIRICHLET_INT_BPOINT: {
-                    int ghostPointID = points_[bPointID_left]->corrPoint();
-                    phi_[ghostPointID] = 2 * points_[bPointID_left]->bcVal() - phi_[bPointID_left];
-                    break;
-                }
-                default: {
-                    throw std::runtime_error("Chosen boundary condition not implemented yet");
-                }
-            }
-            //right
-            int bPointID_right = twoDIdx_to_vecIdx(nx_ - 1, j, nx_, ny_, format_);
-            switch(bcType_right_){
-                case BoundaryConditionFlag::DIRICHLET_INT_BPOINT: {
-                    int ghostPointID = points_[bPointID_right]->corrPoint();
-                    phi_[ghostPointID] = 2 * points_[bPointID_right]->bcVal() - phi_[bPointID_right];
-                    break;
-                }
-                default: {
-                    throw std::runtime_error("Chosen boundary condition not implemented yet");
-                }
-            }
+        // Ghost points: (phi_int + phi_ghost) / 2 = phi_boundary
+        for(int g = 0; g < nGhostPoints_; g++){
+            rhs[nInteriorPoints_ + g] = ghostBcVal_[g];
+        }
+    }
+    void AdvDiffSystem::applyBoundaryCondition(){
+        applyBoundaryCondition(phi_);
+    }
+    void AdvDiffSystem::applyBoundaryCondition(Eigen::VectorXd& phi) const {
+        //Dirichlet: boundary value is the average of the boundary point and its ghost point
+        for(int g = 0; g < nGhostPoints_; g++){
+            phi[nInteriorPoints_ + g] = 2 * ghostBcVal_[g] - phi[ghostCorr_[g]];
         }
     }
     void AdvDiffSystem::updateBoundaryCondition(const BoundaryConditions& bc){
@@ -500,12 +387,17 @@ namespace FVM_ANDS{
             points_[corrPointID]->setBCVal(bcVals_bot_[i]); 
             currIdx++;
         }
+        buildStencil();
         applyBoundaryCondition(); //need this to calculate minmod function at some timestep.
     }
 
     Eigen::VectorXd AdvDiffSystem::forwardEulerAdvection(bool operatorSplit, bool parallelAdvection) const noexcept{
-        Eigen::VectorXd soln(nTotalPoints_);
-        // double avgBackgroundCalcTime = 0;
+        Eigen::VectorXd soln;
+        forwardEulerAdvection(phi_, v_double_, dt_, soln, parallelAdvection);
+        return soln;
+    }
+    void AdvDiffSystem::forwardEulerAdvection(const Eigen::VectorXd& phi, double v, double dt, Eigen::VectorXd& soln, bool parallelAdvection) const noexcept{
+        soln.resize(nTotalPoints_);
         //Explicit Time-Stepping
         #pragma omp parallel for    \
         if      ( parallelAdvection ) \
@@ -514,112 +406,306 @@ namespace FVM_ANDS{
         for(int i = 0; i < nInteriorPoints_; i++){
             //When a boundary condition is in place, phi at the face can be directly calculated using the BC.
             //Therefore, that term goes to the RHS and the contribution of that face to the coeffs goes to 0.
-            bool isNorthBoundary = 0, isWestBoundary = 0, isEastBoundary = 0, isSouthBoundary = 0, secondaryWestBound = 0, secondaryEastBound = 0;
-            int idx_E = i + ny_;
-            int idx_W = i - ny_;
-            int idx_N = i + 1;
-            int idx_S = i - 1;
-
-            //commenting out this results in ~30% speedup
-            //The calls involving the optional are maybe 1/3 of the cost. Maybe something to look at later.
-            if(points_[i]->bcType() != BoundaryConditionFlag::INTERIOR){
-                Point* point = points_[i].get();
-                FaceDirection direction = point->bcDirection();
-                isNorthBoundary = direction == FaceDirection::NORTH;
-                isSouthBoundary = direction == FaceDirection::SOUTH;
-
-                //Corner cases...
-                bool secondaryWestBound = (point->secondBoundaryConds() && point->secondBoundaryConds()->direction == FaceDirection::WEST);
-                bool secondaryEastBound = (point->secondBoundaryConds() && point->secondBoundaryConds()->direction == FaceDirection::EAST);
-
-                isWestBoundary = (direction == FaceDirection::WEST || secondaryWestBound);
-                isEastBoundary = (direction == FaceDirection::EAST || secondaryEastBound);
-
-                //only call this lookup function on boundary nodes which are inconsequential in number
-                idx_N = isNorthBoundary? point->corrPoint() : idx_N;
-                idx_S = isSouthBoundary? point->corrPoint() : idx_S;
-                idx_E = isEastBoundary? (secondaryEastBound ? point->secondBoundaryConds()->corrPoint : point->corrPoint()) : idx_E;
-                idx_W = isWestBoundary? (secondaryEastBound ? point->secondBoundaryConds()->corrPoint : point->corrPoint()) : idx_W;
-            }
-            //When you declare these vars (inside or outside loop) has 0 impact)
-            //takes ~ 6 out of 18 ns on background var calcs
-
-            //these cost almost nothing to compute but commenting out anyway for maximum performance
-            // double dphi_dx_E = (phi_[idx_E] - phi_[i]) * invdx_;
-            // double dphi_dx_W = (phi_[i] - phi_[idx_W]) * invdx_;
-            // double dphi_dy_N = (phi_[idx_N] - phi_[i]) * invdy_;
-            // double dphi_dy_S = (phi_[i] - phi_[idx_S]) * invdy_;
-            
-            //ignoreing distinction of faces saves a good amt of time
-            // double u_W = isWestBoundary? u_vec_[i] : 0.5 * (u_vec_[i] + u_vec_[idx_W]);
-            // double u_E = isEastBoundary? u_vec_[i] : 0.5 * (u_vec_[i] + u_vec_[idx_E]);
-            // double v_N = isNorthBoundary? v_vec_[i] : 0.5 * (v_vec_[i] + v_vec_[idx_N]);
-            // double v_S = isSouthBoundary? v_vec_[i] : 0.5 * (v_vec_[i] + v_vec_[idx_S]);
-            double u_local = u_vec_[i];
-            double v_local = v_vec_[i];
+            //All stencil information comes from the flat arrays built in buildStencil(), no Point lookups here.
+            const unsigned char faces = boundaryFaces_[i];
+            const int idx_N = nbrN_[i];
+            const int idx_S = nbrS_[i];
+            const int idx_E = nbrE_[i];
+            const int idx_W = nbrW_[i];
 
-            // auto stop = std::chrono::high_resolution_clock::now();
-            // auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
-            // avgBackgroundCalcTime += duration.count();
-            //std::cout << "ForwardEuler: Background Variable Calc Time: " << duration.count() << "ns" << std::endl;
-            // start = std::chrono::high_resolution_clock::now();
+            double u_local = u_vec_[i];
+            double v_local = v;
             double phi_N, phi_S, phi_W, phi_E;
 
-            //Unraveling any of these if's into single liners hurts performance
-            //Killing the branching completely into 1 statement (not possible) only results in ~10% speedup (not worth it)
             //Using only first order upwind can result in a ~40% speedup of the total advection calc.
             //So... there is significantly more cost from actually doing the calculation than from branching.
-            if(isNorthBoundary){
-                phi_N = points_[i]->bcVal();
+            if(faces & NORTH_FACE){
+                phi_N = bcValN_[i];
             }
             else if (v_local >= 0){
-                phi_N = phi_[i] + 0.5 * minmod_N_vPos(i) * (phi_[idx_N] - phi_[i]);
+                phi_N = phi[i] + 0.5 * minmod_N_vPos(phi, i) * (phi[idx_N] - phi[i]);
             }
             else {
-                phi_N = phi_[idx_N] + 0.5 * minmod_N_vNeg(i) * (phi_[i] - phi_[idx_N]);
+                phi_N = phi[idx_N] + 0.5 * minmod_N_vNeg(phi, i) * (phi[i] - phi[idx_N]);
             }
-            if(isSouthBoundary){
-                phi_S = points_[i]->bcVal();
+            if(faces & SOUTH_FACE){
+                phi_S = bcValS_[i];
             }
             else if (v_local >= 0){
-                phi_S = phi_[idx_S] +  0.5 * minmod_S_vPos(i) * (phi_[i] - phi_[idx_S]);
+                phi_S = phi[idx_S] +  0.5 * minmod_S_vPos(phi, i) * (phi[i] - phi[idx_S]);
             }
             else {
-                phi_S = phi_[i] +  0.5 * minmod_S_vNeg(i) * (phi_[idx_S] - phi_[i]);
+                phi_S = phi[i] +  0.5 * minmod_S_vNeg(phi, i) * (phi[idx_S] - phi[i]);
             }
 
-            if(isWestBoundary){
-                phi_W = secondaryWestBound ? points_[i]->secondBoundaryConds().value().bcVal : points_[i]->bcVal();
+            if(faces & WEST_FACE){
+                phi_W = bcValW_[i];
             }
             else if (u_local >= 0){
-                phi_W = phi_[idx_W] + 0.5 * minmod_W_vPos(i) * (phi_[i] - phi_[idx_W]);
+                phi_W = phi[idx_W] + 0.5 * minmod_W_vPos(phi, i) * (phi[i] - phi[idx_W]);
             }
             else {
-                phi_W = phi_[i] + 0.5 * minmod_W_vNeg(i) * (phi_[idx_W] - phi_[i]);
+                phi_W = phi[i] + 0.5 * minmod_W_vNeg(phi, i) * (phi[idx_W] - phi[i]);
             }
 
-            if(isEastBoundary){
-                phi_E = secondaryEastBound ? points_[i]->secondBoundaryConds().value().bcVal : points_[i]->bcVal();
+            if(faces & EAST_FACE){
+                phi_E = bcValE_[i];
             }
             else if (u_local >= 0){
-                phi_E = phi_[i] + 0.5 * minmod_E_vPos(i) * (phi_[idx_E] - phi_[i]);
+                phi_E = phi[i] + 0.5 * minmod_E_vPos(phi, i) * (phi[idx_E] - phi[i]);
             }
             else {
-                phi_E = phi_[idx_E] + 0.5 * minmod_E_vNeg(i) * (phi_[i] - phi_[idx_E]);
+                phi_E = phi[idx_E] + 0.5 * minmod_E_vNeg(phi, i) * (phi[i] - phi[idx_E]);
             }
 
-            //std::cout << "ForwardEuler: Fluxes and Update Time: " << duration.count() << "ns" << std::endl;
+            soln[i] = dt * invdx_ * (u_local * phi_W - u_local * phi_E) + dt * invdy_ * (v_local * phi_S - v_local * phi_N)\
+                    + source_[i] * dt + phi[i];
+        }
+    }
 
-            //Even just setting this to 0 is like a 2 ns save out of 12, not sure if worth
-            soln[i] = /*(!operatorSplit) * (Dh_ * dt_ * invdx_ * (dphi_dx_E - dphi_dx_W) + Dv_ * dt_ * invdy_ * (dphi_dy_N - dphi_dy_S))\*/
-                     dt_ * invdx_ * (u_local * phi_W - u_local * phi_E) + dt_ * invdy_ * (v_local * phi_S - v_local * phi_N)\
-                    + source_[i] * dt_ + phi_[i];
-            // stop = std::chrono::high_resolution_clock::now();
-            // duration = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start);
-            // avgFluxCalcTime += duration.count();
+    namespace {
+        // Flux-form remap of one grid line of n cells shifted by `shift` cells (positive towards increasing index).
+        // q holds the line with one ghost cell on each end (q[0] and q[n+1]), which extend to infinity.
+        // slope is scratch of the same size. Writes out[m * outStride] for m = 0 ... n-1.
+        void remapLine(const double* q, double* slope, int n, double shift, double* out, int outStride){
+            //Minmod limited slopes keep the reconstruction within the range of the neighbouring cells, so the remap stays monotone
+            slope[0] = 0.0;
+            slope[n + 1] = 0.0;
+            for(int k = 1; k <= n; k++){
+                const double dl = q[k] - q[k - 1];
+                const double dr = q[k + 1] - q[k];
+                slope[k] = (dl * dr <= 0.0) ? 0.0 : (std::abs(dl) < std::abs(dr) ? dl : dr);
+            }
+            //Integral of the reconstruction q_k + slope_k * (xi - 1/2) of padded cell k over [a, b], 0 <= a <= b <= 1
+            auto integral = [q, slope](int k, double a, double b){
+                return q[k] * (b - a) + 0.5 * slope[k] * ((b * b - b) - (a * a - a));
+            };
+            for(int m = 0; m < n; m++){
+                //Cell m is filled by what is in [m - shift, m + 1 - shift] at the start of the step, which spans at most two cells.
+                //Departure points beyond the ghost cells are clamped, the ghost values being constant.
+                const double x = std::clamp(m - shift, -1.0, static_cast<double>(n));
+                const int k = static_cast<int>(std::floor(x));
+                const double f = x - k;
+                out[m * outStride] = integral(std::min(k + 1, n + 1), f, 1.0) + integral(std::min(k + 2, n + 1), 0.0, f);
+            }
         }
+    }
+
+    Eigen::VectorXd AdvDiffSystem::semiLagrangianAdvection(double dt, bool yFirst, bool parallelAdvection) const{
+        Eigen::VectorXd soln;
+        semiLagrangianAdvection(phi_, v_double_, dt, soln, yFirst, parallelAdvection);
         return soln;
     }
+
+    void AdvDiffSystem::semiLagrangianAdvection(const Eigen::VectorXd& phi, double v, double dt, Eigen::VectorXd& soln, bool yFirst, bool parallelAdvection) const{
+        soln.resize(nTotalPoints_);
+        //Offsets between neighbouring points along x and along y
+        const int xStride = (format_ == vecFormat::COLMAJOR) ? ny_ : 1;
+        const int yStride = (format_ == vecFormat::COLMAJOR) ? 1 : nx_;
+
+        #pragma omp parallel if(parallelAdvection) default(shared)
+        {
+            //Line buffer with ghost cells and slopes, reused for every line handled by this thread
+            Vector_1D q(std::max(nx_, ny_) + 2);
+            Vector_1D slope(std::max(nx_, ny_) + 2);
+
+            for(int pass = 0; pass < 2; pass++){
+                //First pass reads phi, second pass remaps soln in place (each line is copied to q first)
+                const double* in = (pass == 0) ? phi.data() : soln.data();
+                if((pass == 0) != yFirst){
+                    //Rows: u only depends on y
+                    #pragma omp for schedule(static)
+                    for(int j = 0; j < ny_; j++){
+                        const int start = twoDIdx_to_vecIdx(0, j, nx_, ny_, format_);
+                        q[0] = bcValW_[start];
+                        q[nx_ + 1] = bcValE_[start + (nx_ - 1) * xStride];
+                        for(int i = 0; i < nx_; i++){
+                            q[i + 1] = in[start + i * xStride];
+                        }
+                        remapLine(q.data(), slope.data(), nx_, u_vec_[start] * dt / dx_, soln.data() + start, xStride);
+                    }
+                }
+                else {
+                    //Columns: v is uniform
+                    #pragma omp for schedule(static)
+                    for(int i = 0; i < nx_; i++){
+                        const int start = twoDIdx_to_vecIdx(i, 0, nx_, ny_, format_);
+                        q[0] = bcValS_[start];
+                        q[ny_ + 1] = bcValN_[start + (ny_ - 1) * yStride];
+                        for(int j = 0; j < ny_; j++){
+                            q[j + 1] = in[start + j * yStride];
+                        }
+                        remapLine(q.data(), slope.data(), ny_, v * dt / dy_, soln.data() + start, yStride);
+                    }
+                }
+            }
+        }
+        soln.head(nInteriorPoints_) += source_ * dt;
+    }
+
+    void AdvDiffSystem::adiDiffusionSolve(const Eigen::VectorXd& rhs, Eigen::VectorXd& phi, bool parallel) const {
+        //Offsets between neighbouring points along x and along y
+        const int xStride = (format_ == vecFormat::COLMAJOR) ? ny_ : 1;
+        const int yStride = (format_ == vecFormat::COLMAJOR) ? 1 : nx_;
+        const double invdx2 = 1.0 / (dx_ * dx_);
+        const double invdy2 = 1.0 / (dy_ * dy_);
+
+        #pragma omp parallel if(parallel) default(shared)
+        {
+            //Thomas algorithm scratch, reused for every line handled by this thread
+            Vector_1D cPrime(std::max(nx_, ny_));
+            Vector_1D dPrime(std::max(nx_, ny_));
+
+            //Solves -a_m phi_{m-1} + diag_m phi_m - a_m phi_{m+1} = r_m along one line of n points, where a_m = dt * D_m / h^2.
+            //Dirichlet faces eliminate the ghost point: phi_ghost = 2 * bcVal - phi_m.
+            auto solveLine = [&](int start, int stride, int n, const Eigen::VectorXd& D, double invh2,
+                                 unsigned char lowFace, unsigned char highFace, const Vector_1D& bcLow, const Vector_1D& bcHigh,
+                                 const Eigen::VectorXd& r, Eigen::VectorXd& x){
+                double cPrev = 0, dPrev = 0;
+                for(int m = 0; m < n; m++){
+                    const int k = start + m * stride;
+                    const double a = dt_ * D[k] * invh2;
+                    double diag = 1 + 2 * a;
+                    double r_k = r[k];
+                    if(boundaryFaces_[k] & lowFace){
+                        diag += a;
+                        r_k += 2 * a * bcLow[k];
+                    }
+                    if(boundaryFaces_[k] & highFace){
+                        diag += a;
+                        r_k += 2 * a * bcHigh[k];
+                    }
+                    const double lower = (m == 0) ? 0 : -a;
+                    const double upper = (m == n - 1) ? 0 : -a;
+                    const double denom = diag - lower * cPrev;
+                    cPrime[m] = upper / denom;
+                    dPrime[m] = (r_k - lower * dPrev) / denom;
+                    cPrev = cPrime[m];
+                    dPrev = dPrime[m];
+                }
+                double xNext = dPrime[n - 1];
+                x[start + (n - 1) * stride] = xNext;
+                for(int m = n - 2; m >= 0; m--){
+                    xNext = dPrime[m] - cPrime[m] * xNext;
+                    x[start + m * stride] = xNext;
+                }
+            };
+
+            //Step 1: (I - dt*Dxx) w = rhs, one line per y index. w is stored in phi.
+            #pragma omp for schedule(static)
+            for(int j = 0; j < ny_; j++){
+                solveLine(j * yStride, xStride, nx_, Dh_vec_, invdx2, WEST_FACE, EAST_FACE, bcValW_, bcValE_, rhs, phi);
+            }
+            //Step 2: (I - dt*Dyy) phi = w, one line per x index. Lines only touch their own points, so this can be done in place.
+            #pragma omp for schedule(static)
+            for(int i = 0; i < nx_; i++){
+                solveLine(i * xStride, yStride, ny_, Dv_vec_, invdy2, SOUTH_FACE, NORTH_FACE, bcValS_, bcValN_, phi, phi);
+            }
+        }
+        applyBoundaryCondition(phi);
+    }
+
+    bool AdvDiffSystem::spectralDiffusionApplicable() const {
+        if(nInteriorPoints_ == 0) return true;
+        for(int g = 0; g < nGhostPoints_; g++){
+            if(ghostBcVal_[g] != 0) return false;
+        }
+        return (Dh_vec_.array() == Dh_vec_[0]).all() && (Dv_vec_.array() == Dv_vec_[0]).all();
+    }
+
+    void AdvDiffSystem::spectralDiffusionSolve(const Eigen::VectorXd& rhs, Eigen::VectorXd& phi) const {
+        if(!spectralDiffusionApplicable()){
+            throw std::runtime_error("AdvDiffSystem: spectral diffusion requires uniform diffusivities and zero boundary conditions!");
+        }
+        if(nInteriorPoints_ > 0){
+            //The propagator indexes the interior as phi[i0 * n1 + i1]
+            if(format_ == vecFormat::COLMAJOR){
+                spectralDiffusionPropagate(rhs.data(), phi.data(), nx_, ny_, dx_, dy_, Dh_vec_[0], Dv_vec_[0], dt_);
+            }
+            else{
+                spectralDiffusionPropagate(rhs.data(), phi.data(), ny_, nx_, dy_, dx_, Dv_vec_[0], Dh_vec_[0], dt_);
+            }
+        }
+        applyBoundaryCondition(phi);
+    }
+
+    void AdvDiffSystem::buildStencil(){
+        nbrN_.resize(nInteriorPoints_);
+        nbrS_.resize(nInteriorPoints_);
+        nbrE_.resize(nInteriorPoints_);
+        nbrW_.resize(nInteriorPoints_);
+        boundaryFaces_.assign(nInteriorPoints_, 0);
+        bcValN_.assign(nInteriorPoints_, 0.0);
+        bcValS_.assign(nInteriorPoints_, 0.0);
+        bcValE_.assign(nInteriorPoints_, 0.0);
+        bcValW_.assign(nInteriorPoints_, 0.0);
+
+        auto setBoundaryFace = [this](int i, FaceDirection direction, double bcVal){
+            switch(direction){
+                case FaceDirection::NORTH:
+                    boundaryFaces_[i] |= NORTH_FACE;
+                    bcValN_[i] = bcVal;
+                    break;
+                case FaceDirection::SOUTH:
+                    boundaryFaces_[i] |= SOUTH_FACE;
+                    bcValS_[i] = bcVal;
+                    break;
+                case FaceDirection::EAST:
+                    boundaryFaces_[i] |= EAST_FACE;
+                    bcValE_[i] = bcVal;
+                    break;
+                case FaceDirection::WEST:
+                    boundaryFaces_[i] |= WEST_FACE;
+                    bcValW_[i] = bcVal;
+                    break;
+                case FaceDirection::ERROR:
+                    throw std::runtime_error("Invalid FaceDirection in Dirichlet boundary condition");
+            }
+        };
+
+        for(int i = 0; i < nInteriorPoints_; i++){
+            nbrN_[i] = neighbor_point(FaceDirection::NORTH, i);
+            nbrS_[i] = neighbor_point(FaceDirection::SOUTH, i);
+            nbrE_[i] = neighbor_point(FaceDirection::EAST, i);
+            nbrW_[i] = neighbor_point(FaceDirection::WEST, i);
+
+            const Point* point = points_[i].get();
+            switch(point->bcType()){
+                case BoundaryConditionFlag::INTERIOR:
+                    continue;
+                case BoundaryConditionFlag::DIRICHLET_INT_BPOINT:
+                    break;
+                case BoundaryConditionFlag::PERIODIC_INT_BPOINT:
+                    throw std::runtime_error("Periodic BCs not yet implemented.");
+                default:
+                    throw std::runtime_error("Interior boundary point has invalid bcType");
+            }
+            setBoundaryFace(i, point->bcDirection(), point->bcVal());
+            if(point->secondBoundaryConds()){
+                BoundaryCondDescription bc_2 = point->secondBoundaryConds().value();
+                if(bc_2.direction != FaceDirection::EAST && bc_2.direction != FaceDirection::WEST){
+                    throw std::runtime_error("Can't have anything but EAST or WEST as secondary BC!");
+                }
+                setBoundaryFace(i, bc_2.direction, bc_2.bcVal);
+            }
+        }
+
+        ghostCorr_.resize(nGhostPoints_);
+        ghostBcVal_.resize(nGhostPoints_);
+        for(int g = 0; g < nGhostPoints_; g++){
+            const Point* ghost = points_[nInteriorPoints_ + g].get();
+            switch(ghost->bcType()){
+                case BoundaryConditionFlag::DIRICHLET_GHOSTPOINT:
+                    break;
+                case BoundaryConditionFlag::PERIODIC_GHOSTPOINT:
+                    throw std::runtime_error("Periodic BCs not yet implemented.");
+                default:
+                    throw std::runtime_error("Chosen boundary condition not implemented yet");
+            }
+            ghostCorr_[g] = ghost->corrPoint();
+            ghostBcVal_[g] = ghost->bcVal();
+        }
+    }
     
 void sor_solve(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const Eigen::VectorXd &rhs, Eigen::VectorXd &phi, double omega, double threshold, int n_iters) {
     /*
@@ -667,4 +753,91 @@ void sor_solve(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const Eige
 
 }
 
+MatrixColoring greedyColoring(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A) {
+    //Two rows are coupled if either references the other, so colour the symmetrized pattern.
+    Eigen::SparseMatrix<double, Eigen::RowMajor> AT = A.transpose();
+    const int nRows = A.rows();
+    std::vector<int> color(nRows, -1);
+    std::vector<int> colorCount;
+    std::vector<int> lastSeen; //lastSeen[c] == i if colour c is used by a neighbour of row i
+    for (int i = 0; i < nRows; i++) {
+        auto markNeighbours = [&](const Eigen::SparseMatrix<double, Eigen::RowMajor> &M) {
+            for (Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(M, i); it; ++it) {
+                int c = color[it.col()];
+                if (it.col() != i && c >= 0) lastSeen[c] = i;
+            }
+        };
+        markNeighbours(A);
+        markNeighbours(AT);
+        int c = 0;
+        while (c < static_cast<int>(lastSeen.size()) && lastSeen[c] == i) c++;
+        if (c == static_cast<int>(lastSeen.size())) {
+            lastSeen.push_back(-1);
+            colorCount.push_back(0);
+        }
+        color[i] = c;
+        colorCount[c]++;
+    }
+
+    MatrixColoring coloring;
+    coloring.colorStart.resize(colorCount.size() + 1, 0);
+    for (std::size_t c = 0; c < colorCount.size(); c++) {
+        coloring.colorStart[c + 1] = coloring.colorStart[c] + colorCount[c];
+    }
+    coloring.rows.resize(nRows);
+    std::vector<int> fill(coloring.colorStart.begin(), coloring.colorStart.end() - 1);
+    for (int i = 0; i < nRows; i++) {
+        coloring.rows[fill[color[i]]++] = i;
+    }
+    return coloring;
+}
+
+void multicolor_sor_solve(const Eigen::SparseMatrix<double, Eigen::RowMajor> &A, const MatrixColoring &coloring, const Eigen::VectorXd &rhs, Eigen::VectorXd &phi,
+                          double omega, double threshold, int n_iters, bool parallel) {
+    const double* valuePtr = A.valuePtr();
+    const int* innerIdxPtr = A.innerIndexPtr();
+    const int* outerIdxPtr = A.outerIndexPtr();
+    const int* rows = coloring.rows.data();
+    const int nColors = coloring.nColors();
+    const double rhsNorm = rhs.lpNorm<2>();
+
+    double residual = 1;
+    while(residual > threshold){
+        #pragma omp parallel if(parallel) default(shared)
+        for(int iteration = 0; iteration < n_iters; iteration++){
+            for(int c = 0; c < nColors; c++){
+                #pragma omp for schedule(static)
+                for(int k = coloring.colorStart[c]; k < coloring.colorStart[c + 1]; k++){
+                    const int i = rows[k];
+                    double diagCoeff = 0;
+                    double x_i = rhs[i];
+                    for (int j = outerIdxPtr[i]; j < outerIdxPtr[i + 1]; j++) {
+                        if (innerIdxPtr[j] == i) {
+                            diagCoeff = valuePtr[j];
+                            continue;
+                        }
+                        x_i -= valuePtr[j] * phi[innerIdxPtr[j]];
+                    }
+                    x_i *= omega / diagCoeff;
+                    x_i += (1 - omega) * phi[i];
+                    phi[i] = x_i;
+                }
+            }
+        }
+
+        //Residual ||b - A*phi|| of the iterate after the sweeps, as in sor_solve
+        double sqResidual = 0;
+        #pragma omp parallel for if(parallel) default(shared) schedule(static) reduction(+:sqResidual)
+        for(int i = 0; i < A.rows(); i++){
+            double r_i = rhs[i];
+            for (int j = outerIdxPtr[i]; j < outerIdxPtr[i + 1]; j++) {
+                r_i -= valuePtr[j] * phi[innerIdxPtr[j]];
+            }
+            sqResidual += r_i * r_i;
+        }
+        residual = sqrt(sqResidual) / rhsNorm;
+        if (isnan(residual)) throw std::runtime_error("NaN residual encountered");
+    }
+}
+
 }
\ No newline at end of file
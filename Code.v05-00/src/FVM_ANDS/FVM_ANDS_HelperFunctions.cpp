@@ -27,7 +27,8 @@ namespace FVM_ANDS{
         }
         return std2dVec;    
     }
-    BoundaryConditions bcFrom2DVector(const Vector_2D& initialVec, bool zeroBC){
+    template<typename Field2D>
+    static BoundaryConditions bcFrom2DField(const Field2D& initialVec, bool zeroBC){
         int ny = initialVec.size();
         int nx = initialVec[0].size();
         BoundaryConditions bc;
@@ -52,5 +53,25 @@ namespace FVM_ANDS{
         }
         return bc;
     }
+    BoundaryConditions bcFrom2DVector(const Vector_2D& initialVec, bool zeroBC){
+        return bcFrom2DField(initialVec, zeroBC);
+    }
+    BoundaryConditions bcFrom2DVector(Field_3D::ConstBinView initialVec, bool zeroBC){
+        return bcFrom2DField(initialVec, zeroBC);
+    }
+
+    DiffusionSolver diffusionSolverFromString(const std::string& name){
+        if(name == "SOR") return DiffusionSolver::SOR;
+        if(name == "MulticolorSOR") return DiffusionSolver::MulticolorSOR;
+        if(name == "ADI") return DiffusionSolver::ADI;
+        if(name == "Spectral") return DiffusionSolver::Spectral;
+        throw std::invalid_argument("Unknown diffusion solver: " + name);
+    }
+
+    AdvectionScheme advectionSchemeFromString(const std::string& name){
+        if(name == "MinMod") return AdvectionScheme::MinMod;
+        if(name == "SemiLagrangian") return AdvectionScheme::SemiLagrangian;
+        throw std::invalid_argument("Unknown advection scheme: " + name);
+    }
 
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include <math.h>
+#include "Util/Timing.hpp"
+#include "FVM_ANDS/FVM_BatchSolver.hpp"
+namespace FVM_ANDS{
+    FVM_BatchSolver::FVM_BatchSolver(const AdvDiffParams& params, const Vector_1D& xCoords, const Vector_1D& yCoords, const BoundaryConditions& bc)
+    :   advDiffSys_(AdvDiffSystem(params, xCoords, yCoords, bc, Eigen::VectorXd::Zero(xCoords.size() * yCoords.size()))),
+        matrixBuilt_(false),
+        diffusionSolver_(DiffusionSolver::SOR),
+        advectionScheme_(AdvectionScheme::MinMod) { }
+
+    void FVM_BatchSolver::buildDiffusionMatrix(){
+        //Diffusion matrix does not depend on the field or its settling velocity, so build it once for all fields.
+        //ADI and spectral solves work directly on the grid and don't need the matrix.
+        if(matrixBuilt_ || diffusionSolver_ == DiffusionSolver::ADI || diffusionSolver_ == DiffusionSolver::Spectral) return;
+        Timing::Scope timer("Diffusion matrix");
+        advDiffSys_.buildCoeffMatrix(true);
+        matrixBuilt_ = true;
+    }
+
+    void FVM_BatchSolver::operatorSplitSolve2DVec(Field_3D& fields, const Vector_1D& v, bool parallel, double courant_max){
+        if(fields.size() != v.size()){
+            throw std::runtime_error("FVM_BatchSolver: number of fields and settling velocities differ!");
+        }
+        buildDiffusionMatrix();
+
+        #pragma omp parallel if(parallel) default(shared)
+        {
+            //Per-thread work vectors, reused for every field handled by this thread
+            Eigen::VectorXd phi(advDiffSys_.nTotalPoints());
+            Eigen::VectorXd work(advDiffSys_.nTotalPoints());
+
+            #pragma omp for schedule(dynamic)
+            for(std::size_t n = 0; n < fields.size(); n++){
+                solveField(fields.binMatrix(n), v[n], courant_max, false, phi, work);
+            }
+        }
+    }
+
+    void FVM_BatchSolver::operatorSplitSolve2DVec(Vector_2D& field, double v, bool parallel, double courant_max){
+        buildDiffusionMatrix();
+        const int ny = field.size();
+        const int nx = ny > 0 ? field[0].size() : 0;
+        Field_3D::RowMajorMatrix fieldMatrix(ny, nx);
+        for(int j = 0; j < ny; j++){
+            std::copy(field[j].begin(), field[j].end(), fieldMatrix.row(j).data());
+        }
+        Eigen::VectorXd phi(advDiffSys_.nTotalPoints());
+        Eigen::VectorXd work(advDiffSys_.nTotalPoints());
+        solveField(Field_3D::BinMap(fieldMatrix.data(), ny, nx), v, courant_max, parallel, phi, work);
+        for(int j = 0; j < ny; j++){
+            std::copy(fieldMatrix.row(j).data(), fieldMatrix.row(j).data() + nx, field[j].begin());
+        }
+    }
+
+    void FVM_BatchSolver::solveField(Field_3D::BinMap field, double v, double courant_max, bool parallelDiffusion, Eigen::VectorXd& phi, Eigen::VectorXd& work) const{
+        const int ny = field.rows();
+        const int nx = field.cols();
+
+        //Same cutoff as FVM_Solver::operatorSplitSolve2DVec: leave fields that are numerically zero untouched.
+        const double VECTORNORM_MIN = 1e-100;
+        if(field.squaredNorm() < VECTORNORM_MIN){
+            return;
+        }
+        //Interior points of phi are column-major (index ny*i + j), the field is row-major (ny x nx)
+        phi.resize(advDiffSys_.nTotalPoints());
+        Eigen::Map<Eigen::MatrixXd> phiInterior(phi.data(), ny, nx);
+        phiInterior = field;
+        advDiffSys_.applyBoundaryCondition(phi);
+
+        //Strang Splitting, see FVM_Solver::operatorSplitSolve
+        advectionHalfStep(phi, v, courant_max, false, work);
+
+        advDiffSys_.calcRHS(phi, v, work);
+        switch(diffusionSolver_){
+            case DiffusionSolver::SOR:
+                FVM_ANDS::sor_solve(advDiffSys_.getCoefMatrix(), work, phi);
+                break;
+            case DiffusionSolver::MulticolorSOR:
+                FVM_ANDS::multicolor_sor_solve(advDiffSys_.getCoefMatrix(), advDiffSys_.coloring(), work, phi, 1.0, 1e-3, 3, parallelDiffusion);
+                break;
+            case DiffusionSolver::ADI:
+                advDiffSys_.adiDiffusionSolve(work, phi, parallelDiffusion);
+                break;
+            case DiffusionSolver::Spectral:
+                advDiffSys_.spectralDiffusionSolve(work, phi);
+                break;
+        }
+
+        advectionHalfStep(phi, v, courant_max, true, work);
+
+        field = Eigen::Map<const Eigen::MatrixXd>(phi.data(), ny, nx);
+    }
+
+    void FVM_BatchSolver::advectionHalfStep(Eigen::VectorXd& phi, double v, double courant_max, bool secondHalf, Eigen::VectorXd& work) const{
+        const int nInterior = advDiffSys_.nInteriorPoints();
+        const double dt_max = advDiffSys_.timestep();
+
+        if(advectionScheme_ == AdvectionScheme::SemiLagrangian){
+            advDiffSys_.semiLagrangianAdvection(phi, v, 0.5 * dt_max, work, secondHalf);
+            phi.head(nInterior) = work.head(nInterior);
+            advDiffSys_.applyBoundaryCondition(phi);
+            return;
+        }
+
+        double courant = advDiffSys_.courant(v);
+        double dt_adv = dt_max * (courant_max / courant);
+
+        int n_timesteps_advection_half =  std::ceil((0.5 * dt_max) / dt_adv);
+        dt_adv = (0.5 * dt_max) / n_timesteps_advection_half;
+
+        for(int i = 0; i < n_timesteps_advection_half; i++){
+            advDiffSys_.forwardEulerAdvection(phi, v, dt_adv, work);
+            phi.head(nInterior) = work.head(nInterior);
+            advDiffSys_.applyBoundaryCondition(phi);
+        }
+    }
+}
@@ -1,10 +1,13 @@
+#include "Util/Timing.hpp"
 #include "FVM_ANDS/FVM_Solver.hpp"
 namespace FVM_ANDS{
     FVM_Solver::FVM_Solver(const AdvDiffParams& params, const Vector_1D xCoords, const Vector_1D yCoords, const BoundaryConditions& bc, const Eigen::VectorXd& phi_init, bool useDiagPreCond, int maxIters, double convergenceThres)
     :   maxIters_(maxIters),
         convergenceThres_(convergenceThres),
         advDiffSys_(AdvDiffSystem(params, xCoords, yCoords, bc, phi_init)),
-        useDiagPreCond_(useDiagPreCond){
+        useDiagPreCond_(useDiagPreCond),
+        diffusionSolver_(DiffusionSolver::SOR),
+        advectionScheme_(AdvectionScheme::MinMod){
         solver_.setTolerance(convergenceThres_);
         solver_.setMaxIterations(maxIters_);
 
@@ -18,7 +21,6 @@ namespace FVM_ANDS{
     }
     
     const Eigen::VectorXd& FVM_Solver::solve(){
-        //auto start = std::chrono::high_resolution_clock::now();
         advDiffSys_.buildCoeffMatrix();
         advDiffSys_.calcRHS();
         auto mat = advDiffSys_.getCoefMatrix();
@@ -57,65 +59,77 @@ namespace FVM_ANDS{
 
     const Eigen::VectorXd& FVM_Solver::operatorSplitSolve(bool parallelAdvection, double courant_max) {
         //Strang Splitting
-        //Step 1: Calculate explicit advection timestep based on CFL condition set
-
         bool operatorSplit = true;
-        double courant = advDiffSys_.courant();
-        double dt_max = advDiffSys_.timestep();
-        double dt_adv = dt_max * (courant_max / courant);
-
-        int n_timesteps_advection_half =  std::ceil((0.5 * dt_max) / dt_adv);
-        dt_adv = (0.5 * dt_max) / n_timesteps_advection_half;
 
-        // auto start = std::chrono::high_resolution_clock::now();
+        //Step 1: Solve Advection for half timestep
+        {
+            Timing::Scope timer("Advection");
+            advectionHalfStep(false, parallelAdvection, courant_max);
+        }
 
-        //Step 2: Solve Advection for half timestep
-        advDiffSys_.updateTimestep(dt_adv);
-        for(int i = 0; i < n_timesteps_advection_half; i++){
-            advDiffSys_.updatePhi(advDiffSys_.forwardEulerAdvection(operatorSplit, parallelAdvection));
-            advDiffSys_.applyBoundaryCondition();
+        //Step 2: Implicitly solve diffusion (first to help smoothen out potential steep gradients)
+        //Only refreshes the matrix values, the sparsity pattern is cached in AdvDiffSystem
+        //ADI and spectral solves work directly on the grid and don't need the matrix.
+        {
+            Timing::Scope timer("Diffusion");
+            if(diffusionSolver_ == DiffusionSolver::SOR || diffusionSolver_ == DiffusionSolver::MulticolorSOR){
+                Timing::Scope matrixTimer("Diffusion matrix");
+                advDiffSys_.buildCoeffMatrix(operatorSplit);
+            }
+            advDiffSys_.calcRHS();
+            diffusionSolve(parallelAdvection);
         }
 
-        // auto stop = std::chrono::high_resolution_clock::now();
-        // auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop-start);
-        // std::cout << "First Halfstep Advection Solve Time: " << duration.count() << std::endl;
+        //Step 3: Solve advection to full timestep
+        {
+            Timing::Scope timer("Advection");
+            advectionHalfStep(true, false, courant_max);
+        }
 
-        // start = std::chrono::high_resolution_clock::now();
+        return advDiffSys_.phi();
+    }
 
-        //Step 3: Implicitly solve diffusion (first to help smoothen out potential steep gradients)
-        advDiffSys_.updateTimestep(dt_max);
-        //Build matrix takes ~40ms atm
-        advDiffSys_.buildCoeffMatrix(operatorSplit);
-        advDiffSys_.calcRHS();
+    void FVM_Solver::advectionHalfStep(bool secondHalf, bool parallelAdvection, double courant_max){
+        bool operatorSplit = true;
+        double dt_max = advDiffSys_.timestep();
 
-        // auto mat = advDiffSys_.getCoefMatrix();
-        // auto b = advDiffSys_.getRHS();
-        // solver_.compute(mat);
-        // Eigen::VectorXd solution = solver_.solveWithGuess(b, advDiffSys_.phi());
-        // advDiffSys_.updatePhi(std::move(solution));
-        
-        advDiffSys_.sor_solve();
+        if(advectionScheme_ == AdvectionScheme::SemiLagrangian){
+            //Rows then columns in the first half, columns then rows in the second, so the full step is symmetric
+            advDiffSys_.updatePhi(advDiffSys_.semiLagrangianAdvection(0.5 * dt_max, secondHalf, parallelAdvection));
+            advDiffSys_.applyBoundaryCondition();
+            return;
+        }
 
-        // stop = std::chrono::high_resolution_clock::now();
-        // duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop-start);
-        // std::cout << "Diffusion Solve Time: " << duration.count() << std::endl;
+        //Explicit advection timestep based on CFL condition set
+        double courant = advDiffSys_.courant();
+        double dt_adv = dt_max * (courant_max / courant);
 
-        //Step 4: Explicitly solve advection to full timestep
+        int n_timesteps_advection_half =  std::ceil((0.5 * dt_max) / dt_adv);
+        dt_adv = (0.5 * dt_max) / n_timesteps_advection_half;
 
-        // start = std::chrono::high_resolution_clock::now();
         advDiffSys_.updateTimestep(dt_adv);
         for(int i = 0; i < n_timesteps_advection_half; i++){
-            advDiffSys_.updatePhi(advDiffSys_.forwardEulerAdvection(operatorSplit));
+            advDiffSys_.updatePhi(advDiffSys_.forwardEulerAdvection(operatorSplit, parallelAdvection));
             advDiffSys_.applyBoundaryCondition();
         }
-
         advDiffSys_.updateTimestep(dt_max);
+    }
 
-        // stop = std::chrono::high_resolution_clock::now();
-        // duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop-start);
-        // std::cout << "Advection second step Solve Time: " << duration.count() << std::endl;
-
-        return advDiffSys_.phi();
+    void FVM_Solver::diffusionSolve(bool parallel){
+        switch(diffusionSolver_){
+            case DiffusionSolver::SOR:
+                advDiffSys_.sor_solve();
+                break;
+            case DiffusionSolver::MulticolorSOR:
+                advDiffSys_.multicolor_sor_solve(1.0, 1e-3, 3, parallel);
+                break;
+            case DiffusionSolver::ADI:
+                advDiffSys_.adiDiffusionSolve(parallel);
+                break;
+            case DiffusionSolver::Spectral:
+                advDiffSys_.spectralDiffusionSolve();
+                break;
+        }
     }
 
     void FVM_Solver::operatorSplitSolve2DVec(Vector_2D& vec, const BoundaryConditions& bc, bool parallelAdvection, double courant_max ) { 
@@ -132,24 +146,28 @@ namespace FVM_ANDS{
         vec = eigenVec_to_std2dVec(operatorSplitSolve(parallelAdvection, courant_max), vec[0].size(), vec.size());
     }
 
+    void FVM_Solver::operatorSplitSolve2DVec(Field_3D::BinView bin, const BoundaryConditions& bc, bool parallelAdvection, double courant_max ) { 
+        const int ny = bin.ny();
+        const int nx = bin.nx();
+        //Interior points are column-major (index ny*i + j), the bin is row-major (ny x nx)
+        Eigen::VectorXd vec_Eigen(nx * ny);
+        Eigen::Map<Eigen::MatrixXd>(vec_Eigen.data(), ny, nx) = bin.matrix();
+        const double VECTORNORM_MIN = 1e-100;
+        if(eigenSqVectorNorm_double(vec_Eigen) < VECTORNORM_MIN){
+            return;
+        }
+        advDiffSys_.updatePhi(vec_Eigen);
+        advDiffSys_.updateBoundaryCondition(bc);
+        const Eigen::VectorXd& soln = operatorSplitSolve(parallelAdvection, courant_max);
+        bin.matrix() = Eigen::Map<const Eigen::MatrixXd>(soln.data(), ny, nx);
+    }
+
     void FVM_Solver::advectionHalfTimestepSolve(Vector_2D& vec, const BoundaryConditions& bc, double courant_max){
         Eigen::VectorXd vec_Eigen = std2dVec_to_eigenVec(vec);
         advDiffSys_.updatePhi(vec_Eigen);
         advDiffSys_.updateBoundaryCondition(bc);
 
-        bool operatorSplit = true;
-        double courant = advDiffSys_.courant();
-        double dt_max = advDiffSys_.timestep();
-        double dt_adv = dt_max * (courant_max / courant);
-
-        int n_timesteps_advection_half =  std::ceil((0.5 * dt_max) / dt_adv);
-        dt_adv = (0.5 * dt_max) / n_timesteps_advection_half;
-
-        advDiffSys_.updateTimestep(dt_adv);
-        for(int i = 0; i < n_timesteps_advection_half; i++){
-            advDiffSys_.updatePhi(advDiffSys_.forwardEulerAdvection(operatorSplit));
-            advDiffSys_.applyBoundaryCondition();
-        } 
+        advectionHalfStep(false, false, courant_max);
         vec = eigenVec_to_std2dVec(advDiffSys_.phi(), vec[0].size(), vec.size());
     }
 
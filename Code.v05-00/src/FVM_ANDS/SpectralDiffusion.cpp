@@ -0,0 +1,148 @@
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <fftw3.h>
+#include "Util/PhysConstant.hpp"
+#include "FVM_ANDS/SpectralDiffusion.hpp"
+
+namespace FVM_ANDS{
+    namespace {
+        struct SineTransformPlans {
+            fftw_plan forward;  // DST-II, buffer a -> buffer b
+            fftw_plan backward; // DST-III, buffer b -> buffer a
+        };
+
+        // FFTW planning and plan destruction are not thread-safe, so both are serialized here.
+        std::mutex planMutex;
+
+        // LAGRID remaps change the grid size almost every step, so only the most recently used plans are kept.
+        // Plans are shared with the solves executing them and destroyed once the last user releases them.
+        const std::size_t MAX_CACHED_PLANS = 16;
+        struct CachedPlans {
+            std::pair<int, int> size;
+            std::shared_ptr<const SineTransformPlans> plans;
+            std::uint64_t lastUse;
+        };
+        std::vector<CachedPlans> planCache;
+        std::uint64_t useCount = 0;
+
+        bool useWisdom = false;
+        bool wisdomImported = false;
+        // Set when plans were measured since the wisdom was last written
+        bool wisdomChanged = false;
+        std::filesystem::path wisdomFile;
+
+        void destroyPlans(const SineTransformPlans* plans){
+            std::lock_guard<std::mutex> lock(planMutex);
+            fftw_destroy_plan(plans->forward);
+            fftw_destroy_plan(plans->backward);
+            delete plans;
+        }
+
+        std::shared_ptr<const SineTransformPlans> sineTransformPlans(int n0, int n1){
+            //Declared before the lock so that evicted plans are destroyed after it is released
+            std::shared_ptr<const SineTransformPlans> evicted;
+            std::lock_guard<std::mutex> lock(planMutex);
+            useCount++;
+            for(auto& entry: planCache){
+                if(entry.size == std::make_pair(n0, n1)){
+                    entry.lastUse = useCount;
+                    return entry.plans;
+                }
+            }
+
+            if(useWisdom && !wisdomImported){
+                fftw_import_wisdom_from_filename(wisdomFile.c_str());
+                wisdomImported = true;
+            }
+            //Planning with FFTW_MEASURE overwrites the arrays, so plan on scratch buffers.
+            //Execution later uses fftw_execute_r2r on other fftw_malloc'd buffers of the same size.
+            double* a = static_cast<double*>(fftw_malloc(sizeof(double) * n0 * n1));
+            double* b = static_cast<double*>(fftw_malloc(sizeof(double) * n0 * n1));
+            const unsigned flags = useWisdom ? FFTW_MEASURE : FFTW_ESTIMATE;
+            SineTransformPlans* plans = new SineTransformPlans;
+            plans->forward = fftw_plan_r2r_2d(n0, n1, a, b, FFTW_RODFT10, FFTW_RODFT10, flags);
+            plans->backward = fftw_plan_r2r_2d(n0, n1, b, a, FFTW_RODFT01, FFTW_RODFT01, flags);
+            fftw_free(a);
+            fftw_free(b);
+            wisdomChanged = wisdomChanged || useWisdom;
+
+            std::shared_ptr<const SineTransformPlans> shared(plans, destroyPlans);
+            if(planCache.size() < MAX_CACHED_PLANS){
+                planCache.push_back({std::make_pair(n0, n1), shared, useCount});
+                return shared;
+            }
+            auto oldest = std::min_element(planCache.begin(), planCache.end(), [](const CachedPlans& x, const CachedPlans& y){
+                return x.lastUse < y.lastUse;
+            });
+            evicted = std::move(oldest->plans);
+            *oldest = {std::make_pair(n0, n1), shared, useCount};
+            return shared;
+        }
+
+        // Eigenvalues of -d2/dx2 (5-point stencil, cell-centred, ghost = -phi at both ends) for sine mode k = 0 ... n-1,
+        // turned into the decay factor exp(-dt * D * lambda_k)
+        std::vector<double> decayFactors(int n, double h, double D, double dt){
+            std::vector<double> factors(n);
+            for(int k = 0; k < n; k++){
+                const double s = std::sin(physConst::PI * (k + 1) / (2.0 * n));
+                factors[k] = std::exp(-dt * D * 4.0 * s * s / (h * h));
+            }
+            return factors;
+        }
+    }
+
+    void setFFTWWisdom(bool enable, const std::string& wisdomDir){
+        std::lock_guard<std::mutex> lock(planMutex);
+        useWisdom = enable;
+        wisdomFile = std::filesystem::path(wisdomDir) / "FFTW_Wisdom.out";
+        wisdomImported = false;
+        wisdomChanged = false;
+    }
+
+    void exportFFTWWisdom(){
+        std::lock_guard<std::mutex> lock(planMutex);
+        if(!useWisdom || !wisdomChanged) return;
+        //Write next to the wisdom file and rename, so processes sharing the directory never read a partial file
+        std::filesystem::path tmpFile = wisdomFile;
+        tmpFile += "." + std::to_string(getpid());
+        if(fftw_export_wisdom_to_filename(tmpFile.c_str())){
+            std::error_code ec;
+            std::filesystem::rename(tmpFile, wisdomFile, ec);
+        }
+        wisdomChanged = false;
+    }
+
+    void spectralDiffusionPropagate(const double* phi_in, double* phi_out, int n0, int n1, double h0, double h1, double D0, double D1, double dt){
+        const int n = n0 * n1;
+        if(n == 0) return;
+        const std::shared_ptr<const SineTransformPlans> plans = sineTransformPlans(n0, n1);
+
+        double* a = static_cast<double*>(fftw_malloc(sizeof(double) * n));
+        double* b = static_cast<double*>(fftw_malloc(sizeof(double) * n));
+        std::copy(phi_in, phi_in + n, a);
+        fftw_execute_r2r(plans->forward, a, b);
+
+        //DST-III(DST-II(x)) = 2*n0 * 2*n1 * x, fold the normalization into the decay factors
+        const double norm = 1.0 / (4.0 * n0 * n1);
+        const std::vector<double> decay0 = decayFactors(n0, h0, D0, dt);
+        const std::vector<double> decay1 = decayFactors(n1, h1, D1, dt);
+        for(int k0 = 0; k0 < n0; k0++){
+            const double f0 = decay0[k0] * norm;
+            for(int k1 = 0; k1 < n1; k1++){
+                b[k0 * n1 + k1] *= f0 * decay1[k1];
+            }
+        }
+
+        fftw_execute_r2r(plans->backward, b, a);
+        std::copy(a, a + n, phi_out);
+        fftw_free(a);
+        fftw_free(b);
+    }
+}
@@ -0,0 +1,109 @@
+#include <cmath>
+#include <stdexcept>
+#include "LAGRID/RemapOperator.hpp"
+
+namespace LAGRID {
+    namespace {
+        Vector_1D cellCenters(double x0, double dx, int n) {
+            Vector_1D coords(n);
+            std::generate(coords.begin(), coords.end(), [x0, dx, i = 0] () mutable { return x0 + dx * ( (i++) + 0.5);});
+            return coords;
+        }
+    }
+
+    RemapOperator::RemapOperator(const Vector_1D& dy_new, double dx_old, double x0_old, double y0_new, const vector<vector<int>>& mask,
+                                 const Remapping& remapping, double bufLen_left, double bufLen_right, double bufLen_top, double bufLen_bot):
+        nySource_(mask.size()),
+        nxSource_(mask.empty() ? 0 : mask[0].size()),
+        unusedFraction_(Vector_2D(remapping.ny, Vector_1D(remapping.nx, 1.0)),
+                        cellCenters(remapping.x0, remapping.dx, remapping.nx),
+                        cellCenters(remapping.y0, remapping.dy, remapping.ny))
+    {
+        //Buffer offsets of the unbuffered remapping grid, computed as in twoDGridVariable::addBuffer
+        const int numRows_botBuffer = std::floor(bufLen_bot / unusedFraction_.dy);
+        const int numCols_leftBuffer = std::floor(bufLen_left / unusedFraction_.dx);
+        Vector_2D& frac_unused = unusedFraction_.phi;
+        unusedFraction_.addBuffer(bufLen_left, bufLen_right, bufLen_top, bufLen_bot, 1.0);
+        const int nx_out = unusedFraction_.xCoords.size();
+        const int ny_out = unusedFraction_.yCoords.size();
+
+        //Rebuild the unbuffered unused fraction while walking the boxes, then copy it into the buffered grid
+        Vector_2D frac(remapping.ny, Vector_1D(remapping.nx, 1.0));
+        const double cellArea = remapping.dx * remapping.dy;
+        std::vector<Eigen::Triplet<double>> triplets;
+
+        //Same box geometry and ordering as rectToBoxGrid, see FreeCoordBoxGrid's mask constructor
+        double curr_y = y0_new;
+        for(std::size_t j = 0; j < nySource_; j++) {
+            double curr_x = x0_old;
+            for(std::size_t i = 0; i < nxSource_; i++) {
+                if(mask[j][i] == 0) {
+                    curr_x += dx_old;
+                    continue;
+                }
+                const MassBox b(curr_x, curr_y + dy_new[j], curr_x + dx_old, curr_y, dx_old * dy_new[j]);
+                const int sourceIdx = j * nxSource_ + i;
+
+                //Same index bounding as mapToStructuredGrid
+                int startGridIdx_x = std::max(std::floor((b.topLeftX - remapping.x0) / remapping.dx), 0.0);
+                int endGridIdx_x = std::min(std::floor((b.botRightX - remapping.x0) / remapping.dx), static_cast<double>(remapping.nx - 1));
+                int startGridIdx_y = std::max(std::floor((b.botRightY - remapping.y0) / remapping.dy), 0.0);
+                int endGridIdx_y = std::min(std::floor((b.topLeftY - remapping.y0) / remapping.dy), static_cast<double>(remapping.ny - 1));
+
+                for (int jj = startGridIdx_y; jj <= endGridIdx_y; jj++) {
+                    for(int ii = startGridIdx_x; ii <= endGridIdx_x; ii++) {
+                        double area = coveredArea(remapping, b, ii, jj);
+                        frac[jj][ii] -= area / cellArea;
+                        //b.mass holds the cell area, i.e. the mass for a unit concentration
+                        const int targetIdx = (jj + numRows_botBuffer) * nx_out + ii + numCols_leftBuffer;
+                        triplets.emplace_back(targetIdx, sourceIdx, (b.mass * area / b.area()) / cellArea);
+                    }
+                }
+                curr_x += dx_old;
+            }
+            curr_y += dy_new[j];
+        }
+
+        for(int jj = 0; jj < remapping.ny; jj++) {
+            std::copy(frac[jj].begin(), frac[jj].end(), frac_unused[jj + numRows_botBuffer].begin() + numCols_leftBuffer);
+        }
+
+        weights_.resize(ny_out * nx_out, nySource_ * nxSource_);
+        weights_.setFromTriplets(triplets.begin(), triplets.end());
+    }
+
+    void RemapOperator::checkSourceDims(std::size_t ny, std::size_t nx) const {
+        if(ny != nySource_ || nx != nxSource_) {
+            throw std::invalid_argument("RemapOperator: field dimensions do not match the remapping mask");
+        }
+    }
+
+    Vector_2D RemapOperator::apply(const Vector_2D& phi) const {
+        checkSourceDims(phi.size(), phi.empty() ? 0 : phi[0].size());
+        Field_3D::RowMajorMatrix source(nySource_, nxSource_);
+        for(std::size_t j = 0; j < nySource_; j++) {
+            std::copy(phi[j].begin(), phi[j].end(), source.row(j).data());
+        }
+        return apply(Field_3D::ConstBinView(source.data(), nySource_, nxSource_));
+    }
+
+    Vector_2D RemapOperator::apply(Field_3D::ConstBinView phi) const {
+        checkSourceDims(phi.ny(), phi.nx());
+        const Eigen::VectorXd remapped = weights_ * Eigen::Map<const Eigen::VectorXd>(phi.data(), nySource_ * nxSource_);
+        Vector_2D phi_new(ny(), Vector_1D(nx()));
+        for(std::size_t j = 0; j < ny(); j++) {
+            std::copy(remapped.data() + j * nx(), remapped.data() + (j + 1) * nx(), phi_new[j].begin());
+        }
+        return phi_new;
+    }
+
+    Field_3D RemapOperator::apply(const Field_3D& phi) const {
+        checkSourceDims(phi.ny(), phi.nx());
+        Field_3D phi_new(phi.nBin(), ny(), nx());
+        //With the [bin][y][x] layout, every bin is one column of a (ny * nx) x nBin column-major matrix
+        Eigen::Map<const Eigen::MatrixXd> source(phi.data(), nySource_ * nxSource_, phi.nBin());
+        Eigen::Map<Eigen::MatrixXd> target(phi_new.data(), ny() * nx(), phi.nBin());
+        target.noalias() = weights_ * source;
+        return phi_new;
+    }
+}
@@ -10,30 +10,55 @@
 /* File                 : MC_Rand.cpp                               */
 /*                                                                  */
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#include <atomic>
+#include <ctime>
 #include <iostream>
 #include "APCEMM.h"
 #include "Util/MC_Rand.hpp"
 
+namespace {
+    std::atomic<std::uint32_t> seed{0};
+    /* Number of draws made by fRand */
+    std::atomic<std::uint64_t> nDraws{0};
+}
+
 void setSeed() {
 
     // Sets seed for pseudo-random generator.
     #ifdef DEBUG
         // With DEBUG compile flag set a constant seed for reproducibility
         std::cout << "Compiled in DEBUG mode: random seed is set to 0 for all simulations" << std::endl;
-        srand(0);
+        seed = 0;
     #else
         // Otherwise use the current unix timestamp as our random seed. 
-        srand(time(NULL));
+        seed = static_cast<std::uint32_t>(time(NULL));
     #endif
+    nDraws = 0;
+
+} /* End of setSeed */
+
+void setSeed( std::uint32_t newSeed ) {
+
+    seed = newSeed;
+    nDraws = 0;
 
 } /* End of setSeed */
 
+std::uint32_t getSeed() {
+
+    return seed;
+
+} /* End of getSeed */
+
 template <typename T>
 T fRand(const T fMin, const T fMax) {
 
     /* Returns a random number between fMin and fMax */
 
-    double f = (double) rand()/RAND_MAX;
+    const std::uint64_t n = nDraws++;
+    const Philox::Counter draw = Philox::generate( { std::uint32_t(n), std::uint32_t(n >> 32), Philox::MONTE_CARLO, 0 }, \
+                                                   { seed, 0 } );
+    double f = Philox::uniform( draw[0], draw[1], 0.0, 1.0 );
     return (T) fMin + f * (fMax - fMin);
 
 } /* End of fRand */
@@ -0,0 +1,198 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/*                                                                  */
+/*     Aircraft Plume Chemistry, Emission and Microphysics Model    */
+/*                             (APCEMM)                             */
+/*                                                                  */
+/* Timing Program File                                              */
+/*                                                                  */
+/* File                 : Timing.cpp                                */
+/*                                                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include "Util/Timing.hpp"
+
+namespace Timing
+{
+    namespace {
+        thread_local Profile* activeProfile = nullptr;
+        thread_local Profile::Thread* activeThread = nullptr;
+
+        void writePhases( std::ostream& os, const std::vector<Profile::Phase>& phases,
+                          const Profile::Phase& phase, const std::string& indent )
+        {
+            os << "[";
+            for ( std::size_t i = 0; i < phase.children.size(); i++ ) {
+                const Profile::Phase& child = phases[phase.children[i]];
+                double childSeconds = 0.0E+00;
+                for ( std::size_t iChild: child.children )
+                    childSeconds += phases[iChild].seconds;
+                os << ( i == 0 ? "\n" : ",\n" ) << indent << "  { \"name\": " << quote( child.name )
+                   << ", \"calls\": " << child.calls
+                   << ", \"total_s\": " << child.seconds
+                   << ", \"self_s\": " << child.seconds - childSeconds
+                   << ", \"phases\": ";
+                writePhases( os, phases, child, indent + "  " );
+                os << " }";
+            }
+            if ( !phase.children.empty() )
+                os << "\n" << indent;
+            os << "]";
+        }
+    }
+
+    Profile::Thread::Thread( const std::string& label ):
+        label_(label)
+    {
+        phases_.push_back( Phase{ "", 0, {} } );
+    }
+
+    std::size_t Profile::Thread::enter( const char* name )
+    {
+        for ( std::size_t child: phases_[current_].children ) {
+            if ( phases_[child].name == name || std::strcmp( phases_[child].name, name ) == 0 ) {
+                current_ = child;
+                return child;
+            }
+        }
+        phases_.push_back( Phase{ name, current_, {} } );
+        const std::size_t child = phases_.size() - 1;
+        phases_[current_].children.push_back( child );
+        current_ = child;
+        return child;
+    }
+
+    void Profile::Thread::leave( std::size_t phase, double seconds )
+    {
+        phases_[phase].calls++;
+        phases_[phase].seconds += seconds;
+        current_ = phases_[phase].parent;
+    }
+
+    Profile::Profile( ):
+        start_(Clock::now())
+    { }
+
+    Profile::Active::Active( Profile& profile, const std::string& label ):
+        previousProfile_(activeProfile),
+        previousThread_(activeThread)
+    {
+        std::lock_guard<std::mutex> lock(profile.mutex_);
+        Thread* thread = nullptr;
+        for ( Thread& t: profile.threads_ ) {
+            if ( t.label() == label )
+                thread = &t;
+        }
+        if ( !thread ) {
+            profile.threads_.emplace_back( label );
+            thread = &profile.threads_.back();
+        }
+        activeProfile = &profile;
+        activeThread = thread;
+    }
+
+    Profile::Active::~Active( )
+    {
+        activeProfile = previousProfile_;
+        activeThread = previousThread_;
+    }
+
+    Profile* Profile::current( )
+    {
+        return activeProfile;
+    }
+
+    const Profile::Phase* Profile::find( const std::string& label, const std::string& path ) const
+    {
+        for ( const Thread& thread: threads_ ) {
+            if ( thread.label() != label )
+                continue;
+            const std::vector<Phase>& phases = thread.phases();
+            std::size_t phase = 0;
+            std::istringstream names( path );
+            std::string name;
+            while ( std::getline( names, name, '/' ) ) {
+                std::size_t next = 0;
+                for ( std::size_t child: phases[phase].children ) {
+                    if ( name == phases[child].name )
+                        next = child;
+                }
+                if ( next == 0 )
+                    return nullptr;
+                phase = next;
+            }
+            return &phases[phase];
+        }
+        return nullptr;
+    }
+
+    double Profile::seconds( const std::string& label, const std::string& path ) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Phase* phase = find( label, path );
+        return phase ? phase->seconds : 0.0E+00;
+    }
+
+    std::uint64_t Profile::calls( const std::string& label, const std::string& path ) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Phase* phase = find( label, path );
+        return phase ? phase->calls : 0;
+    }
+
+    double Profile::elapsed( ) const
+    {
+        return std::chrono::duration<double>( Clock::now() - start_ ).count();
+    }
+
+    void Profile::writeJSON( std::ostream& os, const std::vector<std::pair<std::string, std::string>>& fields ) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto flags = os.flags();
+        os << std::setprecision( 6 ) << "{\n";
+        for ( const auto& field: fields )
+            os << "  " << quote( field.first ) << ": " << field.second << ",\n";
+        os << "  \"wall_s\": " << elapsed() << ",\n";
+        os << "  \"threads\": [";
+        bool first = true;
+        for ( const Thread& thread: threads_ ) {
+            os << ( first ? "\n" : ",\n" ) << "    { \"label\": " << quote( thread.label() ) << ", \"phases\": ";
+            writePhases( os, thread.phases(), thread.phases()[0], "    " );
+            os << " }";
+            first = false;
+        }
+        os << ( threads_.empty() ? "]\n" : "\n  ]\n" ) << "}\n";
+        os.flags( flags );
+    }
+
+    Scope::Scope( const char* name ):
+        thread_(activeThread)
+    {
+        if ( thread_ ) {
+            phase_ = thread_->enter( name );
+            start_ = Clock::now();
+        }
+    }
+
+    Scope::~Scope( )
+    {
+        if ( thread_ )
+            thread_->leave( phase_, std::chrono::duration<double>( Clock::now() - start_ ).count() );
+    }
+
+    std::string quote( const std::string& str )
+    {
+        std::string quoted = "\"";
+        for ( const char c: str ) {
+            if ( c == '"' || c == '\\' )
+                quoted += '\\';
+            if ( static_cast<unsigned char>(c) < 0x20 )
+                quoted += ' ';
+            else
+                quoted += c;
+        }
+        return quoted + "\"";
+    }
+}
@@ -0,0 +1,93 @@
+#include <limits>
+#include <stdexcept>
+#include "YamlInputReader/CaseSpace.hpp"
+
+namespace YamlInputReader{
+    namespace {
+        const std::vector<std::pair<std::string, double CaseParameters::*>> PARAMETER_FIELDS = {
+            {"PLUMEPROCESS", &CaseParameters::simulationTime},
+            {"TEMPERATURE", &CaseParameters::temperature_K},
+            {"RHW", &CaseParameters::relHumidity_w},
+            {"DH", &CaseParameters::horizDiff},
+            {"DV", &CaseParameters::vertiDiff},
+            {"SHEAR", &CaseParameters::shear},
+            {"NBV", &CaseParameters::nBV},
+            {"LONGITUDE", &CaseParameters::longitude_deg},
+            {"LATITUDE", &CaseParameters::latitude_deg},
+            {"PRESSURE", &CaseParameters::pressure_Pa},
+            {"EDAY", &CaseParameters::emissionDOY},
+            {"ETIME", &CaseParameters::emissionTime},
+            {"EI_NOX", &CaseParameters::EI_NOx},
+            {"EI_CO", &CaseParameters::EI_CO},
+            {"EI_UHC", &CaseParameters::EI_HC},
+            {"EI_SO2", &CaseParameters::EI_SO2},
+            {"EI_SO2TOSO4", &CaseParameters::EI_SO2TOSO4},
+            {"EI_SOOT", &CaseParameters::EI_Soot},
+            {"EI_SOOTRAD", &CaseParameters::sootRad},
+            {"FF", &CaseParameters::fuelFlow},
+            {"AMASS", &CaseParameters::aircraftMass},
+            {"FSPEED", &CaseParameters::flightSpeed},
+            {"NUMENG", &CaseParameters::numEngines},
+            {"WINGSPAN", &CaseParameters::wingspan},
+            {"COREEXITTEMP", &CaseParameters::coreExitTemp},
+            {"BYPASSAREA", &CaseParameters::bypassArea},
+            {"BACKG_NOX", &CaseParameters::backgNOx},
+            {"BACKG_HNO3", &CaseParameters::backgHNO3},
+            {"BACKG_O3", &CaseParameters::backgO3},
+            {"BACKG_CO", &CaseParameters::backgCO},
+            {"BACKG_CH4", &CaseParameters::backgCH4},
+            {"BACKG_SO2", &CaseParameters::backgSO2},
+        };
+    }
+
+    CaseSpace::CaseSpace(const std::unordered_map<std::string, Vector_1D>& paramMap):
+        size_(paramMap.empty() ? 0 : 1)
+    {
+        for(const auto& [name, values]: paramMap){
+            double CaseParameters::* field = nullptr;
+            for(const auto& [fieldName, fieldPtr]: PARAMETER_FIELDS){
+                if(fieldName == name) field = fieldPtr;
+            }
+            dims_.push_back({name, values, field});
+
+            if(!values.empty() && size_ > std::numeric_limits<std::size_t>::max() / values.size()){
+                throw std::invalid_argument("Too many cases in parameter sweep!");
+            }
+            size_ *= values.size();
+        }
+        for(const auto& [fieldName, fieldPtr]: PARAMETER_FIELDS){
+            if(paramMap.find(fieldName) == paramMap.end()) missing_.push_back(fieldName);
+        }
+    }
+
+    template<typename F>
+    void CaseSpace::decode(std::size_t iCase, F&& f) const{
+        if(iCase >= size_){
+            throw std::out_of_range("Case " + std::to_string(iCase) + " out of range, parameter sweep has " + std::to_string(size_) + " cases");
+        }
+        for(auto dim = dims_.rbegin(); dim != dims_.rend(); ++dim){
+            const std::size_t nValues = dim->values.size();
+            f(*dim, iCase % nValues);
+            iCase /= nValues;
+        }
+    }
+
+    CaseParameters CaseSpace::parameters(std::size_t iCase) const{
+        if(!missing_.empty()){
+            throw std::invalid_argument("Parameter " + missing_.front() + " is missing from the parameter sweep!");
+        }
+        CaseParameters params;
+        decode(iCase, [&params](const Dimension& dim, std::size_t index){
+            if(dim.field) params.*(dim.field) = dim.values[index];
+        });
+        return params;
+    }
+
+    std::unordered_map<std::string, double> CaseSpace::caseMap(std::size_t iCase) const{
+        std::unordered_map<std::string, double> map;
+        decode(iCase, [&map](const Dimension& dim, std::size_t index){
+            map[dim.name] = dim.values[index];
+        });
+        return map;
+    }
+}
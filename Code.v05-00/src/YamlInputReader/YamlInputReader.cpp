@@ -88,6 +88,12 @@ namespace YamlInputReader{
             input.SIMULATION_OMP_NUM_THREADS = 1;
         #endif
 
+        // Optional, defaults to running one case at a time on all threads
+        input.SIMULATION_PARALLEL_CASES = false;
+        if(simNode["Run cases in parallel (T/F)"]){
+            input.SIMULATION_PARALLEL_CASES = parseBoolString(simNode["Run cases in parallel (T/F)"].as<string>(), "Run cases in parallel (T/F)");
+        }
+
         YAML::Node paramSweepSubmenu = simNode["PARAM SWEEP SUBMENU"];
         input.SIMULATION_PARAMETER_SWEEP = parseBoolString(paramSweepSubmenu["Parameter sweep (T/F)"].as<string>(), "Parameter sweep (T/F");
         input.SIMULATION_MONTECARLO = parseBoolString(paramSweepSubmenu["Run Monte Carlo (T/F)"].as<string>(), "Run Monte Carlo (T/F)");
@@ -119,6 +125,41 @@ namespace YamlInputReader{
         input.SIMULATION_BOXMODEL = parseBoolString(boxModelSubmenu["Run box model (T/F)"].as<string>(), "Run box model (T/F)");
         input.SIMULATION_BOX_FILENAME = boxModelSubmenu["netCDF filename format (string)"].as<string>();
 
+        // Optional, EPM results are reused in memory by default and only kept on disk if a folder is given
+        input.SIMULATION_EPM_CACHE = true;
+        input.SIMULATION_EPM_CACHE_FOLDER = "";
+        if(simNode["EPM CACHE SUBMENU"]){
+            YAML::Node epmCacheSubmenu = simNode["EPM CACHE SUBMENU"];
+            if(epmCacheSubmenu["Reuse EPM results (T/F)"]){
+                input.SIMULATION_EPM_CACHE = parseBoolString(epmCacheSubmenu["Reuse EPM results (T/F)"].as<string>(), "Reuse EPM results (T/F)");
+            }
+            if(epmCacheSubmenu["EPM cache folder (string)"]){
+                input.SIMULATION_EPM_CACHE_FOLDER = parseFileSystemPath(epmCacheSubmenu["EPM cache folder (string)"].as<string>());
+            }
+        }
+
+        // Optional, checkpoints are off by default. The interval is in wall-clock minutes
+        input.SIMULATION_CHECKPOINT = false;
+        input.SIMULATION_CHECKPOINT_INTERVAL = 60.0;
+        if(simNode["CHECKPOINT SUBMENU"]){
+            YAML::Node checkpointSubmenu = simNode["CHECKPOINT SUBMENU"];
+            if(checkpointSubmenu["Save checkpoints (T/F)"]){
+                input.SIMULATION_CHECKPOINT = parseBoolString(checkpointSubmenu["Save checkpoints (T/F)"].as<string>(), "Save checkpoints (T/F)");
+            }
+            if(checkpointSubmenu["Checkpoint interval [min] (double)"]){
+                input.SIMULATION_CHECKPOINT_INTERVAL = parseDoubleString(checkpointSubmenu["Checkpoint interval [min] (double)"].as<string>(), "Checkpoint interval [min] (double)");
+            }
+            if(input.SIMULATION_CHECKPOINT_INTERVAL < 0){
+                throw std::invalid_argument("In Simulation Menu: Checkpoint interval must be non-negative!");
+            }
+        }
+
+        // Optional, off by default
+        input.SIMULATION_TIMING_REPORT = false;
+        if(simNode["Save timing report (T/F)"]){
+            input.SIMULATION_TIMING_REPORT = parseBoolString(simNode["Save timing report (T/F)"].as<string>(), "Save timing report (T/F)");
+        }
+
         if(input.SIMULATION_PARAMETER_SWEEP == input.SIMULATION_MONTECARLO){
             throw std::invalid_argument("In Simulation Menu: Parameter sweep and Monte Carlo cannot have the same value!");
         }
@@ -185,6 +226,35 @@ namespace YamlInputReader{
         input.TRANSPORT_UPDRAFT = parseBoolString(updraftSubmenu["Turn on plume updraft (T/F)"].as<string>(), "Turn on plume updraft (T/F)");
         input.TRANSPORT_UPDRAFT_TIMESCALE = parseDoubleString(updraftSubmenu["Updraft timescale [s] (double)"].as<string>(), "Updraft timescale [s] (double)");
         input.TRANSPORT_UPDRAFT_VELOCITY = parseDoubleString(updraftSubmenu["Updraft veloc. [cm/s] (double)"].as<string>(), "Updraft veloc. [cm/s] (double)");
+
+        // Optional, defaults to the sequential SOR solver
+        input.TRANSPORT_DIFFUSION_SOLVER = "SOR";
+        if(transportNode["Diffusion solver (string)"]){
+            const vector<string> validSolvers = {"SOR", "MulticolorSOR", "ADI"};
+            input.TRANSPORT_DIFFUSION_SOLVER = trim(transportNode["Diffusion solver (string)"].as<string>());
+            if(std::find(validSolvers.begin(), validSolvers.end(), input.TRANSPORT_DIFFUSION_SOLVER) == validSolvers.end()){
+                throw std::invalid_argument("Invalid diffusion solver " + input.TRANSPORT_DIFFUSION_SOLVER + " at Diffusion solver (string)");
+            }
+        }
+        // Optional, H2O and contrail tracer have uniform diffusivities and zero boundary conditions, so they can also use the spectral solver.
+        // Defaults to the solver used for the ice bins.
+        input.TRANSPORT_TRACER_DIFFUSION_SOLVER = input.TRANSPORT_DIFFUSION_SOLVER;
+        if(transportNode["Tracer diffusion solver (string)"]){
+            const vector<string> validSolvers = {"SOR", "MulticolorSOR", "ADI", "Spectral"};
+            input.TRANSPORT_TRACER_DIFFUSION_SOLVER = trim(transportNode["Tracer diffusion solver (string)"].as<string>());
+            if(std::find(validSolvers.begin(), validSolvers.end(), input.TRANSPORT_TRACER_DIFFUSION_SOLVER) == validSolvers.end()){
+                throw std::invalid_argument("Invalid diffusion solver " + input.TRANSPORT_TRACER_DIFFUSION_SOLVER + " at Tracer diffusion solver (string)");
+            }
+        }
+        // Optional, defaults to explicit MinMod advection with CFL-limited substeps
+        input.TRANSPORT_ADVECTION_SCHEME = "MinMod";
+        if(transportNode["Advection scheme (string)"]){
+            const vector<string> validSchemes = {"MinMod", "SemiLagrangian"};
+            input.TRANSPORT_ADVECTION_SCHEME = trim(transportNode["Advection scheme (string)"].as<string>());
+            if(std::find(validSchemes.begin(), validSchemes.end(), input.TRANSPORT_ADVECTION_SCHEME) == validSchemes.end()){
+                throw std::invalid_argument("Invalid advection scheme " + input.TRANSPORT_ADVECTION_SCHEME + " at Advection scheme (string)");
+            }
+        }
     }
     void readChemMenu(OptInput& input, const YAML::Node& chemNode){
         input.CHEMISTRY_CHEMISTRY = parseBoolString(chemNode["Turn on Chemistry (T/F)"].as<string>(), "Turn on Chemistry (T/F)");
@@ -199,6 +269,11 @@ namespace YamlInputReader{
         input.AEROSOL_COAGULATION_TIMESTEP = parseDoubleString(aeroNode["Coag. timestep [min] (double)"].as<string>(), "Coag. timestep [min] (double)");
         input.AEROSOL_ICE_GROWTH = parseBoolString(aeroNode["Turn on ice growth (T/F)"].as<string>(), "Turn on ice growth (T/F)");
         input.AEROSOL_ICE_GROWTH_TIMESTEP = parseDoubleString(aeroNode["Ice growth timestep [min] (double)"].as<string>(), "Ice growth timestep [min] (double)");
+        // Optional, defaults to building the exact coagulation kernels of every case
+        input.AEROSOL_COAGULATION_TABLE = false;
+        if(aeroNode["Tabulated coag. kernels (T/F)"]){
+            input.AEROSOL_COAGULATION_TABLE = parseBoolString(aeroNode["Tabulated coag. kernels (T/F)"].as<string>(), "Tabulated coag. kernels (T/F)");
+        }
     }
     void readMetMenu(OptInput& input, const YAML::Node& metNode){
         YAML::Node metInputSubmenu = metNode["METEOROLOGICAL INPUT SUBMENU"];
@@ -283,6 +358,37 @@ namespace YamlInputReader{
         input.TS_AEROSOL = parseVectorIntString(aeroTsSubmenu["Aerosol indices to include (list of ints)"].as<string>(), "Aerosol indices to include (list of ints)");
         input.TS_AERO_FREQ = parseDoubleString(aeroTsSubmenu["Save frequency [min] (double)"].as<string>(), "Save frequency [min] (double)");
 
+        // Optional, defaults to one file per output time
+        input.TS_AERO_SINGLE_FILE = false;
+        input.TS_AERO_CHUNK_SIZE = 4096;
+        input.TS_AERO_DEFLATE_LEVEL = 1;
+        input.TS_AERO_SHUFFLE = true;
+        input.TS_AERO_SIGNIFICANT_DIGITS = 0;
+        if(aeroTsSubmenu["Single file per case (T/F)"]){
+            input.TS_AERO_SINGLE_FILE = parseBoolString(aeroTsSubmenu["Single file per case (T/F)"].as<string>(), "Single file per case (T/F)");
+        }
+        if(aeroTsSubmenu["Chunk size [cells] (int)"]){
+            input.TS_AERO_CHUNK_SIZE = parseIntString(aeroTsSubmenu["Chunk size [cells] (int)"].as<string>(), "Chunk size [cells] (int)");
+        }
+        if(aeroTsSubmenu["Deflate level (0-9) (int)"]){
+            input.TS_AERO_DEFLATE_LEVEL = parseIntString(aeroTsSubmenu["Deflate level (0-9) (int)"].as<string>(), "Deflate level (0-9) (int)");
+        }
+        if(aeroTsSubmenu["Shuffle (T/F)"]){
+            input.TS_AERO_SHUFFLE = parseBoolString(aeroTsSubmenu["Shuffle (T/F)"].as<string>(), "Shuffle (T/F)");
+        }
+        if(aeroTsSubmenu["Significant digits (int)"]){
+            input.TS_AERO_SIGNIFICANT_DIGITS = parseIntString(aeroTsSubmenu["Significant digits (int)"].as<string>(), "Significant digits (int)");
+        }
+        if(input.TS_AERO_CHUNK_SIZE <= 0){
+            throw std::invalid_argument("In Diagnostic Menu: Chunk size must be positive!");
+        }
+        if(input.TS_AERO_DEFLATE_LEVEL < 0 || input.TS_AERO_DEFLATE_LEVEL > 9){
+            throw std::invalid_argument("In Diagnostic Menu: Deflate level must be between 0 and 9!");
+        }
+        if(input.TS_AERO_SIGNIFICANT_DIGITS < 0 || input.TS_AERO_SIGNIFICANT_DIGITS > 7){
+            throw std::invalid_argument("In Diagnostic Menu: Significant digits must be between 0 (lossless) and 7!");
+        }
+
         YAML::Node plSubmenu = diagNode["PRODUCTION & LOSS SUBMENU"];
         input.PL_PL = parseBoolString(plSubmenu["Turn on P/L diag (T/F)"].as<string>(), "Turn on P/L diag (T/F)");
         input.PL_O3 = parseBoolString(plSubmenu["Save O3 P/L (T/F)"].as<string>(), "Save O3 P/L (T/F)");
@@ -317,44 +423,15 @@ namespace YamlInputReader{
         }
     }
 
-    vector<std::unordered_map<string, double>> generateCasesHelper(vector<std::unordered_map<string, double>>& allCases, const vector<std::pair<string, Vector_1D>>& params, const std::size_t row){
-        if(row ==  params.size()){
-            return allCases;
-        }
-
-        //For first row, just add maps with one entry for each case, these will be duplicated and filled up.
-        string paramName = params[row].first;
-        Vector_1D paramCases = params[row].second;
-        if(allCases.empty()){
-            for(const auto& c: paramCases){
-                allCases.push_back(std::unordered_map<string, double>({{paramName, c}}));
-            }   
-        }
-        else{
-            //Generate new cases from existing ones as we go down the parameter list
-            vector<std::unordered_map<string,double>> newCases;
-            for(const auto& i: allCases){
-                for(const auto& j: paramCases){
-                    std::unordered_map<string,double> tempMap = i;
-                    tempMap[paramName] = j;
-                    newCases.push_back(tempMap);
-                }
-            }
-            allCases = std::move(newCases);
-        }
-        //Repeat pattern of adding to the list of cases as we go down the param list until end and all cases have been generated
-        return generateCasesHelper(allCases, params, row + 1);
-    }
-
     vector<std::unordered_map<string, double>> generateCases(const OptInput& input){
-
-        //Convert parameter map to vector, each row of the vector represents one parameter
-        vector<std::pair<string, Vector_1D>> params;
-        for (const auto& p: input.PARAMETER_PARAM_MAP){
-            params.push_back(p);
-        }
+        //Materialized version of the case space, cases are in the same order
+        const CaseSpace caseSpace(input.PARAMETER_PARAM_MAP);
         vector<std::unordered_map<string, double>> allCases;
-        return generateCasesHelper(allCases, params, 0);
+        allCases.reserve(caseSpace.size());
+        for(std::size_t iCase = 0; iCase < caseSpace.size(); iCase++){
+            allCases.push_back(caseSpace.caseMap(iCase));
+        }
+        return allCases;
     }
 
     Vector_1D parseParamSweepInput(const string paramString, const string paramLocation, bool monteCarlo, int nRuns){
@@ -1,6 +1,8 @@
 #include "LAGRID/RemappingFunctions.hpp"
+#include "LAGRID/RemapOperator.hpp"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
+#include <cmath>
 #include <numeric>
 
 TEST_CASE("FreeCoordBoxGrid and Remapping") {
@@ -110,3 +112,59 @@ TEST_CASE("FreeCoordBoxGrid and Remapping") {
         REQUIRE(std::abs(mass_before - mass) < 1e-12);
     }
 }
+
+TEST_CASE("Sparse Remapping Operator") {
+    //Old grid with a mask that touches the domain edge, remapped onto a coarser grid with buffers
+    const int ny = 12;
+    const int nx = 15;
+    const double dx_old = 3.0;
+    const double x0_old = -22.5;
+    const double y0_old = -10.0;
+    Vector_1D dy(ny);
+    for(int j = 0; j < ny; j++) dy[j] = 1.5 + 0.05 * j;
+
+    std::vector<std::vector<int>> mask(ny, std::vector<int>(nx, 0));
+    Field_3D fields(3, ny, nx);
+    for(int j = 0; j < ny; j++) {
+        for(int i = 0; i < nx; i++) {
+            mask[j][i] = (std::abs(i - 7) + std::abs(j - 4) < 7) ? 1 : 0;
+            for(std::size_t n = 0; n < fields.nBin(); n++) {
+                fields(n, j, i) = (n + 1) * std::exp(-0.1 * ((i - 7) * (i - 7) + (j - 4) * (j - 4))) + 0.01 * i;
+            }
+        }
+    }
+    const LAGRID::Remapping remapping(-25.0, -12.0, 4.0, 2.5, 13, 10);
+    const double bufLeft = 9, bufRight = 13, bufTop = 6, bufBot = 11;
+
+    LAGRID::RemapOperator remap(dy, dx_old, x0_old, y0_old, mask, remapping, bufLeft, bufRight, bufTop, bufBot);
+    Field_3D remapped = remap.apply(fields);
+
+    for(std::size_t n = 0; n < fields.nBin(); n++) {
+        auto boxGrid = LAGRID::rectToBoxGrid(dy[0], dy, dx_old, x0_old, y0_old, fields[n].toVector2D(), mask);
+        auto reference = LAGRID::mapToStructuredGrid(boxGrid, remapping);
+        reference.addBuffer(bufLeft, bufRight, bufTop, bufBot, 0.0);
+
+        REQUIRE(remap.ny() == reference.phi.size());
+        REQUIRE(remap.nx() == reference.phi[0].size());
+        REQUIRE(remap.xCoords() == reference.xCoords);
+        REQUIRE(remap.yCoords() == reference.yCoords);
+
+        Vector_2D single = remap.apply(fields[n].toVector2D());
+        for(std::size_t j = 0; j < remap.ny(); j++) {
+            for(std::size_t i = 0; i < remap.nx(); i++) {
+                REQUIRE(remapped(n, j, i) == Catch::Approx(reference.phi[j][i]).margin(1e-13));
+                REQUIRE(single[j][i] == remapped(n, j, i));
+            }
+        }
+
+        if(n == 0) {
+            auto unusedReference = LAGRID::getUnusedFraction(boxGrid, remapping);
+            unusedReference.addBuffer(bufLeft, bufRight, bufTop, bufBot, 1.0);
+            REQUIRE(remap.unusedFraction().phi == unusedReference.phi);
+        }
+    }
+
+    SECTION("Mismatched field") {
+        REQUIRE_THROWS_AS(remap.apply(Vector_2D(ny + 1, Vector_1D(nx, 0.0))), std::invalid_argument);
+    }
+}
@@ -3,6 +3,8 @@
 #include <iostream>
 #include "Core/Mesh.hpp"
 #include "FVM_ANDS/FVM_Solver.hpp"
+#include "FVM_ANDS/FVM_BatchSolver.hpp"
+#include "FVM_ANDS/SpectralDiffusion.hpp"
 using std::cout;
 using std::endl;
 
@@ -292,6 +294,306 @@ namespace FVM_ANDS{
         REQUIRE(error < 1);
     }
 
+    TEST_CASE("Multicolor SOR Solver"){
+        // Tri-banded prescribed solution system as in the "SOR Solver" test, but diagonally dominant
+        // like the diffusion matrices: the residual-based stopping criterion then also bounds the error.
+        int Npoints = 1000;
+
+        Eigen::SparseMatrix<double, Eigen::RowMajor> A(Npoints, Npoints);
+        std::vector<Eigen::Triplet<double>> tripletList;
+
+        Eigen::VectorXd ExactSolution(Npoints);
+        Eigen::VectorXd SORSolution(Npoints);
+        for (int i = 0; i < Npoints; ++i){
+            tripletList.emplace_back(i, i, 1.0);
+            if (i > 1)
+                tripletList.emplace_back(i, i-1, 0.25);
+            if (i < Npoints - 1)
+                tripletList.emplace_back(i, i+1, 0.25);
+            ExactSolution[i] = i;
+            SORSolution[i] = 0;
+        }
+        A.setFromTriplets(tripletList.begin(), tripletList.end());
+        Eigen::VectorXd rhs = (A * ExactSolution).eval();
+
+        MatrixColoring coloring = greedyColoring(A);
+        SECTION("Coloring"){
+            // Tridiagonal matrix is two-colourable, and no two coupled rows may share a colour
+            REQUIRE(coloring.nColors() == 2);
+            REQUIRE(coloring.rows.size() == static_cast<std::size_t>(Npoints));
+            std::vector<int> color(Npoints, -1);
+            for(int c = 0; c < coloring.nColors(); c++){
+                for(int k = coloring.colorStart[c]; k < coloring.colorStart[c + 1]; k++){
+                    color[coloring.rows[k]] = c;
+                }
+            }
+            for(int i = 0; i < Npoints; i++){
+                for(Eigen::SparseMatrix<double, Eigen::RowMajor>::InnerIterator it(A, i); it; ++it){
+                    if(it.col() != i) REQUIRE(color[i] != color[it.col()]);
+                }
+            }
+        }
+        SECTION("Solution"){
+            FVM_ANDS::multicolor_sor_solve(A, coloring, rhs, SORSolution, 1.0, 1e-3, 3);
+            auto error = 100 * (SORSolution - ExactSolution).eval().lpNorm<2>()/ ExactSolution.lpNorm<2>();
+            REQUIRE(error < 1);
+        }
+    }
+
+    TEST_CASE("Multicolor SOR Operator Split Diffusion"){
+        // Multicolour and lexicographic SOR solve the same diffusion system, results only differ by the solver tolerance
+        double u = 0.2, v = -0.25, shear = 0.1, Dh = 0.01, Dv = 0.01, xlim_left = 0.0, xlim_right = 1.0, ylim_bot = 0.0, ylim_top = 1.0;
+        int nx = 200, ny = 200;
+        double dt = 0.05;
+        AdvDiffParams params = AdvDiffParams(u, v, shear, Dh, Dv, dt);
+        Mesh mesh = Mesh(nx, ny, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+        Eigen::VectorXd init;
+        BoundaryConditions bc;
+        std::tie(init, bc) = initAdvection(nx, ny);
+
+        FVM_Solver solver_sor(params, mesh.x(), mesh.y(), bc, init);
+        FVM_Solver solver_mc(params, mesh.x(), mesh.y(), bc, init);
+        solver_mc.setDiffusionSolver(DiffusionSolver::MulticolorSOR);
+        for(int i = 0; i < 5; i++){
+            solver_sor.operatorSplitSolve();
+            solver_mc.operatorSplitSolve(true);
+        }
+        auto interior_idxs = Eigen::seq(0, nx*ny - 1);
+        double relDiff = (solver_mc.phi()(interior_idxs) - solver_sor.phi()(interior_idxs)).lpNorm<2>() / solver_sor.phi()(interior_idxs).lpNorm<2>();
+        REQUIRE(relDiff < 1e-2);
+    }
+
+    TEST_CASE("ADI Diffusion, Inhomog. Dirichlet BC, Prescribed Solution 10k Points"){
+        // Same prescribed solution as "Pure Diffusion, Inhomog. Dirichlet BC, Prescribed Solution 10k Points",
+        // solved through operatorSplitSolve (no advection) with the ADI diffusion backend.
+        // The factorization error grows with dt^2 * Dxx * Dyy, so use a smaller timestep than the fully implicit test.
+        double u = 0, v = 0, shear = 0, Dh = 1.0, Dv = 1.0, xlim_left = 0.1, xlim_right = 0.8, ylim_bot = 0.2, ylim_top = 0.9;
+        int nx = 100, ny = 100;
+        double dt = 0.01;
+        AdvDiffParams params = AdvDiffParams(u, v, shear, Dh, Dv, dt);
+        Mesh mesh = Mesh(nx, ny, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+        Eigen::VectorXd exact, source;
+        BoundaryConditions bc;
+        std::tie(exact, source, bc) = FVM_prescribedDiffSolution(0, nx, ny, xlim_left, xlim_right, ylim_bot, ylim_top, Dh, Dv);
+        FVM_Solver solver(params, mesh.x(), mesh.y(), bc, exact);
+        solver.setDiffusionSolver(DiffusionSolver::ADI);
+        double t = 0, t_max = 1;
+        int n_timesteps = t_max/dt;
+        for(int i = 0; i < n_timesteps; i++){
+            t = dt*(i + 1);
+            std::tie(exact, source, bc) = FVM_prescribedDiffSolution(t, nx, ny, xlim_left, xlim_right, ylim_bot, ylim_top, Dh, Dv);
+            solver.updateBoundaryCondition(bc);
+            solver.addSource(source);
+            Eigen::VectorXd soln = solver.operatorSplitSolve();
+            auto interior_idxs = Eigen::seq(0, nx*ny - 1);
+            double abs_l2_error = (soln(interior_idxs) - exact(interior_idxs)).lpNorm<2>() / exact(interior_idxs).lpNorm<2>();
+
+            REQUIRE(abs_l2_error < 0.05);
+            REQUIRE(soln(interior_idxs).minCoeff() >= 0.0);
+        }
+    }
+
+    TEST_CASE("ADI Operator Split Advection-Diffusion"){
+        // ADI only adds an O(dt^2) factorization error to the implicit diffusion step solved by SOR,
+        // which slightly over-damps the peak
+        double u = 0.2, v = -0.25, shear = 0.1, Dh = 0.01, Dv = 0.01, xlim_left = 0.0, xlim_right = 1.0, ylim_bot = 0.0, ylim_top = 1.0;
+        int nx = 200, ny = 200;
+        double dt = 0.05;
+        AdvDiffParams params = AdvDiffParams(u, v, shear, Dh, Dv, dt);
+        Mesh mesh = Mesh(nx, ny, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+        Eigen::VectorXd init;
+        BoundaryConditions bc;
+        std::tie(init, bc) = initAdvection(nx, ny);
+
+        FVM_Solver solver_sor(params, mesh.x(), mesh.y(), bc, init);
+        FVM_Solver solver_adi(params, mesh.x(), mesh.y(), bc, init);
+        solver_adi.setDiffusionSolver(DiffusionSolver::ADI);
+        for(int i = 0; i < 5; i++){
+            solver_sor.operatorSplitSolve();
+            solver_adi.operatorSplitSolve(true);
+        }
+        auto interior_idxs = Eigen::seq(0, nx*ny - 1);
+        double relDiff = (solver_adi.phi()(interior_idxs) - solver_sor.phi()(interior_idxs)).lpNorm<2>() / solver_sor.phi()(interior_idxs).lpNorm<2>();
+        REQUIRE(relDiff < 2e-2);
+
+        double max_sor, maxx_sor, maxy_sor, max_adi, maxx_adi, maxy_adi;
+        std::tie(max_sor, maxx_sor, maxy_sor) = interiorMax(solver_sor.phi(), 0, 1, 0, 1, nx, ny);
+        std::tie(max_adi, maxx_adi, maxy_adi) = interiorMax(solver_adi.phi(), 0, 1, 0, 1, nx, ny);
+        REQUIRE(max_adi == Catch::Approx(max_sor).epsilon(3e-2));
+        REQUIRE(maxx_adi == Catch::Approx(maxx_sor));
+        REQUIRE(maxy_adi == Catch::Approx(maxy_sor));
+    }
+
+    TEST_CASE("Semi-Lagrangian Advection w/ Shear"){
+        // Courant number ~15: far beyond what the explicit scheme allows without substepping
+        double u = 0.3, v = -0.25, shear = 0.2, Dh = 0.0, Dv = 0.0, xlim_left = 0.0, xlim_right = 1.0, ylim_bot = 0.0, ylim_top = 1.0;
+        int nx = 200, ny = 200;
+        double dx = 1.0/nx;
+        double dy = 1.0/ny;
+        double dt = 0.25;
+        AdvDiffParams params = AdvDiffParams(u, v, shear, Dh, Dv, dt);
+        Mesh mesh = Mesh(nx, ny, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+        Eigen::VectorXd init;
+        BoundaryConditions bc;
+        std::tie(init, bc) = initAdvection(nx, ny);
+        auto interior_idxs = Eigen::seq(0, nx*ny - 1);
+        double mass_init = dx*dy*init(interior_idxs).sum();
+
+        FVM_Solver solver(params, mesh.x(), mesh.y(), bc, init);
+        solver.setDiffusionSolver(DiffusionSolver::ADI);
+        solver.setAdvectionScheme(AdvectionScheme::SemiLagrangian);
+        double t = 0;
+        double max, maxx, maxy, min, minx, miny;
+        for(int i = 0; i < 4; i++){
+            t = dt*(i + 1);
+            solver.operatorSplitSolve();
+            std::tie(min, minx, miny) = interiorMin(solver.phi(), 0, 1, 0, 1, nx, ny);
+            std::tie(max, maxx, maxy) = interiorMax(solver.phi(), 0, 1, 0, 1, nx, ny);
+            REQUIRE(min >= 0.0);
+            REQUIRE(max <= 1.0);
+            REQUIRE(dx*dy*solver.phi()(interior_idxs).sum() == Catch::Approx(mass_init).epsilon(1e-12));
+        }
+        double xmax_exp = 0.495 + u * t -  shear * (0.5*t + v / 2.0 * t * t);
+        double ymax_exp = 0.495 + v * t;
+        REQUIRE(std::abs(maxx-xmax_exp) < 0.01);
+        REQUIRE(std::abs(maxy-ymax_exp) < 0.01);
+
+        SECTION("Whole-cell shifts are exact"){
+            // Without shear, a half step moving the field by a whole number of cells is a pure translation
+            u = 0.2, v = -0.2, shear = 0.0, dt = 0.1;
+            int n = 100;
+            Mesh mesh_n = Mesh(n, n, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+            std::tie(init, bc) = initAdvection(n, n);
+            FVM_Solver solver_shift(AdvDiffParams(u, v, shear, Dh, Dv, dt), mesh_n.x(), mesh_n.y(), bc, init);
+            solver_shift.setDiffusionSolver(DiffusionSolver::ADI);
+            solver_shift.setAdvectionScheme(AdvectionScheme::SemiLagrangian);
+            solver_shift.operatorSplitSolve();
+            solver_shift.operatorSplitSolve();
+            for(int i = 0; i < n; i++){
+                for(int j = 0; j < n; j++){
+                    double expected = (i >= 4 && j + 4 < n) ? init[(i - 4)*n + j + 4] : 0.0;
+                    REQUIRE(solver_shift.phi()[i*n + j] == Catch::Approx(expected).margin(1e-14));
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Semi-Lagrangian Batched Settling"){
+        // Batched bins only differ by their settling velocity, compare against the single field solver
+        double u = 0.1, shear = 0.3, Dh = 0.005, Dv = 0.002, xlim_left = 0.0, xlim_right = 1.0, ylim_bot = 0.0, ylim_top = 1.0;
+        int nx = 80, ny = 60;
+        double dt = 0.1;
+        AdvDiffParams params = AdvDiffParams(u, 0, shear, Dh, Dv, dt);
+        Mesh mesh = Mesh(nx, ny, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+        Eigen::VectorXd init;
+        BoundaryConditions bc;
+        std::tie(init, bc) = initAdvection(nx, ny);
+        Vector_2D field = eigenVec_to_std2dVec(init, nx, ny);
+        Vector_1D vSettling = {0.0, -0.3, -1.5};
+
+        Field_3D fields(vSettling.size(), ny, nx);
+        for(std::size_t n = 0; n < vSettling.size(); n++){
+            fields.setBin(n, field);
+        }
+        FVM_BatchSolver batch(params, mesh.x(), mesh.y(), bc);
+        batch.setAdvectionScheme(AdvectionScheme::SemiLagrangian);
+        batch.operatorSplitSolve2DVec(fields, vSettling);
+
+        for(std::size_t n = 0; n < vSettling.size(); n++){
+            FVM_Solver single(AdvDiffParams(u, vSettling[n], shear, Dh, Dv, dt), mesh.x(), mesh.y(), bc, init);
+            single.setAdvectionScheme(AdvectionScheme::SemiLagrangian);
+            Vector_2D ref = field;
+            single.operatorSplitSolve2DVec(ref, bc);
+            for(int j = 0; j < ny; j++){
+                for(int i = 0; i < nx; i++){
+                    REQUIRE(fields[n][j][i] == Catch::Approx(ref[j][i]).margin(1e-12));
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Spectral Diffusion Solver"){
+        double u = 0, v = 0, shear = 0, Dh = 0.01, Dv = 0.005, xlim_left = 0.0, xlim_right = 1.0, ylim_bot = 0.0, ylim_top = 1.0;
+        int nx = 64, ny = 48;
+        double dx = 1.0/nx;
+        double dy = 1.0/ny;
+        double dt = 0.5;
+        AdvDiffParams params = AdvDiffParams(u, v, shear, Dh, Dv, dt);
+        Mesh mesh = Mesh(nx, ny, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+
+        SECTION("Discrete Eigenmode"){
+            // A sine mode of the discrete Laplacian decays exactly as exp(-dt * (Dh * lambda_x + Dv * lambda_y)) every step
+            Eigen::VectorXd init;
+            BoundaryConditions bc;
+            std::tie(init, bc) = initAdvection(nx, ny);
+            for(int i = 0; i < nx; i++){
+                for(int j = 0; j < ny; j++){
+                    init[i*ny + j] = std::sin(physConst::PI * (i + 0.5) / nx) * std::sin(2 * physConst::PI * (j + 0.5) / ny);
+                }
+            }
+            double lambda_x = 4 / (dx * dx) * std::pow(std::sin(physConst::PI / (2.0 * nx)), 2);
+            double lambda_y = 4 / (dy * dy) * std::pow(std::sin(2 * physConst::PI / (2.0 * ny)), 2);
+
+            FVM_Solver solver(params, mesh.x(), mesh.y(), bc, init);
+            solver.setDiffusionSolver(DiffusionSolver::Spectral);
+            int n_timesteps = 4;
+            for(int i = 0; i < n_timesteps; i++){
+                solver.operatorSplitSolve();
+            }
+            auto interior_idxs = Eigen::seq(0, nx*ny - 1);
+            Eigen::VectorXd exact = init(interior_idxs) * std::exp(-n_timesteps * dt * (Dh * lambda_x + Dv * lambda_y));
+            REQUIRE((solver.phi()(interior_idxs) - exact).lpNorm<Eigen::Infinity>() < 1e-12);
+        }
+        SECTION("Nonzero Boundary Condition"){
+            // Only zero Dirichlet boundaries are diagonalized by the sine transform
+            Eigen::VectorXd exact, source;
+            BoundaryConditions bc;
+            std::tie(exact, source, bc) = FVM_prescribedDiffSolution(0.5, nx, ny, 0.1, 0.8, 0.2, 0.9, Dh, Dv);
+            FVM_Solver solver(params, mesh.x(), mesh.y(), bc, exact);
+            solver.setDiffusionSolver(DiffusionSolver::Spectral);
+            REQUIRE_THROWS(solver.operatorSplitSolve());
+        }
+        SECTION("Plan Cache Eviction"){
+            // Grid sizes change with every remap, going through more sizes than the plan cache holds must not change results
+            std::vector<double> phi(nx * ny), first(nx * ny), again(nx * ny);
+            for(int k = 0; k < nx * ny; k++) phi[k] = std::sin(0.37 * k);
+            spectralDiffusionPropagate(phi.data(), first.data(), nx, ny, dx, dy, Dh, Dv, dt);
+            for(int n = 1; n <= 40; n++){
+                std::vector<double> other(n * (n + 1), 1.0);
+                spectralDiffusionPropagate(other.data(), other.data(), n, n + 1, dx, dy, Dh, Dv, dt);
+            }
+            spectralDiffusionPropagate(phi.data(), again.data(), nx, ny, dx, dy, Dh, Dv, dt);
+            REQUIRE(first == again);
+        }
+    }
+
+    TEST_CASE("Spectral Batched Tracer Transport"){
+        // Exact diffusion propagator vs. the implicit Euler diffusion step of SOR, which differ by O(dt)
+        double u = 0.2, v = -0.25, shear = 0.1, Dh = 0.01, Dv = 0.01, xlim_left = 0.0, xlim_right = 1.0, ylim_bot = 0.0, ylim_top = 1.0;
+        int nx = 200, ny = 200;
+        double dt = 0.05;
+        AdvDiffParams params = AdvDiffParams(u, v, shear, Dh, Dv, dt);
+        Mesh mesh = Mesh(nx, ny, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+        Eigen::VectorXd init;
+        BoundaryConditions bc;
+        std::tie(init, bc) = initAdvection(nx, ny);
+
+        FVM_Solver solver_sor(params, mesh.x(), mesh.y(), bc, init);
+        FVM_BatchSolver solver_spectral(params, mesh.x(), mesh.y(), bc);
+        solver_spectral.setDiffusionSolver(DiffusionSolver::Spectral);
+        solver_spectral.updateAdvection(u, shear);
+        Vector_2D field = eigenVec_to_std2dVec(init, nx, ny);
+        for(int i = 0; i < 5; i++){
+            solver_sor.operatorSplitSolve();
+            solver_spectral.operatorSplitSolve2DVec(field, v);
+        }
+        Eigen::VectorXd phi_spectral = std2dVec_to_eigenVec(field);
+        auto interior_idxs = Eigen::seq(0, nx*ny - 1);
+        double relDiff = (phi_spectral(interior_idxs) - solver_sor.phi()(interior_idxs)).lpNorm<2>() / solver_sor.phi()(interior_idxs).lpNorm<2>();
+        REQUIRE(relDiff < 5e-2);
+        REQUIRE(phi_spectral.sum() == Catch::Approx(solver_sor.phi()(interior_idxs).sum()).epsilon(1e-2));
+    }
+
     TEST_CASE("Pure Diffusion, Inhomog. Dirichlet BC, Prescribed Solution 10k Points"){
         // Dh = 0.9, Dv = 0.4
         // Test solver accuracy on 10k interior points
@@ -503,4 +805,45 @@ namespace FVM_ANDS{
         REQUIRE(std::abs(maxy-0.381) < 0.01);
 
     }
+    TEST_CASE("Batched Operator Split Transport"){
+        // The batch solver must reproduce one FVM_Solver per field, with fields differing only by settling velocity.
+        double u = 0.2, shear = 0.1, Dh = 0.01, Dv = 0.005, xlim_left = 0.0, xlim_right = 1.0, ylim_bot = 0.0, ylim_top = 1.0;
+        int nx = 100, ny = 100;
+        double dt = 0.05;
+        int n_timesteps = 5;
+        Vector_1D v = {0.0, -0.1, -0.3, 0.2};
+
+        AdvDiffParams params = AdvDiffParams(u, 0, shear, Dh, Dv, dt);
+        Mesh mesh = Mesh(nx, ny, xlim_left, xlim_right, ylim_top, ylim_bot, MeshDomainLimitsSpec::ABS_COORDS);
+        Eigen::VectorXd init;
+        BoundaryConditions bc;
+        std::tie(init, bc) = initAdvection(nx, ny);
+
+        Vector_3D fields_ref(v.size());
+        for(std::size_t n = 0; n < v.size(); n++){
+            fields_ref[n] = eigenVec_to_std2dVec(init * (n + 1), nx, ny);
+        }
+        //Numerically zero fields are left untouched
+        fields_ref.push_back(Vector_2D(ny, Vector_1D(nx, 0)));
+        v.push_back(-0.1);
+        Field_3D fields_batch(fields_ref);
+
+        FVM_BatchSolver batchSolver(params, mesh.x(), mesh.y(), bc);
+        for(int i = 0; i < n_timesteps; i++){
+            batchSolver.operatorSplitSolve2DVec(fields_batch, v);
+        }
+
+        for(std::size_t n = 0; n < v.size(); n++){
+            FVM_Solver solver(params, mesh.x(), mesh.y(), bc, std2dVec_to_eigenVec(fields_ref[n]));
+            solver.updateAdvection(u, v[n], shear);
+            for(int i = 0; i < n_timesteps; i++){
+                solver.operatorSplitSolve2DVec(fields_ref[n], bc);
+            }
+            for(int j = 0; j < ny; j++){
+                for(int k = 0; k < nx; k++){
+                    REQUIRE(fields_batch[n][j][k] == Catch::Approx(fields_ref[n][j][k]).margin(1e-12));
+                }
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -234,4 +234,231 @@ TEST_CASE ("Aerosol", "[single-file]" ) {
         REQUIRE(result[low_idx] < 10.0);
     }
 
-}
\ No newline at end of file
+}
+TEST_CASE ("Grid_Aerosol field layout", "[single-file]" ) {
+
+    int nBins = 5;
+    UInt nx = 4, ny = 3;
+    Vector_1D bin_edges(nBins+1);
+    Vector_1D bin_centers(nBins);
+    for (int i = 0; i <= nBins; i++) {
+        bin_edges[i] = 1e-8 * pow(2.0, i);
+    }
+    for (int i = 0; i < nBins; i++) {
+        bin_centers[i] = 0.5 * (bin_edges[i] + bin_edges[i+1]);
+    }
+    Grid_Aerosol aerosol(nx, ny, bin_centers, bin_edges, 1.0e6, 4e-8, 1.5);
+
+    SECTION("Contiguous [bin][y][x] storage") {
+        const Field_3D& pdf = aerosol.getPDF();
+        REQUIRE(pdf.size() == UInt(nBins));
+        REQUIRE(pdf[0].size() == ny);
+        REQUIRE(pdf[0][0].size() == nx);
+        for (int iBin = 0; iBin < nBins; iBin++) {
+            for (UInt jNy = 0; jNy < ny; jNy++) {
+                for (UInt iNx = 0; iNx < nx; iNx++) {
+                    REQUIRE(&pdf[iBin][jNy][iNx] == pdf.data() + (iBin * ny + jNy) * nx + iNx);
+                    REQUIRE(pdf.binMatrix(iBin)(jNy, iNx) == pdf[iBin][jNy][iNx]);
+                }
+            }
+        }
+    }
+    SECTION("Vector_3D round trip") {
+        Vector_3D vec = aerosol.getPDF().toVector3D();
+        vec[2][1][3] = 42.0;
+        aerosol.updatePdf(Field_3D(vec));
+        REQUIRE(aerosol.getPDF()[2][1][3] == 42.0);
+        REQUIRE(aerosol.Number()[2][1][3] == Catch::Approx(42.0 * log(bin_edges[3] / bin_edges[2])));
+        REQUIRE(aerosol.getPDF().toVector3D() == vec);
+    }
+    SECTION("Active cells and bin ranges") {
+        Field_3D pdf(nBins, ny, nx);
+        pdf(1, 0, 2) = 1.0;
+        pdf(3, 0, 2) = 2.0;
+        pdf(4, 2, 1) = -1.0;
+        aerosol.updatePdf(pdf);
+        auto cells = aerosol.ActiveCells(nx, ny);
+        REQUIRE(cells.size() == 2);
+        REQUIRE(cells[0].jNy == 0);
+        REQUIRE(cells[0].iNx == 2);
+        REQUIRE(cells[0].firstBin == 1);
+        REQUIRE(cells[0].lastBin == 3);
+        REQUIRE(cells[1].jNy == 2);
+        REQUIRE(cells[1].iNx == 1);
+        REQUIRE(cells[1].firstBin == 4);
+        REQUIRE(cells[1].lastBin == 4);
+        REQUIRE(aerosol.ActiveCells(nx, 2).size() == 1);
+    }
+}
+
+TEST_CASE ("Grid_Aerosol fused diagnostics", "[single-file]" ) {
+
+    int nBins = 6;
+    UInt nx = 5, ny = 4;
+    Vector_1D bin_edges(nBins+1);
+    Vector_1D bin_centers(nBins);
+    for (int i = 0; i <= nBins; i++) {
+        bin_edges[i] = 1e-7 * pow(2.0, i);
+    }
+    for (int i = 0; i < nBins; i++) {
+        bin_centers[i] = 0.5 * (bin_edges[i] + bin_edges[i+1]);
+    }
+    Grid_Aerosol aerosol(nx, ny, bin_centers, bin_edges, 1.0e2, 4e-7, 1.5);
+
+    /* Uneven field, with empty cells on the edges */
+    Field_3D pdf = aerosol.getPDF();
+    for (int iBin = 0; iBin < nBins; iBin++) {
+        for (UInt jNy = 0; jNy < ny; jNy++) {
+            for (UInt iNx = 0; iNx < nx; iNx++) {
+                pdf(iBin, jNy, iNx) *= (iNx == 0 || jNy == ny - 1) ? 0.0 : (1.0 + iNx * jNy + iBin % 3);
+            }
+        }
+    }
+    aerosol.updatePdf(pdf);
+
+    Vector_1D xCoord(nx), yCoord(ny);
+    for (UInt i = 0; i < nx; i++) xCoord[i] = 10.0 * i;
+    for (UInt j = 0; j < ny; j++) yCoord[j] = 5.0 * j;
+    Vector_1D dx(nx, 10.0), dy(ny, 5.0);
+    Vector_2D areas(ny, Vector_1D(nx, 50.0));
+
+    Grid_Aerosol::Diagnostics diag;
+    aerosol.Diagnose(diag, areas, xCoord, yCoord, dx, dy);
+
+    auto requireEqual2D = [](const Vector_2D& fused, const Vector_2D& ref) {
+        REQUIRE(fused.size() == ref.size());
+        for (std::size_t j = 0; j < ref.size(); j++) {
+            REQUIRE(fused[j].size() == ref[j].size());
+            for (std::size_t i = 0; i < ref[j].size(); i++)
+                REQUIRE(fused[j][i] == Catch::Approx(ref[j][i]).epsilon(1e-12));
+        }
+    };
+    auto requireEqual1D = [](const Vector_1D& fused, const Vector_1D& ref) {
+        REQUIRE(fused.size() == ref.size());
+        for (std::size_t i = 0; i < ref.size(); i++)
+            REQUIRE(fused[i] == Catch::Approx(ref[i]).epsilon(1e-12));
+    };
+
+    SECTION("Same values as the separate diagnostics") {
+        requireEqual2D(diag.number, aerosol.TotalNumber());
+        requireEqual2D(diag.area, aerosol.TotalArea());
+        requireEqual2D(diag.volume, aerosol.TotalVolume());
+        requireEqual2D(diag.effRadius, aerosol.EffRadius());
+        requireEqual2D(diag.IWC, aerosol.IWC());
+        requireEqual2D(diag.extinction, aerosol.Extinction());
+        requireEqual1D(diag.xOD, aerosol.xOD(dx));
+        requireEqual1D(diag.yOD, aerosol.yOD(dy));
+        requireEqual1D(diag.sizeDist, aerosol.Overall_Size_Dist(areas));
+        REQUIRE(diag.totalNumber == Catch::Approx(aerosol.TotalNumber_sum(areas)).epsilon(1e-12));
+        REQUIRE(diag.totalIceMass == Catch::Approx(aerosol.TotalIceMass_sum(areas)).epsilon(1e-12));
+        REQUIRE(diag.width == aerosol.extinctionWidth(xCoord));
+        REQUIRE(diag.depth == aerosol.extinctionDepth(yCoord));
+        REQUIRE(diag.intOD == Catch::Approx(aerosol.intYOD(dx, dy)).epsilon(1e-12));
+    }
+    SECTION("Buffers are reused") {
+        const double* numberData = diag.number[0].data();
+        const double* extinctionData = diag.extinction[ny - 1].data();
+        aerosol.Diagnose(diag, areas, xCoord, yCoord, dx, dy);
+        REQUIRE(diag.number[0].data() == numberData);
+        REQUIRE(diag.extinction[ny - 1].data() == extinctionData);
+        requireEqual2D(diag.number, aerosol.TotalNumber());
+    }
+    SECTION("Number and mass only") {
+        Grid_Aerosol::Diagnostics partial;
+        partial.full = false;
+        aerosol.Diagnose(partial, areas, xCoord, yCoord, Vector_1D(), Vector_1D());
+        requireEqual2D(partial.number, aerosol.TotalNumber());
+        requireEqual2D(partial.IWC, aerosol.IWC());
+        REQUIRE(partial.totalNumber == Catch::Approx(diag.totalNumber).epsilon(1e-12));
+        REQUIRE(partial.totalIceMass == Catch::Approx(diag.totalIceMass).epsilon(1e-12));
+        REQUIRE(partial.extinction.empty());
+    }
+}
+
+TEST_CASE ("Grid_Aerosol coagulation", "[single-file]" ) {
+
+    int nBins = 8;
+    UInt nx = 4, ny = 3;
+    Vector_1D bin_edges(nBins+1);
+    Vector_1D bin_centers(nBins);
+    Vector_1D bin_vcenters(nBins);
+    for (int i = 0; i <= nBins; i++) {
+        bin_edges[i] = 1e-8 * pow(2.0, i);
+    }
+    for (int i = 0; i < nBins; i++) {
+        bin_centers[i] = 0.5 * (bin_edges[i] + bin_edges[i+1]);
+        bin_vcenters[i] = 4.0 / 3.0 * physConst::PI * pow(bin_centers[i], 3);
+    }
+    const Coagulation kernel("liquid", bin_centers, bin_vcenters, physConst::RHO_SULF, 220.0, 2.5e4);
+    Grid_Aerosol aerosol(nx, ny, bin_centers, bin_edges, 1.0e5, 4e-8, 1.5);
+
+    /* Cell (0, 0) is below the volume threshold, cell (1, 2) holds no particles
+     * and the smallest bins of cell (2, 1) are empty */
+    Field_3D pdf = aerosol.getPDF();
+    for (int iBin = 0; iBin < nBins; iBin++) {
+        pdf(iBin, 0, 0) *= 1.0e-8;
+        pdf(iBin, 1, 2) = 0.0;
+        if (iBin < 3) pdf(iBin, 2, 1) = 0.0;
+    }
+    aerosol.updatePdf(pdf);
+    const Field_3D volume = aerosol.Volume();
+
+    SECTION("Partition update matches a fresh build") {
+        Coagulation copy = kernel;
+        Vector_1D shifted = bin_vcenters;
+        for (int i = 0; i < nBins; i++) shifted[i] *= 1.3;
+        copy.buildF(shifted);
+        copy.buildF(bin_vcenters);
+        REQUIRE(copy.getF() == kernel.getF());
+    }
+    SECTION("Sparse partition holds the dense production and loss terms") {
+        const Vector_3D f = kernel.getF();
+        const Vector_2D beta = kernel.getBeta();
+        const Coagulation::Partition& part = kernel.partition;
+        REQUIRE(part.rowStart.size() == UInt(nBins + 1));
+        for (int iBin = 0; iBin < nBins; iBin++) {
+            Vector_2D coef(nBins, Vector_1D(nBins, 0.0));
+            for (UInt e = part.rowStart[iBin]; e < part.rowStart[iBin + 1]; e++) {
+                REQUIRE(part.kBin[e] < UInt(iBin));
+                REQUIRE(part.jBin[e] <= UInt(iBin));
+                coef[part.kBin[e]][part.jBin[e]] = part.coef[e];
+            }
+            for (int jBin = 0; jBin < nBins; jBin++) {
+                for (int kBin = 0; kBin < nBins; kBin++) {
+                    const double dense = (kBin < iBin && jBin <= iBin) ? f[kBin][jBin][iBin] * beta[kBin][jBin] : 0.0;
+                    REQUIRE(coef[kBin][jBin] == dense);
+                }
+                REQUIRE(part.loss[iBin * nBins + jBin] == (1.0 - f[iBin][jBin][iBin]) * beta[iBin][jBin]);
+            }
+        }
+    }
+    SECTION("Cells coagulate independently") {
+        aerosol.Coagulate(60.0, kernel, 2, 0);
+        const Field_3D& pdf_new = aerosol.getPDF();
+        const Field_3D volume_new = aerosol.Volume();
+        for (UInt jNy = 0; jNy < ny; jNy++) {
+            for (UInt iNx = 0; iNx < nx; iNx++) {
+                double vol = 0.0, vol_new = 0.0, num = 0.0, num_new = 0.0;
+                for (int iBin = 0; iBin < nBins; iBin++) {
+                    const double logRatio = log(bin_edges[iBin + 1] / bin_edges[iBin]);
+                    vol += volume[iBin][jNy][iNx];
+                    vol_new += volume_new[iBin][jNy][iNx];
+                    num += pdf[iBin][jNy][iNx] * logRatio;
+                    num_new += pdf_new[iBin][jNy][iNx] * logRatio;
+                    /* All coagulated cells hold the same field */
+                    if (!(jNy == 0 && iNx == 0) && !(jNy == 1 && iNx == 2) && !(jNy == 2 && iNx == 1))
+                        REQUIRE(pdf_new[iBin][jNy][iNx] == pdf_new[iBin][ny - 1][nx - 1]);
+                }
+                if (jNy == 0 && iNx == 0) {
+                    for (int iBin = 0; iBin < nBins; iBin++)
+                        REQUIRE(pdf_new[iBin][0][0] == pdf[iBin][0][0]);
+                } else if (jNy == 1 && iNx == 2) {
+                    REQUIRE(num_new == 0.0);
+                } else {
+                    REQUIRE(num_new < num);
+                    REQUIRE(vol_new == Catch::Approx(vol).epsilon(1e-10));
+                }
+            }
+        }
+    }
+}
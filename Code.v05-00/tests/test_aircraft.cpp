@@ -40,4 +40,26 @@ TEST_CASE("Vortex Losses Survival Fraction"){
           REQUIRE(aircraft.VortexLosses(EI_soot, EISootRad, z_atm) == Catch::Approx(0.218).margin(0.2));
    }
 
-}
\ No newline at end of file
+}
+TEST_CASE("Engine Database"){
+    const auto database = EngineDatabase::load(engineFileName);
+    REQUIRE(database == EngineDatabase::load(engineFileName));
+    REQUIRE(database->find("NotAnEngine") == nullptr);
+
+    const EngineLTO* lto = database->find("GEnx-2B67B");
+    REQUIRE(lto != nullptr);
+    //Idle is the fourth line of the entry, fuel flow includes the installation factor
+    REQUIRE(lto->LTO_fuelflow[0] == Catch::Approx(0.208 * 1.100));
+    REQUIRE(lto->LTO_NOx[0] == Catch::Approx(4.37));
+    REQUIRE(lto->LTO_CO[1] == Catch::Approx(2.49));
+    REQUIRE(lto->LTO_HC[3] == Catch::Approx(0.02));
+
+    SECTION("Engine from preloaded entry"){
+        Engine fromFile("GEnx-2B67B", engineFileName, 217.0, 22000.0, 60.0, 0.8);
+        Engine fromEntry(std::string("GEnx-2B67B"), *lto, 217.0, 22000.0, 60.0, 0.8);
+        REQUIRE(fromFile.getEI_NOx() == fromEntry.getEI_NOx());
+        REQUIRE(fromFile.getEI_CO() == fromEntry.getEI_CO());
+        REQUIRE(fromFile.getEI_HC() == fromEntry.getEI_HC());
+        REQUIRE(fromFile.getEI_NOx() > 0.0);
+    }
+}
@@ -1,6 +1,8 @@
 #include "AIM/buildKernel.hpp"
+#include "AIM/CoagulationTable.hpp"
 #include "Util/ForwardDecl.hpp"
 #include "Util/PhysConstant.hpp"
+#include <cmath>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
@@ -223,4 +225,71 @@ TEST_CASE("Build kernel", "[single-file]") {
         REQUIRE(1.0e6 * scaler * TSKernel[0][0] == Catch::Approx(2.5118864315095718e-8).epsilon(0.1));
     }
 
-}
\ No newline at end of file
+}
+TEST_CASE("Coagulation kernel table", "[single-file]") {
+
+    const int nBins = 12;
+    Vector_1D bin_centers(nBins);
+    Vector_1D bin_vcenters(nBins);
+    for (int i = 0; i < nBins; i++) {
+        bin_centers[i] = 1e-9 * pow(1.8, i / 3.0) * 1.1;
+        bin_vcenters[i] = 4.0 / 3.0 * physConst::PI * pow(bin_centers[i], 3);
+    }
+    CoagulationTable::clearCache();
+    const auto table = CoagulationTable::load("liquid", bin_centers, physConst::RHO_SULF);
+
+    SECTION("Exact kernels by default") {
+        REQUIRE(!CoagulationTable::enabled());
+        CoagulationTable::configure(true);
+        REQUIRE(CoagulationTable::enabled());
+        CoagulationTable::configure(false);
+    }
+    SECTION("Tables are shared") {
+        REQUIRE(CoagulationTable::load("liquid", bin_centers, physConst::RHO_SULF) == table);
+        REQUIRE(CoagulationTable::load("ice", bin_centers, physConst::RHO_SULF) != table);
+    }
+    SECTION("Lattice nodes match the direct kernel") {
+        const double T = 110 * CoagulationTable::DT_K;
+        const double P = exp(200 * CoagulationTable::DLOGP);
+        const Coagulation direct("liquid", bin_centers, bin_vcenters, physConst::RHO_SULF, T, P);
+        const Coagulation tabulated = table->kernel(T, P, bin_vcenters);
+        const Vector_2D beta = direct.getBeta();
+        const Vector_2D betaTab = tabulated.getBeta();
+        for (int i = 0; i < nBins; i++) {
+            for (int j = 0; j < nBins; j++)
+                REQUIRE(betaTab[i][j] == Catch::Approx(beta[i][j]).epsilon(1e-12));
+        }
+        REQUIRE(tabulated.getF() == direct.getF());
+    }
+    SECTION("Interpolation between nodes") {
+        const double T = 217.3;
+        const double P = 23840.0;
+        const Vector_2D beta = Coagulation("liquid", bin_centers, bin_vcenters, physConst::RHO_SULF, T, P).getBeta();
+        const Vector_2D betaTab = table->beta(T, P);
+        REQUIRE(table->nodes() == 4);
+        for (int i = 0; i < nBins; i++) {
+            for (int j = 0; j < nBins; j++)
+                REQUIRE(betaTab[i][j] == Catch::Approx(beta[i][j]).epsilon(1e-3));
+        }
+        table->beta(T + 0.1, P);
+        REQUIRE(table->nodes() == 4);
+        REQUIRE_THROWS(table->kernel_1D(T, P));
+        REQUIRE_THROWS(table->beta(-1.0, P));
+    }
+    SECTION("Kernel with a single particle size") {
+        const double T = 221.7;
+        const double P = 30120.0;
+        const double r_soot = 2.0e-8;
+        const auto table1D = CoagulationTable::load("liquid", bin_centers, physConst::RHO_SULF, r_soot, physConst::RHO_SOOT);
+        const Coagulation direct("liquid", bin_centers, physConst::RHO_SULF, r_soot, physConst::RHO_SOOT, T, P);
+        const Vector_1D kernel = direct.getKernel_1D();
+        /* No volume partition is built for this kernel */
+        REQUIRE(direct.getF().empty());
+        REQUIRE(direct.fraction(0, 0, 0) == 0.0);
+        REQUIRE(Coagulation().getF().empty());
+        const Vector_1D kernelTab = table1D->kernel_1D(T, P);
+        REQUIRE(kernelTab.size() == kernel.size());
+        for (int i = 0; i < nBins; i++)
+            REQUIRE(kernelTab[i] == Catch::Approx(kernel[i]).epsilon(1e-3));
+    }
+}
@@ -0,0 +1,30 @@
+#include <filesystem>
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+#include <Core/CaseManifest.hpp>
+#include "APCEMM.h"
+
+TEST_CASE("Case Manifest"){
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() / "APCEMM_test_manifest";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+
+    REQUIRE(CaseManifest(folder.string()).size() == 0);
+    CaseManifest::append(folder.string(), 3, SimStatus::Complete);
+    CaseManifest::append(folder.string(), 5, SimStatus::Failed);
+    CaseManifest::append(folder.string(), 7, SimStatus::Failed);
+    CaseManifest::append(folder.string(), 7, SimStatus::NoPersistence);
+    {
+        //Line cut short by a killed job
+        std::ofstream file(folder / CaseManifest::FILENAME, std::ios::app);
+        file << "9 Comp";
+    }
+    const CaseManifest manifest(folder.string());
+    REQUIRE(manifest.size() == 2);
+    REQUIRE(manifest.finished(3));
+    REQUIRE(!manifest.finished(5));
+    REQUIRE(manifest.finished(7));
+    REQUIRE(!manifest.finished(9));
+
+    std::filesystem::remove_all(folder);
+}
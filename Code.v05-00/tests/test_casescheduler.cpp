@@ -0,0 +1,84 @@
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+#include <YamlInputReader/YamlInputReader.hpp>
+#include <Core/CaseScheduler.hpp>
+#include <Core/CaseSelection.hpp>
+#include "APCEMM.h"
+
+//APCEMM_TEST_DIR is a preprocessor macro
+TEST_CASE("Case Scheduler"){
+    std::string filename = std::string(APCEMM_TESTS_DIR)+"/test1.yaml";
+    OptInput input;
+    YamlInputReader::readYamlInputFile(input, filename);
+    const YamlInputReader::CaseSpace caseSpace(input.PARAMETER_PARAM_MAP);
+
+    const CaseScheduler sweepOrder(caseSpace, false, false);
+    for(std::size_t i = 0; i < sweepOrder.size(); i++){
+        REQUIRE(sweepOrder[i] == i);
+    }
+    const CaseScheduler longestFirst(caseSpace, false, true);
+    REQUIRE(longestFirst.size() == caseSpace.size());
+    for(std::size_t i = 1; i < longestFirst.size(); i++){
+        REQUIRE(CaseScheduler::expectedCost(caseSpace.parameters(longestFirst[i - 1]), false) >= CaseScheduler::expectedCost(caseSpace.parameters(longestFirst[i]), false));
+    }
+
+    REQUIRE(CaseScheduler::threadShare(8) == 8);
+    {
+        const CaseScheduler::RunningCase first;
+        REQUIRE(CaseScheduler::threadShare(8) == 8);
+        int shares[2] = {0, 0};
+        std::thread other([&shares](){
+            const CaseScheduler::RunningCase second;
+            shares[0] = CaseScheduler::threadShare(8);
+            std::thread third([&shares](){
+                const CaseScheduler::RunningCase third;
+                shares[1] = CaseScheduler::threadShare(8);
+            });
+            third.join();
+        });
+        other.join();
+        //Three cases running when the third asked, 8 threads split as 3, 3, 2
+        REQUIRE(shares[0] == 4);
+        REQUIRE(shares[1] == 2);
+    }
+    REQUIRE(CaseScheduler::threadShare(8) == 8);
+}
+
+TEST_CASE("Case Selection"){
+    std::string filename = std::string(APCEMM_TESTS_DIR)+"/test1.yaml";
+    OptInput input;
+    YamlInputReader::readYamlInputFile(input, filename);
+    const YamlInputReader::CaseSpace caseSpace(input.PARAMETER_PARAM_MAP);
+
+    //Shards partition the sweep
+    std::vector<int> runs(caseSpace.size(), 0);
+    for(int shard = 0; shard < 3; shard++){
+        CaseSelection selection;
+        selection.setShard(std::to_string(shard) + "/3");
+        const CaseScheduler shardOrder(caseSpace, false, true, selection);
+        for(std::size_t i = 0; i < shardOrder.size(); i++){
+            REQUIRE(shardOrder[i] % 3 == std::size_t(shard));
+            runs[shardOrder[i]]++;
+        }
+    }
+    for(int n: runs){
+        REQUIRE(n == 1);
+    }
+
+    CaseSelection range;
+    range.setRange("1:3");
+    const CaseScheduler rangeOrder(caseSpace, false, false, range);
+    REQUIRE(rangeOrder.size() == 2);
+    REQUIRE(rangeOrder[0] == 1);
+    REQUIRE(rangeOrder[1] == 2);
+    range.setRange("2:");
+    REQUIRE(!range.contains(1));
+    REQUIRE(range.contains(1000));
+
+    CaseSelection invalid;
+    REQUIRE_THROWS_AS(invalid.setShard("3/3"), std::invalid_argument);
+    REQUIRE_THROWS_AS(invalid.setShard("1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(invalid.setShard("-1/3"), std::invalid_argument);
+    REQUIRE_THROWS_AS(invalid.setRange("3:1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(invalid.setRange("a:b"), std::invalid_argument);
+}
@@ -1,4 +1,8 @@
+#include <filesystem>
 #include "EPM/Integrate.hpp"
+#include "EPM/ResultCache.hpp"
+#include "KPP/KPP_Parameters.h"
+#include "Util/PhysConstant.hpp"
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_approx.hpp>
 
@@ -48,3 +52,56 @@ TEST_CASE("EPM integrate", "[single-file]") {
 }
 
 
+
+TEST_CASE("EPM result cache") {
+    const std::string engineFileName = std::string(APCEMM_TESTS_DIR) + "/../../input_data/ENG_EI.txt";
+    const Aircraft aircraft("B747", engineFileName, 200000.0, 217.0, 22000.0, 60.0, 0.015);
+    const Emission EI(aircraft.engine(), Fuel("C12H24"));
+    const Vector_2D aerArray(1, Vector_1D(3, 0.0));
+    const double pressure_Pa = 22000.0;
+    const double airDens = pressure_Pa / (physConst::kB * 217.0) * 1.0E-06;
+
+    auto run = [&](double temp_K, const std::string& microFile) {
+        double varArray[NVAR] = {};
+        varArray[ind_H2O] = 1.0E-04 * airDens;
+        return ResultCache::Integrate(temp_K, pressure_Pa, 60.0, 1.804, 547.3, varArray, aerArray, aircraft, EI, false, 3.0, microFile);
+    };
+
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() / "APCEMM_test_EPM_cache";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    ResultCache::configure(true, folder.string());
+    ResultCache::clearCache();
+    const std::size_t hits0 = ResultCache::hits();
+    const std::size_t misses0 = ResultCache::misses();
+
+    const auto first = run(217.0, (folder / "Micro1.out").string());
+    REQUIRE(ResultCache::misses() == misses0 + 1);
+
+    SECTION("Identical inputs hit the memory cache") {
+        const auto second = run(217.0, (folder / "Micro2.out").string());
+        REQUIRE(ResultCache::hits() == hits0 + 1);
+        REQUIRE(ResultCache::misses() == misses0 + 1);
+        REQUIRE(second.second == first.second);
+        REQUIRE(second.first.finalTemp == first.first.finalTemp);
+        REQUIRE(std::filesystem::exists(folder / "Micro2.out"));
+    }
+    SECTION("Different inputs miss") {
+        run(218.0, (folder / "Micro3.out").string());
+        REQUIRE(ResultCache::hits() == hits0);
+        REQUIRE(ResultCache::misses() == misses0 + 2);
+    }
+    SECTION("Results are read back from disk") {
+        ResultCache::clearCache();
+        const auto fromDisk = run(217.0, (folder / "Micro4.out").string());
+        REQUIRE(ResultCache::hits() == hits0 + 1);
+        REQUIRE(fromDisk.second == first.second);
+        if (first.second == SimStatus::EPMSuccess) {
+            REQUIRE(fromDisk.first.iceDensity == first.first.iceDensity);
+            REQUIRE(fromDisk.first.area == first.first.area);
+            REQUIRE(fromDisk.first.IceAer.getPDF() == first.first.IceAer.getPDF());
+        }
+    }
+    ResultCache::configure(true);
+    std::filesystem::remove_all(folder);
+}
@@ -0,0 +1,38 @@
+#include <cmath>
+#include <catch2/catch_test_macros.hpp>
+#include <Util/MC_Rand.hpp>
+
+TEST_CASE("Philox", "[single-file]"){
+    SECTION("Known answers"){
+        //Test vectors of the Random123 reference implementation
+        REQUIRE(Philox::generate({0, 0, 0, 0}, {0, 0}) == Philox::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+        REQUIRE(Philox::generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff})
+                == Philox::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+        REQUIRE(Philox::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0})
+                == Philox::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+    }
+    SECTION("Uniform"){
+        REQUIRE(Philox::uniform(0, 0, -1.0, 1.0) == -1.0);
+        REQUIRE(Philox::uniform(0xffffffff, 0xffffffff, -1.0, 1.0) < 1.0);
+        double mean = 0;
+        const int N = 100000;
+        for(std::uint32_t n = 0; n < N; n++){
+            const Philox::Counter draw = Philox::generate({n, 0, Philox::TEMP_PERTURB, 0}, {1, 2});
+            const double x = Philox::uniform(draw[0], draw[1], 2.0, 4.0);
+            REQUIRE(x >= 2.0);
+            REQUIRE(x < 4.0);
+            mean += x / N;
+        }
+        REQUIRE(std::abs(mean - 3.0) < 0.01);
+    }
+    SECTION("fRand"){
+        setSeed(42);
+        const double first = fRand(0.0, 1.0);
+        const double second = fRand(0.0, 1.0);
+        REQUIRE(first != second);
+        //Same seed, same sequence
+        setSeed(42);
+        REQUIRE(fRand(0.0, 1.0) == first);
+        REQUIRE(fRand(0.0, 1.0) == second);
+    }
+}
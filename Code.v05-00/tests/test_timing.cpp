@@ -0,0 +1,75 @@
+#include <sstream>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+#include <Util/Timing.hpp>
+
+namespace {
+    void sleepMs(int ms){
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+TEST_CASE("Timing", "[single-file]"){
+    Timing::Profile profile;
+
+    SECTION("Nested phases"){
+        {
+            Timing::Profile::Active active(profile, "case");
+            REQUIRE(Timing::Profile::current() == &profile);
+            for(int i = 0; i < 3; i++){
+                Timing::Scope outer("Transport");
+                {
+                    Timing::Scope inner("Ice");
+                    sleepMs(2);
+                }
+                Timing::Scope inner("H2O");
+            }
+            Timing::Scope other("Remap");
+        }
+        REQUIRE(Timing::Profile::current() == nullptr);
+        REQUIRE(profile.calls("case", "Transport") == 3);
+        REQUIRE(profile.calls("case", "Transport/Ice") == 3);
+        REQUIRE(profile.calls("case", "Transport/H2O") == 3);
+        REQUIRE(profile.calls("case", "Remap") == 1);
+        REQUIRE(profile.calls("case", "Ice") == 0);
+        REQUIRE(profile.seconds("case", "Transport/Ice") >= 0.006);
+        REQUIRE(profile.seconds("case", "Transport") >= profile.seconds("case", "Transport/Ice"));
+        REQUIRE(profile.elapsed() >= profile.seconds("case", "Transport"));
+    }
+    SECTION("Inactive scopes are not timed"){
+        {
+            Timing::Scope scope("Transport");
+        }
+        Timing::Profile::Active active(profile, "case");
+        REQUIRE(profile.calls("case", "Transport") == 0);
+    }
+    SECTION("One tree per thread"){
+        Timing::Profile::Active active(profile, "case");
+        Timing::Scope outer("Output");
+        std::thread writer([&profile]{
+            Timing::Profile::Active writerActive(profile, "writer");
+            Timing::Scope scope("NetCDF");
+        });
+        writer.join();
+        REQUIRE(profile.calls("writer", "NetCDF") == 1);
+        REQUIRE(profile.calls("case", "Output/NetCDF") == 0);
+        REQUIRE(profile.calls("writer", "Output") == 0);
+    }
+    SECTION("JSON report"){
+        {
+            Timing::Profile::Active active(profile, "case");
+            Timing::Scope outer("EPM");
+            Timing::Scope inner("Vortex \"sinking\"");
+        }
+        std::ostringstream os;
+        profile.writeJSON(os, {{"case", "7"}, {"status", Timing::quote("Complete")}});
+        const std::string json = os.str();
+        REQUIRE(json.front() == '{');
+        REQUIRE(json.find("\"case\": 7,") != std::string::npos);
+        REQUIRE(json.find("\"status\": \"Complete\",") != std::string::npos);
+        REQUIRE(json.find("\"wall_s\": ") != std::string::npos);
+        REQUIRE(json.find("\"label\": \"case\"") != std::string::npos);
+        REQUIRE(json.find("{ \"name\": \"EPM\", \"calls\": 1,") != std::string::npos);
+        REQUIRE(json.find("\"name\": \"Vortex \\\"sinking\\\"\"") != std::string::npos);
+    }
+}
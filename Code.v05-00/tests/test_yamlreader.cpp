@@ -200,6 +200,7 @@ TEST_CASE("Read Yaml File"){
         #ifndef DEBUG
             REQUIRE(input.SIMULATION_OMP_NUM_THREADS == 8);
         #endif
+        REQUIRE(input.SIMULATION_PARALLEL_CASES == false);
         REQUIRE(input.SIMULATION_PARAMETER_SWEEP == true);
         REQUIRE(input.SIMULATION_MONTECARLO == true);
         REQUIRE(input.SIMULATION_MCRUNS == 2);
@@ -216,6 +217,11 @@ TEST_CASE("Read Yaml File"){
         REQUIRE(input.SIMULATION_ADJOINT_FILENAME == "APCEMM_ADJ_Case_*");
         REQUIRE(input.SIMULATION_BOXMODEL == true);
         REQUIRE(input.SIMULATION_BOX_FILENAME == "APCEMM_BOX_CASE_*");
+        REQUIRE(input.SIMULATION_EPM_CACHE == true);
+        REQUIRE(input.SIMULATION_EPM_CACHE_FOLDER == "");
+        REQUIRE(input.SIMULATION_CHECKPOINT == false);
+        REQUIRE(input.SIMULATION_CHECKPOINT_INTERVAL == 60.0);
+        REQUIRE(input.SIMULATION_TIMING_REPORT == false);
         REQUIRE(err == "In Simulation Menu: Parameter sweep and Monte Carlo cannot have the same value!");
 
     }
@@ -274,6 +280,10 @@ TEST_CASE("Read Yaml File"){
         REQUIRE(input.TRANSPORT_UPDRAFT == true);
         REQUIRE(input.TRANSPORT_UPDRAFT_TIMESCALE == 3600);
         REQUIRE(input.TRANSPORT_UPDRAFT_VELOCITY == 5);
+        // Optional key, absent from test.yaml
+        REQUIRE(input.TRANSPORT_DIFFUSION_SOLVER == "SOR");
+        REQUIRE(input.TRANSPORT_TRACER_DIFFUSION_SOLVER == "SOR");
+        REQUIRE(input.TRANSPORT_ADVECTION_SCHEME == "MinMod");
     }
     SECTION("Read Chemistry Menu"){
         OptInput input;
@@ -292,6 +302,7 @@ TEST_CASE("Read Yaml File"){
         REQUIRE(input.AEROSOL_COAGULATION_TIMESTEP == 60);
         REQUIRE(input.AEROSOL_ICE_GROWTH == true);
         REQUIRE(input.AEROSOL_ICE_GROWTH_TIMESTEP == 10);
+        REQUIRE(input.AEROSOL_COAGULATION_TABLE == false);
     }
     SECTION("Read Met Menu"){
         OptInput input;
@@ -349,6 +360,11 @@ TEST_CASE("Read Yaml File"){
         REQUIRE(input.TS_AEROSOL.size() == 3);
         REQUIRE(input.TS_AEROSOL[2] == 5);
         REQUIRE(input.TS_AERO_FREQ == 10);
+        REQUIRE(input.TS_AERO_SINGLE_FILE == false);
+        REQUIRE(input.TS_AERO_CHUNK_SIZE == 4096);
+        REQUIRE(input.TS_AERO_DEFLATE_LEVEL == 1);
+        REQUIRE(input.TS_AERO_SHUFFLE == true);
+        REQUIRE(input.TS_AERO_SIGNIFICANT_DIGITS == 0);
         REQUIRE(input.PL_PL == true);
         REQUIRE(input.PL_O3 == true);
     }
@@ -439,4 +455,37 @@ TEST_CASE("Generate Input Objects"){
     REQUIRE(caseInput.wingspan() == 69.8);
     REQUIRE(caseInput.coreExitTemp() == 547.3);
     REQUIRE(caseInput.bypassArea() == 1.804);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Case Space"){
+    OptInput input;
+    input.PARAMETER_PARAM_MAP = {{"test1", {1, 2, 3}}, {"test2", {4, 0}}, {"test3", {5, 6, 7, 8}}, {"test4", {9, 10, 11}}};
+    const CaseSpace caseSpace(input.PARAMETER_PARAM_MAP);
+    const vector<std::unordered_map<string,double>> combinations = generateCases(input);
+    REQUIRE(caseSpace.size() == 72);
+    for(std::size_t iCase = 0; iCase < caseSpace.size(); iCase++){
+        REQUIRE(caseSpace.caseMap(iCase) == combinations[iCase]);
+    }
+    REQUIRE_THROWS_AS(caseSpace.caseMap(72), std::out_of_range);
+    //Parameters needed by Input are missing
+    REQUIRE_THROWS_AS(caseSpace.parameters(0), std::invalid_argument);
+
+    string filename = string(APCEMM_TESTS_DIR)+"/test1.yaml";
+    OptInput yamlInput;
+    YamlInputReader::readYamlInputFile(yamlInput, filename);
+    const CaseSpace sweep(yamlInput.PARAMETER_PARAM_MAP);
+    const vector<std::unordered_map<string,double>> cases = generateCases(yamlInput);
+    REQUIRE(sweep.size() == 18);
+    for(std::size_t iCase = 0; iCase < sweep.size(); iCase++){
+        const Input fromMap = Input(iCase, cases, "", "", "", "", "");
+        const Input fromSpace = Input(iCase, sweep.parameters(iCase), "", "", "", "", "");
+        REQUIRE(fromSpace.temperature_K() == fromMap.temperature_K());
+        REQUIRE(fromSpace.relHumidity_w() == fromMap.relHumidity_w());
+        REQUIRE(fromSpace.shear() == fromMap.shear());
+        REQUIRE(fromSpace.nBV() == fromMap.nBV());
+        REQUIRE(fromSpace.emissionDOY() == fromMap.emissionDOY());
+        REQUIRE(fromSpace.EI_HC() == fromMap.EI_HC());
+        REQUIRE(fromSpace.backgSO2() == fromMap.backgSO2());
+        REQUIRE(fromSpace.bypassArea() == fromMap.bypassArea());
+    }
+}